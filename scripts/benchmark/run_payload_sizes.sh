@@ -0,0 +1,30 @@
+#!/bin/bash
+
+set -ex
+SCRIPT_DIR=$(dirname $(readlink -f $0))
+
+cd $SCRIPT_DIR
+mkdir -p runlogs/
+
+# Task payload sizes in bytes; 0 sends none.
+declare -a PAYLOADS=(0 64 1024 16384 262144)
+P=8
+W=8
+N=10
+
+# Through the scheduler server to gRPC workers.
+for Y in "${PAYLOADS[@]}"; do
+  OUTLOG="runlogs/loadgen-Y${Y}-N${N}-W${W}-P${P}.csv"
+  ${SCRIPT_DIR}/../../build/bin/LoadGenerator -i 5000 -t 15000 -o $OUTLOG \
+    -N $N -W $W -P $P -Y $Y
+done
+
+# Through the database to poll workers, which checksum every payload.
+# Start the workers first, e.g.:
+# ./build/bin/SyntheticWorker -B 100 -W 8 -P 8 \
+#   -g ./build/bin/libExampleTaskPlugin.so -T checksum
+for Y in "${PAYLOADS[@]}"; do
+  OUTLOG="runlogs/syn-payload-Y${Y}-N${N}-W${W}-P${P}.csv"
+  ${SCRIPT_DIR}/../../build/bin/SyntheticScheduler -i 5000 -t 15000 \
+    -o $OUTLOG -N $N -W $W -P $P -A single-partitioned-fifo-task -Y $Y
+done
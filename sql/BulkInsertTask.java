@@ -0,0 +1,28 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Insert a batch of tasks that all belong to partition pkey.
+public class BulkInsertTask extends VoltProcedure {
+
+    public final SQLStmt insert = new SQLStmt (
+        "INSERT INTO Task (TaskID, WorkerID, State, PKey) VALUES (?, ?, ?, ?);"
+    );
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    public long run(int pkey, int[] taskIDs, int[] workerIDs, int[] states) throws VoltAbortException {
+        if (taskIDs.length != workerIDs.length || taskIDs.length != states.length) {
+            throw new VoltAbortException("Mismatched array lengths.");
+        }
+        for (int i = 0; i < taskIDs.length; i++) {
+            voltQueueSQL(insert, taskIDs[i], workerIDs[i], states[i], pkey);
+            if ((i + 1) % MAX_BATCH == 0) {
+                voltExecuteSQL();
+            }
+        }
+        voltExecuteSQL(true);
+        return taskIDs.length;
+    }
+}
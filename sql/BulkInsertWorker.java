@@ -0,0 +1,28 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Insert a batch of workers that all belong to partition pkey.
+public class BulkInsertWorker extends VoltProcedure {
+
+    public final SQLStmt insert = new SQLStmt (
+        "INSERT INTO Worker VALUES (?, ?, 0, ?, ?);"
+    );
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    public long run(int pkey, int[] workerIDs, int[] capacities) throws VoltAbortException {
+        if (workerIDs.length != capacities.length) {
+            throw new VoltAbortException("Mismatched array lengths.");
+        }
+        for (int i = 0; i < workerIDs.length; i++) {
+            voltQueueSQL(insert, workerIDs[i], capacities[i], pkey, "");
+            if ((i + 1) % MAX_BATCH == 0) {
+                voltExecuteSQL();
+            }
+        }
+        voltExecuteSQL(true);
+        return workerIDs.length;
+    }
+}
@@ -0,0 +1,55 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Base of the procedures that mark a worker's tasks complete,
+// WorkerCompleteTasks and WorkerExchange, and through DequeueTaskProcedure of
+// the procedures that dequeue tasks. VoltDB also plans the statements a
+// procedure inherits.
+public abstract class CompleteTaskProcedure extends VoltProcedure {
+
+    // VoltDB executes at most this many statements per batch.
+    protected static final int MAX_BATCH = 200;
+
+    // Only running tasks are completed, so a repeated completion does not
+    // credit the capacity twice.
+    public final SQLStmt completeTask = new SQLStmt(
+        "UPDATE Task SET State=3, FinishTime=NOW WHERE PKey=? AND TaskID=? AND WorkerID=? AND State=2;"
+    );
+
+    public final SQLStmt completeTaskWithResult = new SQLStmt(
+        "UPDATE Task SET State=3, FinishTime=NOW, Result=? WHERE PKey=? AND TaskID=? AND WorkerID=? AND State=2;"
+    );
+
+    public final SQLStmt updateCapacity = new SQLStmt(
+        "UPDATE Worker SET Capacity=Capacity+? WHERE PKey=? AND WorkerID=?;"
+    );
+
+    // Mark the running tasks among taskIds complete. results is empty, or
+    // holds the result blob of each task (empty for none). If any task was
+    // completed, queue the update that gives back the capacity they held,
+    // for the caller to execute. Return the number of completed tasks.
+    protected long complete(int pkey, long workerId, int[] taskIds, byte[][] results) {
+        if (results.length != 0 && results.length != taskIds.length) {
+            throw new VoltAbortException("Mismatched array lengths.");
+        }
+        long completed = 0;
+        for (int i = 0; i < taskIds.length; i++) {
+            if (results.length == 0) {
+                voltQueueSQL(completeTask, pkey, taskIds[i], workerId);
+            } else {
+                voltQueueSQL(completeTaskWithResult, results[i], pkey, taskIds[i], workerId);
+            }
+            if ((i + 1) % MAX_BATCH == 0 || i == taskIds.length - 1) {
+                // Each update returns the number of modified rows.
+                for (VoltTable t : voltExecuteSQL()) {
+                    completed += t.asScalarLong();
+                }
+            }
+        }
+        if (completed > 0) {
+            voltQueueSQL(updateCapacity, completed, pkey, workerId);
+        }
+        return completed;
+    }
+}
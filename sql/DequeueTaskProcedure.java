@@ -0,0 +1,76 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Base of the procedures that hand a worker its pending tasks, WorkerSelectTask
+// and WorkerExchange. VoltDB also plans the statements a procedure inherits.
+// Extends CompleteTaskProcedure, since Java has no multiple inheritance and
+// WorkerExchange also completes tasks.
+public abstract class DequeueTaskProcedure extends CompleteTaskProcedure {
+
+    // All three statements walk pendingQueueIndex from the head of this
+    // worker's queue, so they touch at most topk rows each.
+    public final SQLStmt selectPendingTasks = new SQLStmt (
+        "SELECT TaskID, Payload, TaskType FROM PendingTask WHERE PKey=? AND WorkerID=? "
+        + "ORDER BY Seq, TaskID LIMIT ?;"
+    );
+
+    public final SQLStmt moveToRunning = new SQLStmt(
+        "INSERT INTO Task (TaskID, WorkerID, State, PKey, Payload, TaskType) "
+        + "SELECT TaskID, WorkerID, 2, PKey, Payload, TaskType FROM PendingTask WHERE PKey=? AND WorkerID=? "
+        + "ORDER BY Seq, TaskID LIMIT ?;"
+    );
+
+    public final SQLStmt deletePending = new SQLStmt(
+        "DELETE FROM PendingTask WHERE PKey=? AND WorkerID=? "
+        + "ORDER BY Seq, TaskID LIMIT ?;"
+    );
+
+    // With a lease, tasks are moved one at a time to carry the deadline.
+    public final SQLStmt insertLeased = new SQLStmt(
+        "INSERT INTO Task (TaskID, WorkerID, State, PKey, LeaseExpiry, Payload, TaskType) VALUES (?, ?, 2, ?, ?, ?, ?);"
+    );
+
+    public final SQLStmt parkWorker = new SQLStmt(
+        "UPSERT INTO IdleWorker VALUES (?, ?, ?);"
+    );
+
+    // Dequeue up to topk pending tasks of the worker and move them to Task as
+    // running, leased for leaseMsec if leaseMsec > 0. If there is none and
+    // wakeupUrl is not empty, park the worker in IdleWorker so the next task
+    // queued for it triggers a push. The caller may have queued <queued>
+    // statements to run in the same batch. Return the task ids, payloads and
+    // types.
+    protected VoltTable dequeue(int pkey, long workerId, long topk, long leaseMsec, String wakeupUrl, int queued) {
+        boolean isFinal = wakeupUrl.isEmpty();
+        VoltTable tasks;
+        voltQueueSQL(selectPendingTasks, pkey, workerId, topk);
+        if (leaseMsec <= 0) {
+            voltQueueSQL(moveToRunning, pkey, workerId, topk);
+            voltQueueSQL(deletePending, pkey, workerId, topk);
+            tasks = voltExecuteSQL(isFinal)[queued];
+        } else {
+            voltQueueSQL(deletePending, pkey, workerId, topk);
+            tasks = voltExecuteSQL()[queued];
+            // Use the transaction time so replicas compute the same deadline.
+            long nowUsec = getTransactionTime().getTime() * 1000;
+            TimestampType deadline = new TimestampType(nowUsec + leaseMsec * 1000);
+            int numTasks = tasks.getRowCount();
+            for (int i = 0; i < numTasks; i++) {
+                VoltTableRow row = tasks.fetchRow(i);
+                voltQueueSQL(insertLeased, row.getLong(0), workerId, pkey, deadline, row.getVarbinary(1), row.getLong(2));
+                if ((i + 1) % MAX_BATCH == 0) {
+                    voltExecuteSQL();
+                }
+            }
+            voltExecuteSQL(isFinal);
+        }
+
+        if (!isFinal && tasks.getRowCount() == 0) {
+            voltQueueSQL(parkWorker, workerId, pkey, wakeupUrl);
+            voltExecuteSQL(true);
+        }
+        return tasks;
+    }
+}
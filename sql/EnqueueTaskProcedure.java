@@ -0,0 +1,53 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Base of the procedures that queue a task for a worker in PendingTask. It
+// also pushes the task to the worker if the worker is parked in IdleWorker
+// waiting for work (see WorkerSelectTask). VoltDB also plans the statements a
+// procedure inherits.
+public abstract class EnqueueTaskProcedure extends VoltProcedure {
+
+    public final SQLStmt enqueueTask = new SQLStmt (
+        "INSERT INTO PendingTask (TaskID, WorkerID, Seq, PKey, Payload, TaskType) VALUES (?, ?, ?, ?, ?, ?);"
+    );
+
+    public final SQLStmt selectIdleWorker = new SQLStmt (
+        "SELECT Url FROM IdleWorker WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt unparkWorker = new SQLStmt (
+        "DELETE FROM IdleWorker WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt insertTaskAssign = new SQLStmt (
+        "INSERT INTO TaskAssign VALUES(?, ?, ?);"
+    );
+
+    // Queue the task for the worker, with its optional payload (null for
+    // none) and its type, and execute it in one batch with the statements the
+    // caller queued. If wakeup is not 0, also look the worker up in IdleWorker and
+    // push a wakeup if it is parked. Schedulers pass 0 when no worker parks,
+    // which saves the lookup. Pass isFinal if the caller runs no SQL after.
+    protected void enqueue(int pkey, long taskID, long workerID, byte[] payload, long taskType, byte wakeup, boolean isFinal) {
+        voltQueueSQL(enqueueTask, taskID, workerID, getUniqueId(), pkey, payload, taskType);
+        if (wakeup == 0) {
+            voltExecuteSQL(isFinal);
+            return;
+        }
+        pushWakeup(pkey, taskID, workerID, isFinal);
+    }
+
+    // Execute the statements the caller queued, and push a wakeup for taskID
+    // if the worker is parked in IdleWorker.
+    protected void pushWakeup(int pkey, long taskID, long workerID, boolean isFinal) {
+        voltQueueSQL(selectIdleWorker, pkey, workerID);
+        VoltTable[] results = voltExecuteSQL();
+        VoltTable idle = results[results.length - 1];
+        if (idle.getRowCount() > 0) {
+            voltQueueSQL(unparkWorker, pkey, workerID);
+            voltQueueSQL(insertTaskAssign, taskID, idle.fetchRow(0).getString(0), pkey);
+            voltExecuteSQL(isFinal);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+package dbos.procedures;
+
+import java.util.LinkedHashSet;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Requeue up to maxRows running tasks of a partition whose lease expired. Each
+// task moves to the head of the PendingTask queue of the worker with the most
+// capacity in the partition other than the one that held it, or back to that
+// worker if it is the only one, and the worker is woken up if it is parked.
+// The capacity the task held goes back to its old worker; a late completion
+// from that worker no longer matches the task. Return the number of expired
+// leases; the caller calls again while it gets a full batch.
+public class ExpireTaskLeases extends EnqueueTaskProcedure {
+
+    // Task states.
+    final long RUNNING = 2;
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    // Uses leaseIndex, so the cost depends on maxRows, not table size.
+    public final SQLStmt selectExpired = new SQLStmt(
+        "SELECT TaskID, WorkerID, Payload, TaskType FROM Task WHERE PKey=? AND State=? AND LeaseExpiry < ? ORDER BY LeaseExpiry LIMIT ?;"
+    );
+
+    // The two workers with the most capacity, so there is one besides the old
+    // worker of any task.
+    public final SQLStmt selectWorkers = new SQLStmt(
+        "SELECT WorkerID FROM Worker WHERE PKey=? ORDER BY Capacity DESC LIMIT 2;"
+    );
+
+    public final SQLStmt deleteTask = new SQLStmt(
+        "DELETE FROM Task WHERE PKey=? AND TaskID=?;"
+    );
+
+    public final SQLStmt updateCapacity = new SQLStmt(
+        "UPDATE Worker SET Capacity=Capacity+? WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public long run(int pkey, int maxRows) throws VoltAbortException {
+        // Use the transaction time so replicas compute the same cutoff.
+        TimestampType now = new TimestampType(getTransactionTime());
+        voltQueueSQL(selectExpired, pkey, RUNNING, now, maxRows);
+        voltQueueSQL(selectWorkers, pkey);
+        VoltTable[] results = voltExecuteSQL();
+        VoltTable r = results[0];
+        VoltTable workers = results[1];
+        int numRows = r.getRowCount();
+        LinkedHashSet<Long> targets = new LinkedHashSet<Long>();
+        int queued = 0;
+        for (int i = 0; i < numRows; i++) {
+            VoltTableRow row = r.fetchRow(i);
+            long taskId = row.getLong(0);
+            long oldWorker = row.getLong(1);
+            long newWorker = oldWorker;
+            for (int j = 0; j < workers.getRowCount(); j++) {
+                long workerId = workers.fetchRow(j).getLong(0);
+                if (workerId != oldWorker) {
+                    newWorker = workerId;
+                    break;
+                }
+            }
+            // Seq 0 puts the task ahead of the ones that waited less.
+            voltQueueSQL(deleteTask, pkey, taskId);
+            voltQueueSQL(enqueueTask, taskId, newWorker, 0, pkey, row.getVarbinary(2), row.getLong(3));
+            queued += 2;
+            if (newWorker != oldWorker) {
+                voltQueueSQL(updateCapacity, 1, pkey, oldWorker);
+                voltQueueSQL(updateCapacity, -1, pkey, newWorker);
+                queued += 2;
+            }
+            targets.add(newWorker);
+            if (queued >= MAX_BATCH) {
+                voltExecuteSQL();
+                queued = 0;
+            }
+        }
+        if (targets.isEmpty()) {
+            voltExecuteSQL(true);
+            return numRows;
+        }
+        // The wakeup only tells the worker to poll, so it names no task.
+        int numTargets = targets.size();
+        for (long workerId : targets) {
+            pushWakeup(pkey, -1, workerId, --numTargets == 0);
+        }
+        return numRows;
+    }
+}
@@ -2,6 +2,8 @@ package dbos.procedures;
 
 import org.voltdb.*;
 
+// Mark a task complete on behalf of a worker, store its result blob if it has
+// one (empty for none), and give back one capacity.
 public class FinishWorkerTask extends VoltProcedure {
     // Task states.
     final long PENDING = 1;
@@ -17,9 +19,13 @@ public class FinishWorkerTask extends VoltProcedure {
     );
 
     public final SQLStmt updateState = new SQLStmt (
-        "UPDATE Task SET State=3 WHERE PKey=? AND taskID=?;"
+        "UPDATE Task SET State=3, FinishTime=NOW WHERE PKey=? AND taskID=?;"
     );
-    public long run(int workerID, int taskID, int pkey) throws VoltAbortException {
+
+    public final SQLStmt updateStateWithResult = new SQLStmt (
+        "UPDATE Task SET State=3, FinishTime=NOW, Result=? WHERE PKey=? AND taskID=?;"
+    );
+    public long run(int workerID, int taskID, int pkey, byte[] result) throws VoltAbortException {
         voltQueueSQL(getCapacity, pkey, workerID);
         VoltTable[] results = voltExecuteSQL();
         VoltTable r = results[0];
@@ -29,7 +35,11 @@ public class FinishWorkerTask extends VoltProcedure {
         long capacity = r.fetchRow(0).getLong(0);
         voltQueueSQL(updateCapacity, capacity + 1, pkey, workerID);
         if (taskID != -1 ) {
-            voltQueueSQL(updateState, pkey, taskID);
+            if (result == null || result.length == 0) {
+                voltQueueSQL(updateState, pkey, taskID);
+            } else {
+                voltQueueSQL(updateStateWithResult, result, pkey, taskID);
+            }
             voltExecuteSQL();
         } else {
             voltExecuteSQL();
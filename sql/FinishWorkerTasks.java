@@ -0,0 +1,45 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Batched FinishWorkerTask: mark a batch of a worker's tasks complete and give
+// back one capacity per task with a single update. results is empty, or holds
+// the result blob of each task (empty for none). Return the number of tasks.
+public class FinishWorkerTasks extends VoltProcedure {
+
+    // VoltDB executes at most this many statements per batch.
+    static final int MAX_BATCH = 200;
+
+    public final SQLStmt updateCapacity = new SQLStmt (
+        "UPDATE Worker SET Capacity=Capacity+? WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt updateState = new SQLStmt (
+        "UPDATE Task SET State=3, FinishTime=NOW WHERE PKey=? AND taskID=?;"
+    );
+
+    public final SQLStmt updateStateWithResult = new SQLStmt (
+        "UPDATE Task SET State=3, FinishTime=NOW, Result=? WHERE PKey=? AND taskID=?;"
+    );
+
+    public long run(int pkey, int workerID, int[] taskIDs, byte[][] results) throws VoltAbortException {
+        if (results.length != 0 && results.length != taskIDs.length) {
+            throw new VoltAbortException("Mismatched array lengths.");
+        }
+        for (int i = 0; i < taskIDs.length; i++) {
+            if (results.length == 0 || results[i] == null || results[i].length == 0) {
+                voltQueueSQL(updateState, pkey, taskIDs[i]);
+            } else {
+                voltQueueSQL(updateStateWithResult, results[i], pkey, taskIDs[i]);
+            }
+            if ((i + 1) % MAX_BATCH == 0) {
+                voltExecuteSQL();
+            }
+        }
+        // The capacity was taken by SelectSparkWorker, which creates no Task
+        // rows, so it is given back whether or not a task row matched.
+        voltQueueSQL(updateCapacity, taskIDs.length, pkey, workerID);
+        voltExecuteSQL(true);
+        return taskIDs.length;
+    }
+}
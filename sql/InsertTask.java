@@ -5,7 +5,7 @@ import org.voltdb.*;
 public class InsertTask extends VoltProcedure {
 
     public final SQLStmt insert = new SQLStmt (
-        "INSERT INTO Task VALUES (?, ?, ?, ?);"
+        "INSERT INTO Task (TaskID, WorkerID, State, PKey) VALUES (?, ?, ?, ?);"
     );
 
     public long run(int taskID, int workerID, int state, int pkey) throws VoltAbortException {
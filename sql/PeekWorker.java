@@ -0,0 +1,21 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Read-only twin of SelectWorker: find a worker with capacity in a partition,
+// but leave its capacity alone. Schedulers use it to warm up.
+public class PeekWorker extends VoltProcedure {
+
+    public final SQLStmt selectWorker = new SQLStmt (
+        "SELECT WorkerID, Capacity FROM Worker WHERE PKey=? AND Capacity > 0 LIMIT 1;"
+    );
+
+    public long run(int pkey) throws VoltAbortException {
+        voltQueueSQL(selectWorker, pkey);
+        VoltTable r = voltExecuteSQL()[0];
+        if (r.getRowCount() < 1) {
+            return -1;
+        }
+        return r.fetchRow(0).getLong(0);
+    }
+}
@@ -0,0 +1,48 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Delete up to maxRows completed tasks of a partition that finished more than
+// retentionMsec ago, with their TaskUsage rows. Return the number of deleted
+// tasks; the caller calls again while it gets a full batch.
+public class PurgeCompletedTasks extends VoltProcedure {
+
+    // Task states.
+    final long COMPLETE = 3;
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    // Uses finishTimeIndex, so the cost depends on maxRows, not table size.
+    public final SQLStmt selectCompleted = new SQLStmt(
+        "SELECT TaskID FROM Task WHERE PKey=? AND State=? AND FinishTime < ? ORDER BY FinishTime LIMIT ?;"
+    );
+
+    public final SQLStmt deleteTask = new SQLStmt(
+        "DELETE FROM Task WHERE PKey=? AND TaskID=?;"
+    );
+
+    public final SQLStmt deleteUsage = new SQLStmt(
+        "DELETE FROM TaskUsage WHERE PKey=? AND TaskID=?;"
+    );
+
+    public long run(int pkey, long retentionMsec, int maxRows) throws VoltAbortException {
+        // Use the transaction time so replicas compute the same cutoff.
+        long nowUsec = getTransactionTime().getTime() * 1000;
+        TimestampType cutoff = new TimestampType(nowUsec - retentionMsec * 1000);
+        voltQueueSQL(selectCompleted, pkey, COMPLETE, cutoff, maxRows);
+        VoltTable r = voltExecuteSQL()[0];
+        int numRows = r.getRowCount();
+        for (int i = 0; i < numRows; i++) {
+            long taskId = r.fetchRow(i).getLong(0);
+            voltQueueSQL(deleteTask, pkey, taskId);
+            voltQueueSQL(deleteUsage, pkey, taskId);
+            if ((i + 1) % (MAX_BATCH / 2) == 0) {
+                voltExecuteSQL();
+            }
+        }
+        voltExecuteSQL(true);
+        return numRows;
+    }
+}
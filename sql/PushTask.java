@@ -23,7 +23,7 @@ public class PushTask extends VoltProcedure {
     );
 
     public final SQLStmt insertTask = new SQLStmt (
-        "INSERT INTO Task VALUES (?, ?, ?, ?);"
+        "INSERT INTO Task (TaskID, WorkerID, State, PKey) VALUES (?, ?, ?, ?);"
     );
 
     public final SQLStmt insertTaskAssign = new SQLStmt (
@@ -0,0 +1,115 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Remove up to maxWorkers workers of a partition whose last heartbeat is older
+// than timeoutMsec, and reassign their tasks. The running and queued tasks of a
+// dead worker move to the queue of the live worker (fresh heartbeat) with the
+// most capacity in the partition, running ones at the head, and that worker is
+// woken up if it is parked. If the partition has no live worker, the dead
+// worker is only fenced off with zero capacity and keeps its queue until a
+// later call finds one. Return one row per dead worker: WorkerID and the number
+// of reassigned tasks, -1 if it was fenced.
+public class ReapDeadWorkers extends EnqueueTaskProcedure {
+
+    // Task states.
+    final long RUNNING = 2;
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    // Uses heartbeatTimeIndex, so a healthy partition costs one index probe.
+    public final SQLStmt selectDead = new SQLStmt(
+        "SELECT WorkerID FROM WorkerHeartbeat WHERE PKey=? AND LastSeen < ? ORDER BY LastSeen LIMIT ?;"
+    );
+
+    public final SQLStmt selectLiveWorker = new SQLStmt(
+        "SELECT w.WorkerID FROM Worker w, WorkerHeartbeat h WHERE w.PKey=? AND h.PKey=w.PKey "
+        + "AND h.WorkerID=w.WorkerID AND h.LastSeen >= ? ORDER BY w.Capacity DESC LIMIT 1;"
+    );
+
+    public final SQLStmt selectRunning = new SQLStmt(
+        "SELECT TaskID, Payload, TaskType FROM Task WHERE PKey=? AND State=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt deleteRunning = new SQLStmt(
+        "DELETE FROM Task WHERE PKey=? AND State=? AND WorkerID=?;"
+    );
+
+    // Queued tasks keep their Seq, so one statement moves the whole queue.
+    public final SQLStmt reassignPending = new SQLStmt(
+        "UPDATE PendingTask SET WorkerID=? WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt takeCapacity = new SQLStmt(
+        "UPDATE Worker SET Capacity=Capacity-? WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt fenceWorker = new SQLStmt(
+        "UPDATE Worker SET Capacity=0 WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt deleteWorker = new SQLStmt(
+        "DELETE FROM Worker WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public final SQLStmt deleteHeartbeat = new SQLStmt(
+        "DELETE FROM WorkerHeartbeat WHERE PKey=? AND WorkerID=?;"
+    );
+
+    public VoltTable run(int pkey, long timeoutMsec, int maxWorkers) throws VoltAbortException {
+        VoltTable reaped = new VoltTable(
+            new VoltTable.ColumnInfo("WorkerID", VoltType.INTEGER),
+            new VoltTable.ColumnInfo("Requeued", VoltType.BIGINT));
+
+        // Use the transaction time so replicas compute the same cutoff.
+        long nowUsec = getTransactionTime().getTime() * 1000;
+        TimestampType cutoff = new TimestampType(nowUsec - timeoutMsec * 1000);
+        voltQueueSQL(selectDead, pkey, cutoff, maxWorkers);
+        VoltTable dead = voltExecuteSQL()[0];
+        int numDead = dead.getRowCount();
+        for (int i = 0; i < numDead; i++) {
+            long workerId = dead.fetchRow(i).getLong(0);
+            boolean isFinal = i == numDead - 1;
+            voltQueueSQL(selectLiveWorker, pkey, cutoff);
+            voltQueueSQL(selectRunning, pkey, RUNNING, workerId);
+            VoltTable[] results = voltExecuteSQL();
+            if (results[0].getRowCount() == 0) {
+                voltQueueSQL(fenceWorker, pkey, workerId);
+                voltQueueSQL(unparkWorker, pkey, workerId);
+                voltExecuteSQL(isFinal);
+                reaped.addRow(workerId, -1);
+                continue;
+            }
+            long liveId = results[0].fetchRow(0).getLong(0);
+
+            // The tasks the dead worker was running go to the head of the
+            // queue (Seq 0); they have waited the longest.
+            VoltTable running = results[1];
+            int numRunning = running.getRowCount();
+            for (int j = 0; j < numRunning; j++) {
+                VoltTableRow row = running.fetchRow(j);
+                voltQueueSQL(enqueueTask, row.getLong(0), liveId, 0, pkey, row.getVarbinary(1), row.getLong(2));
+                if ((j + 1) % MAX_BATCH == 0) {
+                    voltExecuteSQL();
+                }
+            }
+            voltQueueSQL(deleteRunning, pkey, RUNNING, workerId);
+            voltQueueSQL(reassignPending, liveId, pkey, workerId);
+            voltQueueSQL(deleteWorker, pkey, workerId);
+            voltQueueSQL(unparkWorker, pkey, workerId);
+            voltQueueSQL(deleteHeartbeat, pkey, workerId);
+            results = voltExecuteSQL();
+            long requeued = numRunning + results[results.length - 4].asScalarLong();
+            if (requeued > 0) {
+                // Each task holds one capacity of the worker it is queued for.
+                // The wakeup only tells the worker to poll, so it names no task.
+                voltQueueSQL(takeCapacity, requeued, pkey, liveId);
+                pushWakeup(pkey, -1, liveId, isFinal);
+            }
+            reaped.addRow(workerId, requeued);
+        }
+        return reaped;
+    }
+}
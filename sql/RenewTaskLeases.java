@@ -0,0 +1,26 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Extend the leases of all running tasks of a worker to leaseMsec from now.
+// Return the number of renewed tasks.
+public class RenewTaskLeases extends VoltProcedure {
+
+    // Task states.
+    final long RUNNING = 2;
+
+    // Only leased tasks are renewed. Uses leaseIndex, so the cost depends on
+    // the running tasks of the partition, not on the size of Task.
+    public final SQLStmt renewLeases = new SQLStmt(
+        "UPDATE Task SET LeaseExpiry=? WHERE PKey=? AND State=? AND LeaseExpiry IS NOT NULL AND WorkerID=?;"
+    );
+
+    public long run(int pkey, long workerId, long leaseMsec) throws VoltAbortException {
+        // Use the transaction time so replicas compute the same deadline.
+        long nowUsec = getTransactionTime().getTime() * 1000;
+        TimestampType deadline = new TimestampType(nowUsec + leaseMsec * 1000);
+        voltQueueSQL(renewLeases, deadline, pkey, RUNNING, workerId);
+        return voltExecuteSQL(true)[0].asScalarLong();
+    }
+}
@@ -0,0 +1,32 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Store the measured usage of a batch of a worker's tasks, one row per task.
+// The arrays are parallel. Return the number of stored rows.
+public class ReportTaskUsage extends VoltProcedure {
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    public final SQLStmt upsertUsage = new SQLStmt(
+        "UPSERT INTO TaskUsage (TaskID, WorkerID, PKey, QueueUsec, WallUsec, CpuUsec, ContextSwitches, FinishTime) VALUES (?, ?, ?, ?, ?, ?, ?, ?);"
+    );
+
+    public long run(int pkey, int workerId, int[] taskIds, long[] queueUsec,
+                    long[] wallUsec, long[] cpuUsec, long[] contextSwitches)
+            throws VoltAbortException {
+        // Use the transaction time so replicas store the same value.
+        TimestampType now = new TimestampType(getTransactionTime());
+        for (int i = 0; i < taskIds.length; i++) {
+            voltQueueSQL(upsertUsage, taskIds[i], workerId, pkey, queueUsec[i],
+                         wallUsec[i], cpuUsec[i], contextSwitches[i], now);
+            if ((i + 1) % MAX_BATCH == 0) {
+                voltExecuteSQL();
+            }
+        }
+        voltExecuteSQL(true);
+        return taskIds.length;
+    }
+}
@@ -2,7 +2,7 @@ package dbos.procedures;
 
 import org.voltdb.*;
 
-public class SelectOrderedWorker extends VoltProcedure {
+public class SelectOrderedWorker extends EnqueueTaskProcedure {
     
     public final SQLStmt selectWorker = new SQLStmt (
         "SELECT WorkerID, Capacity FROM Worker WHERE PKey=? AND Capacity > 0 ORDER BY Capacity DESC LIMIT 1;"
@@ -12,11 +12,7 @@ public class SelectOrderedWorker extends VoltProcedure {
         "UPDATE Worker SET Capacity=? WHERE PKey=? AND WorkerID=?;"
     );
 
-    public final SQLStmt insertTask = new SQLStmt (
-        "INSERT INTO Task VALUES (?, ?, ?, ?);"
-    );
-
-    public long run(int pkey, long taskID) throws VoltAbortException {
+    public long run(int pkey, long taskID, byte wakeup) throws VoltAbortException {
         voltQueueSQL(selectWorker, pkey);
         VoltTable[] results = voltExecuteSQL();
         VoltTable r = results[0];
@@ -25,9 +21,8 @@ public class SelectOrderedWorker extends VoltProcedure {
         }
         long workerID = r.fetchRow(0).getLong(0);
         long capacity = r.fetchRow(0).getLong(1);
-        voltQueueSQL(insertTask, taskID, workerID, 1, pkey);
         voltQueueSQL(updateCapacity, capacity - 1, pkey, workerID);
-        voltExecuteSQL();
+        enqueue(pkey, taskID, workerID, null, 0, wakeup, true);
         return workerID;
     }
 }
\ No newline at end of file
@@ -2,7 +2,7 @@ package dbos.procedures;
 
 import org.voltdb.*;
 
-public class SelectPartitionedTaskWorker extends VoltProcedure {
+public class SelectPartitionedTaskWorker extends EnqueueTaskProcedure {
 
     final long SUCCESS = 0;
     final long NOTASK = -1;
@@ -17,14 +17,16 @@ public class SelectPartitionedTaskWorker extends VoltProcedure {
     );
 
     public final SQLStmt selectTask = new SQLStmt (
-        "SELECT TaskID FROM Task WHERE PKey=? LIMIT 1;"
+        "SELECT TaskID, Payload, TaskType FROM Task WHERE PKey=? AND State=1 LIMIT 1;"
     );
 
-    public final SQLStmt updateTask = new SQLStmt (
-        "UPDATE Task SET WorkerID=? WHERE PKey=? AND TaskID=?;"
+    // Assigned tasks move from Task to the worker's queue in PendingTask, with
+    // their payload and type.
+    public final SQLStmt deleteTask = new SQLStmt (
+        "DELETE FROM Task WHERE PKey=? AND TaskID=?;"
     );
 
-    public long run(int pkey) throws VoltAbortException {
+    public long run(int pkey, byte wakeup) throws VoltAbortException {
 	// Select an available Task.
         voltQueueSQL(selectTask, pkey);
         VoltTable[] results = voltExecuteSQL();
@@ -34,6 +36,8 @@ public class SelectPartitionedTaskWorker extends VoltProcedure {
             return NOTASK;
         }
         long taskID = r.fetchRow(0).getLong(0);
+        byte[] payload = r.fetchRow(0).getVarbinary(1);
+        long taskType = r.fetchRow(0).getLong(2);
 
 	// Try to find a worker in  the same partition.
         voltQueueSQL(selectWorker, pkey);
@@ -50,8 +54,8 @@ public class SelectPartitionedTaskWorker extends VoltProcedure {
         // voltExecuteSQL();
         // No need to execute SQL here. can push multiple sql queries then execute in a batch.
 
-        voltQueueSQL(updateTask, workerID, pkey, taskID);
-        voltExecuteSQL();
+        voltQueueSQL(deleteTask, pkey, taskID);
+        enqueue(pkey, taskID, workerID, payload, taskType, wakeup, true);
         return 0;
     }
 }
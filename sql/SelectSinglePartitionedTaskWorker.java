@@ -2,7 +2,9 @@ package dbos.procedures;
 
 import org.voltdb.*;
 
-public class SelectSinglePartitionedTaskWorker extends VoltProcedure {
+// Queue a submitted task for a worker of partition pkey, with its optional
+// payload (null for none) and its type.
+public class SelectSinglePartitionedTaskWorker extends EnqueueTaskProcedure {
 
     final long SUCCESS = 0;
     final long NOWORKER = -2;
@@ -15,11 +17,7 @@ public class SelectSinglePartitionedTaskWorker extends VoltProcedure {
         "UPDATE Worker SET Capacity=? WHERE PKey=? AND WorkerID=?;"
     );
 
-    public final SQLStmt insertTask = new SQLStmt (
-        "INSERT INTO Task VALUES (?, ?, ?, ?);"
-    );
-
-    public long run(int pkey, long taskID) throws VoltAbortException {
+    public long run(int pkey, long taskID, byte[] payload, int taskType, byte wakeup) throws VoltAbortException {
     // Select an available Worker.
         voltQueueSQL(selectWorker, pkey);
         VoltTable[] results = voltExecuteSQL();
@@ -31,14 +29,9 @@ public class SelectSinglePartitionedTaskWorker extends VoltProcedure {
         
         long workerID = r.fetchRow(0).getLong(0);
         long capacity = r.fetchRow(0).getLong(1);
-        long state = 1; //RUNNING?
-        
-    // If a worker is available, insert task into table and update the worker capacity.	
-        voltQueueSQL(insertTask, taskID, workerID, state, pkey);
-        // voltExecuteSQL();
-
+    // If a worker is available, queue the task for it and update the worker capacity.
         voltQueueSQL(updateCapacity, capacity - 1, pkey, workerID);
-        voltExecuteSQL();
+        enqueue(pkey, taskID, workerID, payload, taskType, wakeup, true);
 
         return SUCCESS;
     }
@@ -8,8 +8,18 @@ public class TruncateTaskTable extends VoltProcedure {
         "TRUNCATE TABLE Task;"
     );
 
+    public final SQLStmt truncatePendingTaskTable = new SQLStmt (
+        "TRUNCATE TABLE PendingTask;"
+    );
+
+    public final SQLStmt truncateTaskUsageTable = new SQLStmt (
+        "TRUNCATE TABLE TaskUsage;"
+    );
+
     public long run() throws VoltAbortException {
         voltQueueSQL(truncateTaskTable);
+        voltQueueSQL(truncatePendingTaskTable);
+        voltQueueSQL(truncateTaskUsageTable);
         voltExecuteSQL();
         return 0;
     }
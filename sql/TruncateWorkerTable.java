@@ -12,11 +12,23 @@ public class TruncateWorkerTable extends VoltProcedure {
         "TRUNCATE TABLE DataLocation;"
     );
 
+    public final SQLStmt truncateIdleWorkerTable = new SQLStmt (
+        "TRUNCATE TABLE IdleWorker;"
+    );
+
+    public final SQLStmt truncateHeartbeatTable = new SQLStmt (
+        "TRUNCATE TABLE WorkerHeartbeat;"
+    );
+
     public long run() throws VoltAbortException {
         voltQueueSQL(truncateWorkerTable);
         voltExecuteSQL();
         voltQueueSQL(truncateDataShardTable);
         voltExecuteSQL();
+        voltQueueSQL(truncateIdleWorkerTable);
+        voltExecuteSQL();
+        voltQueueSQL(truncateHeartbeatTable);
+        voltExecuteSQL();
         return 0;
     }
 }
\ No newline at end of file
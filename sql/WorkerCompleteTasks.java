@@ -0,0 +1,17 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Mark a batch of a worker's tasks complete and give back the capacity they
+// held with a single update. results is empty, or holds the result blob of
+// each task (empty for none). Return the number of completed tasks.
+public class WorkerCompleteTasks extends CompleteTaskProcedure {
+
+    public long run(int pkey, long workerId, int[] taskIds, byte[][] results) throws VoltAbortException {
+        long completed = complete(pkey, workerId, taskIds, results);
+        if (completed > 0) {
+            voltExecuteSQL(true);
+        }
+        return completed;
+    }
+}
@@ -0,0 +1,21 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+
+// Complete the tasks a worker finished since its last call and dequeue up to
+// topk new tasks for it, in one single-partition transaction.
+// Combines WorkerCompleteTasks and WorkerSelectTask; takes the same results
+// as WorkerCompleteTasks, returns the same TaskID, Payload, TaskType table as
+// WorkerSelectTask, and leases tasks and parks the worker the same way.
+public class WorkerExchange extends DequeueTaskProcedure {
+
+    public VoltTable[] run(int pkey, long workerId, int[] completedIds, byte[][] results, long topk, String wakeupUrl, long leaseMsec) throws VoltAbortException {
+        // Complete finished tasks; only running tasks are completed.
+        long completed = complete(pkey, workerId, completedIds, results);
+
+        // Dequeue new tasks and return their ids, payloads and types.
+        VoltTable tasks = dequeue(pkey, workerId, topk, leaseMsec, wakeupUrl,
+            completed > 0 ? 1 : 0);
+        return new VoltTable[] { tasks };
+    }
+}
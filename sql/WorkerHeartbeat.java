@@ -0,0 +1,29 @@
+package dbos.procedures;
+
+import org.voltdb.*;
+import org.voltdb.types.TimestampType;
+
+// Record that the given workers of a partition are alive. One call covers all
+// the workers of a process in this partition.
+public class WorkerHeartbeat extends VoltProcedure {
+
+    // VoltDB executes at most this many statements per batch.
+    private static final int MAX_BATCH = 200;
+
+    public final SQLStmt upsertHeartbeat = new SQLStmt(
+        "UPSERT INTO WorkerHeartbeat (WorkerID, PKey, LastSeen) VALUES (?, ?, ?);"
+    );
+
+    public long run(int pkey, int[] workerIds) throws VoltAbortException {
+        // Use the transaction time so replicas store the same value.
+        TimestampType now = new TimestampType(getTransactionTime());
+        for (int i = 0; i < workerIds.length; i++) {
+            voltQueueSQL(upsertHeartbeat, workerIds[i], pkey, now);
+            if ((i + 1) % MAX_BATCH == 0) {
+                voltExecuteSQL();
+            }
+        }
+        voltExecuteSQL(true);
+        return workerIds.length;
+    }
+}
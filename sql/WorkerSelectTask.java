@@ -2,43 +2,17 @@ package dbos.procedures;
 
 import org.voltdb.*;
 
-// Select top-K tasks that are pending and assigned to this worker.
-// Update task status to running.
-public class WorkerSelectTask extends VoltProcedure {
+// Dequeue the top-K pending tasks of this worker in FIFO order, move them to
+// Task as running, and return their ids, payloads and types. If there is none and
+// wakeupUrl is not empty, park the worker in IdleWorker so the next task
+// queued for it triggers a push.
+// If leaseMsec > 0, each task is leased to the worker for that long: the worker
+// renews the lease with RenewTaskLeases while it holds the task, and
+// ExpireTaskLeases requeues the task if the lease runs out.
+public class WorkerSelectTask extends DequeueTaskProcedure {
 
-    // Task states.
-    final long PENDING = 1;
-    final long RUNNING = 2;
-    final long COMPLETE = 3;
-
-    public final SQLStmt selectPendingTasks = new SQLStmt (
-        "SELECT TaskID FROM Task WHERE PKey=? AND WorkerID=? AND State=1 LIMIT ?;"
-    );
-    
-    public final SQLStmt updateTaskRunning = new SQLStmt(
-        "UPDATE Task SET State=2 WHERE PKey=? AND TaskID=? AND WorkerID=?;"
-    );
-
-    public VoltTable[] run(int pkey, long workerId, long topk) throws VoltAbortException {
-        // Select pending topk tasks.
-        voltQueueSQL(selectPendingTasks, pkey, workerId, topk);
-        VoltTable[] results = voltExecuteSQL();
-        VoltTable r = results[0];
-        int numTasks = r.getRowCount();
-        if (numTasks < 1) {
-            // Return empty table.
-            return results;
-        }
-        
-        // Iteratively update tasks.
-        for (int i = 0; i < numTasks; i++) {
-          long taskId = r.fetchRow(i).getLong(0);
-          voltQueueSQL(updateTaskRunning, pkey, taskId, workerId);
-        }
-        
-        voltExecuteSQL();
-
-        // Return task ids.
-        return results;
+    public VoltTable[] run(int pkey, long workerId, long topk, String wakeupUrl, long leaseMsec) throws VoltAbortException {
+        // Return task ids, payloads and types.
+        return new VoltTable[] { dequeue(pkey, workerId, topk, leaseMsec, wakeupUrl, 0) };
     }
 }
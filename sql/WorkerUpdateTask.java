@@ -2,7 +2,8 @@ package dbos.procedures;
 
 import org.voltdb.*;
 
-// Update a task state on a worker.
+// Update a task state on a worker. A completed task stores its result blob,
+// if it has one (empty for none).
 public class WorkerUpdateTask extends VoltProcedure {
 
     // Task states.
@@ -17,17 +18,39 @@ public class WorkerUpdateTask extends VoltProcedure {
         "UPDATE Task SET State=? WHERE PKey=? AND TaskID=? AND WorkerID=?;"
     );
 
+    // Only a running task is completed, so a late or repeated completion does
+    // not credit the capacity twice.
+    public final SQLStmt completeTask = new SQLStmt(
+        "UPDATE Task SET State=?, FinishTime=NOW WHERE PKey=? AND TaskID=? AND WorkerID=? AND State=2;"
+    );
+
+    public final SQLStmt completeTaskWithResult = new SQLStmt(
+        "UPDATE Task SET State=?, FinishTime=NOW, Result=? WHERE PKey=? AND TaskID=? AND WorkerID=? AND State=2;"
+    );
+
     public final SQLStmt updateCapacity = new SQLStmt(
         "UPDATE Worker SET Capacity=Capacity+1 WHERE PKey=? AND WorkerID=?;"
     );
 
 
-    public long run(int pkey, long workerId, long taskId, long taskState) throws VoltAbortException {
+    public long run(int pkey, long workerId, long taskId, long taskState, byte[] result) throws VoltAbortException {
         // TODO: add sanity check that taskState is valid?
-        voltQueueSQL(updateTask, taskState, pkey, taskId, workerId);
         if (taskState == COMPLETE) {
-          // If change to complete, then add back one capacity.
+          // Record the finish time for PurgeCompletedTasks, and add back one
+          // capacity. A task whose lease expired was requeued and its
+          // capacity already given back, and a completed task is no longer
+          // running, so neither matches.
+          if (result == null || result.length == 0) {
+            voltQueueSQL(completeTask, taskState, pkey, taskId, workerId);
+          } else {
+            voltQueueSQL(completeTaskWithResult, taskState, result, pkey, taskId, workerId);
+          }
+          if (voltExecuteSQL()[0].asScalarLong() != 1) {
+            return SUCCESS;
+          }
           voltQueueSQL(updateCapacity, pkey, workerId);
+        } else {
+          voltQueueSQL(updateTask, taskState, pkey, taskId, workerId);
         }
         voltExecuteSQL();
         return SUCCESS;
@@ -3,8 +3,52 @@ CREATE TABLE Task (
     TaskID INTEGER NOT NULL,
     WorkerID INTEGER NOT NULL,
     State INTEGER NOT NULL,
-    PKey INTEGER NOT NULL
+    PKey INTEGER NOT NULL,
+    FinishTime TIMESTAMP,
+    LeaseExpiry TIMESTAMP,
+    Payload VARBINARY(524288),
+    Result VARBINARY(524288),
+    TaskType INTEGER DEFAULT 0 NOT NULL
 );
 PARTITION TABLE Task ON COLUMN PKey;
 CREATE ASSUMEUNIQUE INDEX taskIDIndex ON Task (taskID);
-CREATE INDEX stateIndex ON Task (State);
+CREATE INDEX finishTimeIndex ON Task (State, FinishTime);
+-- Running tasks dequeued with a lease carry its deadline in LeaseExpiry; the
+-- worker renews it while it holds the task. ExpireTaskLeases walks this index
+-- from the oldest deadline, so it only reads expired leases.
+CREATE INDEX leaseIndex ON Task (State, LeaseExpiry);
+
+-- Pending tasks that are assigned to a worker, in dispatch order. Workers
+-- dequeue from here (WorkerSelectTask), which moves the rows into Task as
+-- running, so the dequeue cost does not depend on the size of Task.
+-- The optional opaque Payload and the TaskType of a task move along with it
+-- and are returned to the worker; the worker stores the Result blob on
+-- completion. TaskType picks the task function in the worker's TaskRegistry, 0
+-- runs the worker's default.
+CREATE TABLE PendingTask (
+    TaskID INTEGER NOT NULL,
+    WorkerID INTEGER NOT NULL,
+    Seq BIGINT NOT NULL,
+    PKey INTEGER NOT NULL,
+    Payload VARBINARY(524288),
+    TaskType INTEGER DEFAULT 0 NOT NULL
+);
+PARTITION TABLE PendingTask ON COLUMN PKey;
+CREATE UNIQUE INDEX pendingQueueIndex ON PendingTask (PKey, WorkerID, Seq, TaskID);
+
+-- Resources each task used, as measured by the executor that ran it. Workers
+-- store them in batches (ReportTaskUsage); schedulers can read them for
+-- size-aware placement. Rows go away with their task (PurgeCompletedTasks).
+CREATE TABLE TaskUsage (
+    TaskID INTEGER NOT NULL,
+    WorkerID INTEGER NOT NULL,
+    PKey INTEGER NOT NULL,
+    QueueUsec BIGINT NOT NULL,
+    WallUsec BIGINT NOT NULL,
+    CpuUsec BIGINT NOT NULL,
+    ContextSwitches BIGINT NOT NULL,
+    FinishTime TIMESTAMP NOT NULL
+);
+PARTITION TABLE TaskUsage ON COLUMN PKey;
+CREATE UNIQUE INDEX taskUsageIndex ON TaskUsage (PKey, TaskID);
+CREATE INDEX taskUsageWorkerIndex ON TaskUsage (PKey, WorkerID);
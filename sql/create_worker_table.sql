@@ -9,3 +9,27 @@ PARTITION TABLE Worker ON COLUMN PKey;
 CREATE INDEX workerIDIndex ON Worker (workerID);
 CREATE INDEX capacityIndex ON Worker (Capacity);
 CREATE INDEX dataShardsIndex ON Worker (DataShards, Capacity);
+
+-- Poll workers that found their queue empty and asked to be woken up. The
+-- first task queued for a parked worker removes its row and emits a TaskAssign
+-- record to Url, so the worker can sleep instead of polling.
+CREATE TABLE IdleWorker (
+    WorkerID INTEGER NOT NULL,
+    PKey INTEGER NOT NULL,
+    Url VARCHAR(512) NOT NULL
+);
+PARTITION TABLE IdleWorker ON COLUMN PKey;
+CREATE UNIQUE INDEX idleWorkerIndex ON IdleWorker (PKey, WorkerID);
+
+-- Last heartbeat of each live worker. A HeartbeatAggregator refreshes all the
+-- workers of a process and partition with one WorkerHeartbeat call, and
+-- ReapDeadWorkers scans heartbeatTimeIndex from the oldest row, so a sweep of
+-- a healthy partition reads no rows.
+CREATE TABLE WorkerHeartbeat (
+    WorkerID INTEGER NOT NULL,
+    PKey INTEGER NOT NULL,
+    LastSeen TIMESTAMP NOT NULL
+);
+PARTITION TABLE WorkerHeartbeat ON COLUMN PKey;
+CREATE UNIQUE INDEX heartbeatWorkerIndex ON WorkerHeartbeat (PKey, WorkerID);
+CREATE INDEX heartbeatTimeIndex ON WorkerHeartbeat (PKey, LastSeen);
@@ -6,6 +6,12 @@ CREATE PROCEDURE FROM CLASS dbos.procedures.InsertTask;
 DROP PROCEDURE InsertWorker IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey PARAMETER 2 FROM CLASS dbos.procedures.InsertWorker;
 
+DROP PROCEDURE BulkInsertTask IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.BulkInsertTask;
+
+DROP PROCEDURE BulkInsertWorker IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey FROM CLASS dbos.procedures.BulkInsertWorker;
+
 DROP PROCEDURE InsertSparkWorker IF EXISTS;
 CREATE PROCEDURE FROM CLASS dbos.procedures.InsertSparkWorker;
 
@@ -15,6 +21,9 @@ CREATE PROCEDURE FROM CLASS dbos.procedures.SelectTaskWorker;
 DROP PROCEDURE SelectWorker IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey FROM CLASS dbos.procedures.SelectWorker;
 
+DROP PROCEDURE PeekWorker IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey FROM CLASS dbos.procedures.PeekWorker;
+
 DROP PROCEDURE SelectOrderedWorker IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey FROM CLASS dbos.procedures.SelectOrderedWorker;
 
@@ -36,6 +45,9 @@ CREATE PROCEDURE FROM CLASS dbos.procedures.TruncateWorkerTable;
 DROP PROCEDURE FinishWorkerTask IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey PARAMETER 2 FROM CLASS dbos.procedures.FinishWorkerTask;
 
+DROP PROCEDURE FinishWorkerTasks IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey FROM CLASS dbos.procedures.FinishWorkerTasks;
+
 DROP PROCEDURE ScanPartitionedTaskWorker IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.ScanPartitionedTaskWorker;
 
@@ -48,6 +60,30 @@ CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.
 DROP PROCEDURE WorkerUpdateTask IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.WorkerUpdateTask;
 
+DROP PROCEDURE WorkerCompleteTasks IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.WorkerCompleteTasks;
+
+DROP PROCEDURE WorkerExchange IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.WorkerExchange;
+
+DROP PROCEDURE ReportTaskUsage IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE TaskUsage COLUMN PKey FROM CLASS dbos.procedures.ReportTaskUsage;
+
+DROP PROCEDURE PurgeCompletedTasks IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.PurgeCompletedTasks;
+
+DROP PROCEDURE RenewTaskLeases IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.RenewTaskLeases;
+
+DROP PROCEDURE ExpireTaskLeases IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE Task COLUMN PKey FROM CLASS dbos.procedures.ExpireTaskLeases;
+
+DROP PROCEDURE WorkerHeartbeat IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE WorkerHeartbeat COLUMN PKey FROM CLASS dbos.procedures.WorkerHeartbeat;
+
+DROP PROCEDURE ReapDeadWorkers IF EXISTS;
+CREATE PROCEDURE PARTITION ON TABLE WorkerHeartbeat COLUMN PKey FROM CLASS dbos.procedures.ReapDeadWorkers;
+
 DROP PROCEDURE PushTask IF EXISTS;
 CREATE PROCEDURE PARTITION ON TABLE Worker COLUMN PKey FROM CLASS dbos.procedures.PushTask;
 
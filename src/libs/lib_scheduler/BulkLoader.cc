@@ -0,0 +1,132 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <iostream>
+#include <vector>
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+#include "BenchmarkUtil.h"
+#include "BulkLoader.h"
+#include "VoltdbResultDecoder.h"
+
+// Print progress every kProgressRows rows.
+static const int64_t kProgressRows = 100000;
+
+bool BulkLoader::LoadCallback::callback(
+    voltdb::InvocationResponse response) throw(voltdb::Exception) {
+  outCnt_--;
+  if (response.failure()) {
+    std::cout << "Bulk insert procedure failed. " << response.toString()
+              << std::endl;
+    failed_ = true;
+    return false;
+  }
+  // The procedures return the number of inserted rows.
+  loaded_ += VoltdbResultDecoder::getScalarInt64(response);
+  if (loaded_ - reported_ >= kProgressRows) {
+    double elapsedSec =
+        (BenchmarkUtil::getCurrTimeUsec() - startTimeUsec_) / 1000000.0;
+    std::cout << "Loaded " << loaded_ << " rows ("
+              << (int64_t)(loaded_ / elapsedSec) << " rows/sec)" << std::endl;
+    reported_ = loaded_;
+  }
+  return false;
+}
+
+BulkLoader::BulkLoader(voltdb::Client* client, int partitions,
+                       size_t batchSize, int64_t maxOutstanding)
+    : client_(client),
+      batchSize_(batchSize),
+      maxOutstanding_(maxOutstanding),
+      queued_(0),
+      workerBatches_(partitions),
+      taskBatches_(partitions),
+      callback_(new LoadCallback()) {
+  callback_->startTimeUsec_ = BenchmarkUtil::getCurrTimeUsec();
+}
+
+DbosStatus BulkLoader::addWorker(DbosId workerID, int32_t capacity, int pkey) {
+  WorkerBatch& batch = workerBatches_[pkey];
+  batch.workerIDs.push_back(workerID);
+  batch.capacities.push_back(capacity);
+  queued_++;
+  if (batch.workerIDs.size() >= batchSize_) { return flushWorkers(pkey); }
+  return true;
+}
+
+DbosStatus BulkLoader::addTask(DbosId taskID, DbosId workerID, int32_t state,
+                               int pkey) {
+  TaskBatch& batch = taskBatches_[pkey];
+  batch.taskIDs.push_back(taskID);
+  batch.workerIDs.push_back(workerID);
+  batch.states.push_back(state);
+  queued_++;
+  if (batch.taskIDs.size() >= batchSize_) { return flushTasks(pkey); }
+  return true;
+}
+
+DbosStatus BulkLoader::flushWorkers(int pkey) {
+  WorkerBatch& batch = workerBatches_[pkey];
+  if (batch.workerIDs.empty()) { return true; }
+  std::vector<voltdb::Parameter> parameterTypes(3);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+
+  voltdb::Procedure procedure("BulkInsertWorker", parameterTypes);
+  voltdb::ParameterSet* params = procedure.params();
+  params->addInt32(pkey).addInt32(batch.workerIDs).addInt32(batch.capacities);
+  client_->invoke(procedure, callback_);
+  callback_->outCnt_++;
+  batch.workerIDs.clear();
+  batch.capacities.clear();
+  waitForWindow();
+  return !callback_->failed_;
+}
+
+DbosStatus BulkLoader::flushTasks(int pkey) {
+  TaskBatch& batch = taskBatches_[pkey];
+  if (batch.taskIDs.empty()) { return true; }
+  std::vector<voltdb::Parameter> parameterTypes(4);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+
+  voltdb::Procedure procedure("BulkInsertTask", parameterTypes);
+  voltdb::ParameterSet* params = procedure.params();
+  params->addInt32(pkey)
+      .addInt32(batch.taskIDs)
+      .addInt32(batch.workerIDs)
+      .addInt32(batch.states);
+  client_->invoke(procedure, callback_);
+  callback_->outCnt_++;
+  batch.taskIDs.clear();
+  batch.workerIDs.clear();
+  batch.states.clear();
+  waitForWindow();
+  return !callback_->failed_;
+}
+
+void BulkLoader::waitForWindow() {
+  while (callback_->outCnt_ >= maxOutstanding_) { client_->runOnce(); }
+}
+
+DbosStatus BulkLoader::finish() {
+  for (size_t pkey = 0; pkey < workerBatches_.size(); ++pkey) {
+    flushWorkers(pkey);
+    flushTasks(pkey);
+  }
+  // Give outstanding requests time to finish.
+  while (!client_->drain()) {}
+
+  double elapsedSec =
+      (BenchmarkUtil::getCurrTimeUsec() - callback_->startTimeUsec_) /
+      1000000.0;
+  std::cout << "Bulk loaded " << callback_->loaded_ << "/" << queued_
+            << " rows in " << elapsedSec << " sec" << std::endl;
+  return !callback_->failed_ && (callback_->loaded_ == queued_);
+}
@@ -0,0 +1,78 @@
+// This file contains a bulk loader for populating the Worker and Task tables.
+#ifndef DBOS_BULK_LOADER_H
+#define DBOS_BULK_LOADER_H
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "DbosDefs.h"
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/ProcedureCallback.hpp"
+
+// Loads rows through the BulkInsertWorker/BulkInsertTask procedures instead of
+// one synchronous InsertWorker/InsertTask call per row. Rows are buffered per
+// PKey, so each invocation is a single-partition transaction that inserts a
+// whole batch. Invocations are asynchronous with a bounded number in flight.
+// Note: not thread safe, same as the voltdb::Client it uses.
+class BulkLoader {
+public:
+  BulkLoader(voltdb::Client* client, int partitions, size_t batchSize = 1000,
+             int64_t maxOutstanding = 64);
+
+  // Buffer a worker row. Flush the batch of its partition when full.
+  DbosStatus addWorker(DbosId workerID, int32_t capacity, int pkey);
+
+  // Buffer a task row. Flush the batch of its partition when full.
+  DbosStatus addTask(DbosId taskID, DbosId workerID, int32_t state, int pkey);
+
+  // Flush all partial batches and wait for every invocation to complete.
+  DbosStatus finish();
+
+  // Callback for bulk insert invocations; tracks progress and failures.
+  class LoadCallback : public voltdb::ProcedureCallback {
+  public:
+    LoadCallback()
+        : outCnt_(0),
+          loaded_(0),
+          reported_(0),
+          failed_(false),
+          startTimeUsec_(0) {}
+
+    bool callback(voltdb::InvocationResponse response) throw(voltdb::Exception);
+
+    int64_t outCnt_;    // outstanding invocations
+    int64_t loaded_;    // rows acknowledged by the DB
+    int64_t reported_;  // rows at the last progress report
+    bool failed_;
+    uint64_t startTimeUsec_;  // for load throughput
+  };
+
+private:
+  struct WorkerBatch {
+    std::vector<int32_t> workerIDs;
+    std::vector<int32_t> capacities;
+  };
+
+  struct TaskBatch {
+    std::vector<int32_t> taskIDs;
+    std::vector<int32_t> workerIDs;
+    std::vector<int32_t> states;
+  };
+
+  DbosStatus flushWorkers(int pkey);
+  DbosStatus flushTasks(int pkey);
+
+  // Run the event loop until fewer than maxOutstanding_ requests are pending.
+  void waitForWindow();
+
+  voltdb::Client* client_;
+  size_t batchSize_;
+  int64_t maxOutstanding_;
+  int64_t queued_;  // rows handed to add*()
+  std::vector<WorkerBatch> workerBatches_;  // indexed by PKey
+  std::vector<TaskBatch> taskBatches_;      // indexed by PKey
+  boost::shared_ptr<LoadCallback> callback_;
+};
+
+#endif  // #ifndef DBOS_BULK_LOADER_H
@@ -0,0 +1,75 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <iostream>
+#include <vector>
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+#include "LivenessDetector.h"
+
+void LivenessDetector::report() {
+  std::cout << "LivenessDetector reaped " << deadWorkers_.load()
+            << " workers and requeued " << requeuedTasks_.load()
+            << " tasks, expired " << expiredLeases_.load() << " leases\n";
+}
+
+int LivenessDetector::reapPartition(voltdb::Client* client, int pkey) {
+  std::vector<voltdb::Parameter> parameterTypes(3);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  voltdb::Procedure procedure("ReapDeadWorkers", parameterTypes);
+  voltdb::ParameterSet* params = procedure.params();
+  params->addInt32(pkey).addInt64(timeoutMsec_).addInt32(batchSize_);
+  voltdb::InvocationResponse r = client->invoke(procedure);
+  if (r.failure()) {
+    std::cout << "ReapDeadWorkers procedure failed. " << r.toString();
+    return -1;
+  }
+  if (!decoder_.decode(r)) { return -1; }
+  int reaped = 0;
+  for (int32_t i = 0; i < decoder_.rowCount(); ++i) {
+    int64_t requeued = decoder_.getInt64(i, 1);
+    // A fenced worker waits for a live worker to take its tasks; it comes
+    // back on every sweep until then, so it is neither logged nor counted.
+    if (requeued < 0) { continue; }
+    std::cout << "Worker " << decoder_.getInt64(i, 0) << " is dead, requeued "
+              << requeued << " tasks\n";
+    requeuedTasks_ += requeued;
+    reaped++;
+  }
+  deadWorkers_ += reaped;
+  return reaped;
+}
+
+int64_t LivenessDetector::expirePartition(voltdb::Client* client, int pkey) {
+  std::vector<voltdb::Parameter> parameterTypes(2);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  voltdb::Procedure procedure("ExpireTaskLeases", parameterTypes);
+  voltdb::ParameterSet* params = procedure.params();
+  params->addInt32(pkey).addInt32(batchSize_);
+  voltdb::InvocationResponse r = client->invoke(procedure);
+  if (r.failure()) {
+    std::cout << "ExpireTaskLeases procedure failed. " << r.toString();
+    return -1;
+  }
+  int64_t expired = VoltdbResultDecoder::getScalarInt64(r);
+  expiredLeases_ += expired;
+  return expired;
+}
+
+bool LivenessDetector::sweepPartition(voltdb::Client* client, int pkey) {
+  // A full batch means there may be more to do in this partition.
+  bool backlog = false;
+  if (timeoutMsec_ > 0 && reapPartition(client, pkey) >= batchSize_) {
+    backlog = true;
+  }
+  if (expireLeases_ && expirePartition(client, pkey) >= batchSize_) {
+    backlog = true;
+  }
+  return backlog;
+}
@@ -0,0 +1,79 @@
+// This file contains a background detector that reaps dead workers and
+// expired task leases.
+#ifndef DBOS_LIVENESS_DETECTOR_H
+#define DBOS_LIVENESS_DETECTOR_H
+
+#include <atomic>
+#include <string>
+
+#include "DbosDefs.h"
+#include "PeriodicJob.h"
+#include "VoltdbResultDecoder.h"
+#include "voltdb-client-cpp/include/Client.h"
+
+// Workers that beat through a HeartbeatAggregator have a row in
+// WorkerHeartbeat. Each sweep calls ReapDeadWorkers on each partition. A worker
+// whose last beat is older than timeoutMsec is declared dead: its capacity is
+// removed and its running and queued tasks move to the PendingTask queue of a
+// live worker of the same partition, which dequeues them. If the partition has
+// no live worker, the dead worker is fenced off and reaped once one appears.
+// A worker is reaped between timeoutMsec and timeoutMsec + intervalMsec after
+// its last beat. A timeout <= 0 disables reaping.
+// If expireLeases is true, each sweep also calls ExpireTaskLeases, which
+// requeues running tasks whose lease ran out, e.g. because the worker that
+// holds them stopped renewing.
+// A sweep of a healthy partition is one index probe per call, and nothing is
+// done per task until a worker dies or a lease expires. Tasks the
+// SparkScheduler sends over gRPC never go through PendingTask; it re-sends
+// them itself when the call or stream to their worker fails.
+class LivenessDetector : public PeriodicJob {
+public:
+  LivenessDetector(const std::string& dbAddr, const std::string& username,
+                   const std::string& password, int partitions,
+                   int64_t timeoutMsec, bool expireLeases = false,
+                   int intervalMsec = 100, int batchSize = 100)
+      : PeriodicJob(dbAddr, username, password, partitions, intervalMsec),
+        timeoutMsec_(timeoutMsec),
+        expireLeases_(expireLeases),
+        batchSize_(batchSize),
+        deadWorkers_(0),
+        requeuedTasks_(0),
+        expiredLeases_(0) {}
+
+  ~LivenessDetector() { stop(); }
+
+  // Number of workers declared dead so far.
+  int64_t deadWorkers() const { return deadWorkers_.load(); }
+
+  // Number of tasks requeued from dead workers so far.
+  int64_t requeuedTasks() const { return requeuedTasks_.load(); }
+
+  // Number of tasks requeued because their lease expired so far.
+  int64_t expiredLeases() const { return expiredLeases_.load(); }
+
+protected:
+  // Reap dead workers and expire leases in a partition.
+  bool sweepPartition(voltdb::Client* client, int pkey) override;
+
+  void report() override;
+
+private:
+  // Reap up to batchSize dead workers of a partition. Return the number of
+  // reaped workers, or -1 on failure.
+  int reapPartition(voltdb::Client* client, int pkey);
+
+  // Requeue up to batchSize tasks of a partition whose lease expired. Return
+  // the number of requeued tasks, or -1 on failure.
+  int64_t expirePartition(voltdb::Client* client, int pkey);
+
+  int64_t timeoutMsec_;
+  bool expireLeases_;
+  int batchSize_;
+  VoltdbResultDecoder decoder_;  // only used by the detector thread
+
+  std::atomic<int64_t> deadWorkers_;
+  std::atomic<int64_t> requeuedTasks_;
+  std::atomic<int64_t> expiredLeases_;
+};
+
+#endif  // #ifndef DBOS_LIVENESS_DETECTOR_H
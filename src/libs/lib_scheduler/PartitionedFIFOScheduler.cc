@@ -12,6 +12,7 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BulkLoader.h"
 #include "PartitionedFIFOScheduler.h"
 
 void PartitionedFIFOScheduler::truncateWorkerTable() {
@@ -24,28 +25,6 @@ void PartitionedFIFOScheduler::truncateWorkerTable() {
   }
 }
 
-DbosStatus PartitionedFIFOScheduler::insertWorker(DbosId workerID,
-                                                  int32_t capacity) {
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
-
-  voltdb::Procedure procedure("InsertWorker", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(workerID)
-      .addInt32(capacity)
-      .addInt32(workerID % workerPartitions_)
-      .addString("");
-  voltdb::InvocationResponse r = client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "InsertWorker procedure failed. " << r.toString();
-    return false;
-  }
-  return true;
-}
-
 DbosId PartitionedFIFOScheduler::selectWorker() {
   std::vector<voltdb::Parameter> parameterTypes(1);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
@@ -62,9 +41,7 @@ DbosId PartitionedFIFOScheduler::selectWorker() {
                 << std::endl;
       return -1;
     }
-    std::vector<voltdb::Table> results = r.results();
-    voltdb::Row row = results[0].iterator().next();
-    DbosId selectedWorker = row.getInt64(0);
+    DbosId selectedWorker = VoltdbResultDecoder::getScalarInt64(r);
     if (selectedWorker != -1) { return selectedWorker; }
   }
   return -1;
@@ -100,12 +77,13 @@ DbosStatus PartitionedFIFOScheduler::finishTask(DbosId taskId,
 DbosStatus PartitionedFIFOScheduler::setup() {
   // Clean up data from previous run.
   truncateWorkerTable();
-  DbosStatus ret;
+  BulkLoader loader(client_, workerPartitions_);
   for (int i = 0; i < numWorkers_; ++i) {
-    ret = insertWorker(i, workerCapacity_);
-    if (!ret) { return false; }
+    if (!loader.addWorker(i, workerCapacity_, i % workerPartitions_)) {
+      return false;
+    }
   }
-  return true;
+  return loader.finish();
 }
 
 DbosStatus PartitionedFIFOScheduler::teardown() {
@@ -114,6 +92,30 @@ DbosStatus PartitionedFIFOScheduler::teardown() {
   return true;
 }
 
+DbosStatus PartitionedFIFOScheduler::warmup(int rounds) {
+  if (!VoltdbSchedulerUtil::warmup(rounds)) { return false; }
+  // PeekWorker runs the same worker lookup as SelectWorker on a partition
+  // but takes no capacity, so the tables are unchanged when measuring.
+  std::vector<voltdb::Parameter> parameterTypes(1);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  voltdb::Procedure procedure("PeekWorker", parameterTypes);
+  int activePartitions = std::min(workerPartitions_, numWorkers_);
+  for (int i = 0; i < rounds; ++i) {
+    for (int partitionNum = 0; partitionNum < activePartitions;
+         ++partitionNum) {
+      voltdb::ParameterSet* params = procedure.params();
+      params->addInt32(partitionNum);
+      voltdb::InvocationResponse r = client_->invoke(procedure);
+      if (r.failure()) {
+        std::cout << "PeekWorker procedure failed. " << r.toString()
+                  << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 DbosStatus PartitionedFIFOScheduler::schedule(Task* task) {
   DbosId workerId = selectWorker();
   assert(workerId >= 0);
@@ -26,9 +26,6 @@ public:
   // Truncate the worker table;
   void truncateWorkerTable();
 
-  // Insert a worker into the worker table.
-  DbosStatus insertWorker(DbosId workerID, DbosId capacity);
-
   // Select a worker for a task and update worker capacity.
   // Return the selected worker id.
   DbosId selectWorker();
@@ -46,6 +43,10 @@ public:
   // Tear down the database after benchmarking.
   DbosStatus teardown();
 
+  // Prime the worker lookup of SelectWorker on every active partition,
+  // read-only.
+  DbosStatus warmup(int rounds);
+
   // Perform a scheduling act.
   DbosStatus schedule(Task* task);
 
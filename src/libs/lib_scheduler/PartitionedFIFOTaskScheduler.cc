@@ -12,6 +12,7 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BulkLoader.h"
 #include "PartitionedFIFOTaskScheduler.h"
 
 #define SUCCESS 0
@@ -40,50 +41,10 @@ void PartitionedFIFOTaskScheduler::truncateTaskTable() {
   }
 }
 
-DbosStatus PartitionedFIFOTaskScheduler::insertWorker(DbosId workerID,
-                                                      int32_t capacity) {
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
-
-  voltdb::Procedure procedure("InsertWorker", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(workerID)
-      .addInt32(capacity)
-      .addInt32(workerID % partitions_)
-      .addString("");
-  voltdb::InvocationResponse r = client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "InsertWorker procedure failed. " << r.toString();
-    return false;
-  }
-  return true;
-}
-
-DbosStatus PartitionedFIFOTaskScheduler::insertTask(DbosId taskID) {
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-
-  voltdb::Procedure procedure("InsertTask", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(taskID).addInt32(-1).addInt32(1).addInt32(taskID %
-                                                             partitions_);
-  voltdb::InvocationResponse r = client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "InsertWorker procedure failed. " << r.toString();
-    return false;
-  }
-  return true;
-}
-
 DbosStatus PartitionedFIFOTaskScheduler::selectTaskWorker() {
-  std::vector<voltdb::Parameter> parameterTypes(1);
+  std::vector<voltdb::Parameter> parameterTypes(2);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
   // Actual num partitions.
   int activePartitions =
       std::min(partitions_, std::max(numWorkers_, numTasks_));
@@ -98,16 +59,14 @@ DbosStatus PartitionedFIFOTaskScheduler::selectTaskWorker() {
       voltdb::Procedure procedure("SelectPartitionedTaskWorker",
                                   parameterTypes);
       voltdb::ParameterSet* params = procedure.params();
-      params->addInt32(pkey);
+      params->addInt32(pkey).addInt8(pushWakeup_);
       voltdb::InvocationResponse r = client_->invoke(procedure);
       if (r.failure()) {
         std::cout << "SelectPartitionedTaskWorker procedure failed. "
                   << r.toString() << std::endl;
         return false;
       }
-      std::vector<voltdb::Table> results = r.results();
-      voltdb::Row row = results[0].iterator().next();
-      int status = row.getInt64(0);
+      int status = VoltdbResultDecoder::getScalarInt64(r);
       if (status == SUCCESS) {
         return true;
       } else if (status == NOWORKER) {
@@ -128,34 +87,26 @@ DbosStatus PartitionedFIFOTaskScheduler::selectTaskWorker() {
     std::cout << "SelectWorker procedure failed. " << r.toString() << std::endl;
     return false;
   }
-  std::vector<voltdb::Table> results = r.results();
-  voltdb::Row row = results[0].iterator().next();
-  int status = row.getInt64(0);
+  int status = VoltdbResultDecoder::getScalarInt64(r);
   if (status == SUCCESS) { return true; }
   return false;
-
-  // Insert a task
-  // bool ret = insertTask(numTasks_ + taskindex.fetch_add(1));
-  // if (!ret) { return false; }
-  // return true;
 }
 
 DbosStatus PartitionedFIFOTaskScheduler::setup() {
   // Clean up data from previous run.
   truncateWorkerTable();
   truncateTaskTable();
-  DbosStatus ret;
-  std::cout << "Foo" << std::endl;
+  BulkLoader loader(client_, partitions_);
   for (int i = 0; i < numWorkers_; ++i) {
-    ret = insertWorker(i, workerCapacity_);
-    if (!ret) { return false; }
+    if (!loader.addWorker(i, workerCapacity_, i % partitions_)) {
+      return false;
+    }
   }
-  std::cout << "Foo" << std::endl;
+  // Tasks start unassigned (worker -1) and pending.
   for (int i = 0; i < numTasks_; ++i) {
-    ret = insertTask(i);
-    if (!ret) { return false; }
+    if (!loader.addTask(i, -1, 1, i % partitions_)) { return false; }
   }
-  return true;
+  return loader.finish();
 }
 
 DbosStatus PartitionedFIFOTaskScheduler::teardown() {
@@ -30,12 +30,6 @@ public:
   // Truncate the worker table;
   void truncateTaskTable();
 
-  // Insert a worker into the worker table.
-  DbosStatus insertWorker(DbosId workerID, DbosId capacity);
-
-  // Insert a task into the task table.
-  DbosStatus insertTask(DbosId taskID);
-
   // Select a worker for a task and update worker capacity and task workerid.
   DbosStatus selectTaskWorker();
 
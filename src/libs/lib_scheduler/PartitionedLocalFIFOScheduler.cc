@@ -12,6 +12,7 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BulkLoader.h"
 #include "PartitionedLocalFIFOScheduler.h"
 
 static std::atomic<uint32_t> taskindex;
@@ -36,48 +37,25 @@ void PartitionedLocalFIFOScheduler::truncateTaskTable() {
   }
 }
 
-DbosStatus PartitionedLocalFIFOScheduler::insertWorker(DbosId workerID,
-                                                  int32_t capacity) {
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
-
-  voltdb::Procedure procedure("InsertWorker", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(workerID)
-      .addInt32(capacity)
-      .addInt32(workerID % workerPartitions_)
-      .addString("");
-  voltdb::InvocationResponse r = client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "InsertWorker procedure failed. " << r.toString();
-    return false;
-  }
-  return true;
-}
-
 DbosId PartitionedLocalFIFOScheduler::selectWorker(DbosId taskID) {
-  std::vector<voltdb::Parameter> parameterTypes(2);
+  std::vector<voltdb::Parameter> parameterTypes(3);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
   int activePartitions = std::min(workerPartitions_, numWorkers_);
   int offset = rand() % activePartitions;
   for (int count = 0; count < activePartitions; count++) {
     int partitionNum = (count + offset) % activePartitions;
     voltdb::Procedure procedure("SelectOrderedWorker", parameterTypes);
     voltdb::ParameterSet* params = procedure.params();
-    params->addInt32(partitionNum).addInt32(taskID);
+    params->addInt32(partitionNum).addInt32(taskID).addInt8(pushWakeup_);
     voltdb::InvocationResponse r = client_->invoke(procedure);
     if (r.failure()) {
       std::cout << "SelectWorker procedure failed. " << r.toString()
                 << std::endl;
       return -1;
     }
-    std::vector<voltdb::Table> results = r.results();
-    voltdb::Row row = results[0].iterator().next();
-    DbosId selectedWorker = row.getInt64(0);
+    DbosId selectedWorker = VoltdbResultDecoder::getScalarInt64(r);
     if (selectedWorker != -1) { return selectedWorker; }
   }
   return -1;
@@ -114,12 +92,13 @@ DbosStatus PartitionedLocalFIFOScheduler::setup() {
   // Clean up data from previous run.
   truncateWorkerTable();
   truncateTaskTable();
-  DbosStatus ret;
+  BulkLoader loader(client_, workerPartitions_);
   for (int i = 0; i < numWorkers_; ++i) {
-    ret = insertWorker(i, workerCapacity_);
-    if (!ret) { return false; }
+    if (!loader.addWorker(i, workerCapacity_, i % workerPartitions_)) {
+      return false;
+    }
   }
-  return true;
+  return loader.finish();
 }
 
 DbosStatus PartitionedLocalFIFOScheduler::teardown() {
@@ -138,15 +117,16 @@ DbosStatus PartitionedLocalFIFOScheduler::schedule(Task* task) {
 
 DbosStatus PartitionedLocalFIFOScheduler::asyncSchedule(
     boost::shared_ptr<voltdb::ProcedureCallback> callback) {
-  std::vector<voltdb::Parameter> parameterTypes(2);
+  std::vector<voltdb::Parameter> parameterTypes(3);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
   int taskID = taskindex.fetch_add(1);
   int activePartitions = std::min(workerPartitions_, numWorkers_);
   int partitionNum = rand() % activePartitions;
   voltdb::Procedure procedure("SelectOrderedWorker", parameterTypes);
   voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(partitionNum).addInt32(taskID);
+  params->addInt32(partitionNum).addInt32(taskID).addInt8(pushWakeup_);
   client_->invoke(procedure, callback);
   // TODO: what if it cannot find a worker? The callback can retry?
 
@@ -29,9 +29,6 @@ public:
   // Truncate the worker table;
   void truncateTaskTable();
 
-  // Insert a worker into the worker table.
-  DbosStatus insertWorker(DbosId workerID, DbosId capacity);
-
   // Select a worker for a task and update worker capacity.
   // Return the selected worker id.
   DbosId selectWorker(DbosId taskID);
@@ -11,6 +11,7 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BulkLoader.h"
 #include "PartitionedScanTask.h"
 
 #define SUCCESS 0
@@ -26,26 +27,6 @@ void PartitionedScanTask::truncateTaskTable() {
   }
 }
 
-DbosStatus PartitionedScanTask::insertTask(DbosId taskID) {
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-
-  voltdb::Procedure procedure("InsertTask", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  DbosId workerID = taskID % numWorkers_;  // assign a worker to the task.
-  params->addInt32(taskID).addInt32(workerID).addInt32(1).addInt32(workerID %
-                                                                   partitions_);
-  voltdb::InvocationResponse r = client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "InsertTask procedure failed. " << r.toString();
-    return false;
-  }
-  return true;
-}
-
 DbosId PartitionedScanTask::selectMostTaskWorker() {
   std::vector<voltdb::Parameter> parameterTypes(1);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
@@ -69,9 +50,7 @@ DbosId PartitionedScanTask::selectMostTaskWorker() {
                   << r.toString() << std::endl;
         return false;
       }
-      std::vector<voltdb::Table> results = r.results();
-      voltdb::Row row = results[0].iterator().next();
-      int workerId = row.getInt64(0);
+      int workerId = VoltdbResultDecoder::getScalarInt64(r);
       if (workerId >= 0) {
         return workerId;
       } else {
@@ -90,9 +69,7 @@ DbosId PartitionedScanTask::selectMostTaskWorker() {
               << std::endl;
     return false;
   }
-  std::vector<voltdb::Table> results = r.results();
-  voltdb::Row row = results[0].iterator().next();
-  int workerId = row.getInt64(0);
+  int workerId = VoltdbResultDecoder::getScalarInt64(r);
   if (workerId >= 0) { return workerId; }
 
   return NOWORKER;
@@ -101,13 +78,15 @@ DbosId PartitionedScanTask::selectMostTaskWorker() {
 DbosStatus PartitionedScanTask::setup() {
   // Clean up data from previous run.
   truncateTaskTable();
-  DbosStatus ret;
   std::cout << "Insert tasks" << std::endl;
+  BulkLoader loader(client_, partitions_);
   for (int i = 0; i < numTasks_; ++i) {
-    ret = insertTask(i);
-    if (!ret) { return false; }
+    DbosId workerID = i % numWorkers_;  // assign a worker to the task.
+    if (!loader.addTask(i, workerID, 1, workerID % partitions_)) {
+      return false;
+    }
   }
-  return true;
+  return loader.finish();
 }
 
 DbosStatus PartitionedScanTask::teardown() {
@@ -26,9 +26,6 @@ public:
   // Truncate the task table;
   void truncateTaskTable();
 
-  // Insert a task into the task table.
-  DbosStatus insertTask(DbosId taskID);
-
   // Select a worker with most tasks.
   DbosId selectMostTaskWorker();
 
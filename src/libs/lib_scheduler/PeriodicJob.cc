@@ -0,0 +1,44 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <chrono>
+#include "voltdb-client-cpp/include/Client.h"
+
+#include "PeriodicJob.h"
+#include "VoltdbSchedulerUtil.h"
+
+void PeriodicJob::start() {
+  if (running_.exchange(true)) { return; }
+  thread_ = new std::thread(&PeriodicJob::run, this);
+}
+
+void PeriodicJob::stop() {
+  {
+    std::unique_lock<std::mutex> lk(lock_);
+    if (!running_.exchange(false)) { return; }
+    cv_.notify_one();
+  }
+  thread_->join();
+  delete thread_;
+  thread_ = nullptr;
+  report();
+}
+
+void PeriodicJob::run() {
+  // Create a local VoltDB client; the scheduler's clients are not shared.
+  voltdb::Client client =
+      VoltdbSchedulerUtil::createVoltdbClient(username_, password_);
+  VoltdbSchedulerUtil::connectVoltdbClient(&client, dbAddr_);
+
+  while (running_.load()) {
+    bool backlog = false;
+    for (int pkey = 0; pkey < partitions_ && running_.load(); ++pkey) {
+      if (sweepPartition(&client, pkey)) { backlog = true; }
+    }
+    if (backlog) { continue; }
+
+    std::unique_lock<std::mutex> lk(lock_);
+    cv_.wait_for(lk, std::chrono::milliseconds(intervalMsec_),
+                 [this] { return !running_.load(); });
+  }
+}
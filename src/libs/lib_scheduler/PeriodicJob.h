@@ -0,0 +1,63 @@
+// This file contains the base of the background jobs that sweep all
+// partitions periodically.
+#ifndef DBOS_PERIODIC_JOB_H
+#define DBOS_PERIODIC_JOB_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "DbosDefs.h"
+#include "voltdb-client-cpp/include/Client.h"
+
+// The job thread uses its own VoltDB client and calls sweepPartition() on
+// each partition in turn. If any partition reports a backlog, the next sweep
+// starts right away; otherwise the thread sleeps intervalMsec between sweeps.
+// Subclasses must call stop() in their destructor, while their state is still
+// alive.
+class PeriodicJob {
+public:
+  PeriodicJob(const std::string& dbAddr, const std::string& username,
+              const std::string& password, int partitions, int intervalMsec)
+      : dbAddr_(dbAddr),
+        username_(username),
+        password_(password),
+        partitions_(partitions),
+        intervalMsec_(intervalMsec),
+        running_(false),
+        thread_(nullptr) {}
+
+  virtual ~PeriodicJob() {}
+
+  // Start the job thread.
+  void start();
+
+  // Signal the job thread to stop, wait for it and print the report.
+  void stop();
+
+protected:
+  // Do one batch of work on a partition. Return true if it left work behind.
+  virtual bool sweepPartition(voltdb::Client* client, int pkey) = 0;
+
+  // Print what the job did, once it stopped.
+  virtual void report() = 0;
+
+private:
+  // Job thread main loop.
+  void run();
+
+  std::string dbAddr_;
+  std::string username_;
+  std::string password_;
+  int partitions_;
+  int intervalMsec_;
+
+  std::atomic<bool> running_;
+  std::thread* thread_;
+  std::mutex lock_;             // protects sleeping on cv_
+  std::condition_variable cv_;  // wakes the job up on stop()
+};
+
+#endif  // #ifndef DBOS_PERIODIC_JOB_H
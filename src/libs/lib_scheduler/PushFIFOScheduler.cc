@@ -48,9 +48,7 @@ DbosStatus PushFIFOScheduler::selectTaskWorker(DbosId taskID) {
                 << std::endl;
       return false;
     }
-    std::vector<voltdb::Table> results = r.results();
-    voltdb::Row row = results[0].iterator().next();
-    int status = row.getInt64(0);
+    int status = VoltdbResultDecoder::getScalarInt64(r);
     if (status == SUCCESS) {
       return true;
     } else if (status == NOWORKER) {  // implementing basic functionality first
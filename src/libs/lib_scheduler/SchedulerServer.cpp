@@ -1,4 +1,5 @@
 #include "SchedulerServer.h"
+#include "TaskProtobuf.h"
 
 namespace dbos_scheduler {
 
@@ -13,6 +13,7 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BulkLoader.h"
 #include "SinglePartitionedFIFOTaskScheduler.h"
 
 #define SUCCESS 0
@@ -42,32 +43,14 @@ void SinglePartitionedFIFOTaskScheduler::truncateTaskTable() {
   }
 }
 
-DbosStatus SinglePartitionedFIFOTaskScheduler::insertWorker(DbosId workerID,
-                                                            int32_t capacity) {
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
-
-  voltdb::Procedure procedure("InsertWorker", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(workerID)
-      .addInt32(capacity)
-      .addInt32(workerID % partitions_)
-      .addString("");
-  voltdb::InvocationResponse r = client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "InsertWorker procedure failed. " << r.toString();
-    return false;
-  }
-  return true;
-}
-
-DbosStatus SinglePartitionedFIFOTaskScheduler::selectTaskWorker(DbosId taskID) {
-  std::vector<voltdb::Parameter> parameterTypes(2);
+DbosStatus SinglePartitionedFIFOTaskScheduler::selectTaskWorker(
+    DbosId taskID, const char* payload, size_t payloadSize, int taskType) {
+  std::vector<voltdb::Parameter> parameterTypes(5);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[4] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
   // Actual num partitions.
   int activePartitions = std::min(partitions_, numWorkers_);
   int pkey = rand() % activePartitions;
@@ -79,16 +62,17 @@ DbosStatus SinglePartitionedFIFOTaskScheduler::selectTaskWorker(DbosId taskID) {
       voltdb::Procedure procedure("SelectSinglePartitionedTaskWorker",
                                   parameterTypes);
       voltdb::ParameterSet* params = procedure.params();
-      params->addInt32(pkey).addInt32(taskID);
+      // A null payload is sent as NULL.
+      params->addInt32(pkey).addInt32(taskID).addBytes(
+          payloadSize, (const uint8_t*)payload);
+      params->addInt32(taskType).addInt8(pushWakeup_);
       voltdb::InvocationResponse r = client_->invoke(procedure);
       if (r.failure()) {
         std::cout << "SelectSinglePartitionedTaskWorker procedure failed. "
                   << r.toString() << std::endl;
         return false;
       }
-      std::vector<voltdb::Table> results = r.results();
-      voltdb::Row row = results[0].iterator().next();
-      int status = row.getInt64(0);
+      int status = VoltdbResultDecoder::getScalarInt64(r);
       if (status == SUCCESS) {
         return true;
       } else if (status ==
@@ -115,16 +99,14 @@ DbosStatus SinglePartitionedFIFOTaskScheduler::setup() {
   // Clean up data from previous run.
   truncateWorkerTable();
   truncateTaskTable();
-  DbosStatus ret;
-  std::cout << "Foo" << std::endl;
+  BulkLoader loader(client_, partitions_);
   for (int i = 0; i < numWorkers_; ++i) {
-    ret = insertWorker(i, workerCapacity_);
-    if (!ret) {
+    if (!loader.addWorker(i, workerCapacity_, i % partitions_)) {
       std::cout << "unable to add worker " << i << std::endl;
       return false;
     }
   }
-  return true;
+  return loader.finish();
 }
 
 DbosStatus SinglePartitionedFIFOTaskScheduler::teardown() {
@@ -136,7 +118,8 @@ DbosStatus SinglePartitionedFIFOTaskScheduler::teardown() {
 
 DbosStatus SinglePartitionedFIFOTaskScheduler::schedule(Task* task) {
   int taskId = taskindex.fetch_add(1);
-  DbosStatus status = selectTaskWorker(taskId);
+  DbosStatus status =
+      selectTaskWorker(taskId, task->payload, task->payloadSize, task->type);
   assert(status == true);
   return true;
 }
@@ -144,14 +127,18 @@ DbosStatus SinglePartitionedFIFOTaskScheduler::schedule(Task* task) {
 DbosStatus SinglePartitionedFIFOTaskScheduler::asyncSchedule(
     boost::shared_ptr<voltdb::ProcedureCallback> callback) {
     int taskID = taskindex.fetch_add(1);
-    std::vector<voltdb::Parameter> parameterTypes(2);
+    std::vector<voltdb::Parameter> parameterTypes(5);
     parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
     parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+    parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY);
+    parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+    parameterTypes[4] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
     int activePartitions = std::min(partitions_, numWorkers_);
     int partitionNum = rand() % activePartitions;
     voltdb::Procedure procedure("SelectSinglePartitionedTaskWorker", parameterTypes);
     voltdb::ParameterSet* params = procedure.params();
-    params->addInt32(partitionNum).addInt32(taskID);
+    params->addInt32(partitionNum).addInt32(taskID).addNull().addInt32(0).addInt8(
+        pushWakeup_);
     client_->invoke(procedure, callback);
     // TODO: what if it cannot find a worker? The callback can retry?
 
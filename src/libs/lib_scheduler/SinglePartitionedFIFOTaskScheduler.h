@@ -31,11 +31,11 @@ public:
   // Truncate the worker table;
   void truncateTaskTable();
 
-  // Insert a worker into the worker table.
-  DbosStatus insertWorker(DbosId workerID, DbosId capacity);
-
   // Select a worker for a task and update worker capacity and task workerid.
-  DbosStatus selectTaskWorker(DbosId taskID);
+  // The payload, if any, and the task type are stored with the task; the
+  // payload is not copied before it goes into the request.
+  DbosStatus selectTaskWorker(DbosId taskID, const char* payload = nullptr,
+                              size_t payloadSize = 0, int taskType = 0);
 
   // Setup the database.
   DbosStatus setup();
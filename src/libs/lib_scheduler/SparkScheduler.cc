@@ -13,6 +13,7 @@
 #include "voltdb-client-cpp/include/WireType.h"
 
 #include "SparkScheduler.h"
+#include "TaskProtobuf.h"
 
 void SparkScheduler::truncateWorkerTable() {
   std::vector<voltdb::Parameter> parameterTypes(0);
@@ -28,8 +29,9 @@ std::vector<WorkerManager*> SparkScheduler::workers_;
 
 DbosStatus SparkScheduler::insertWorker(DbosId workerID, int32_t capacity,
                                         std::vector<int32_t> workerData) {
-  WorkerManager* worker = new MockGRPCWorker(
-      client_, workerID, workerPartitions_, capacity, workerData);
+  WorkerManager* worker =
+      new MockGRPCWorker(client_, workerID, workerPartitions_, capacity,
+                         workerData, workerOptions_);
   SparkScheduler::workers_.push_back(worker);
   return worker->startServing();
 }
@@ -47,13 +49,10 @@ DbosId SparkScheduler::selectWorker(DbosId targetData) {
   voltdb::ParameterSet* pparams = procedure.params();
   pparams->addInt32(targetData);
   voltdb::InvocationResponse pr = client_->invoke(procedure);
-  std::vector<voltdb::Table> presults = pr.results();
-  voltdb::TableIterator iterator = presults[0].iterator();
   std::vector<int> targetPartitions;
-  while (iterator.hasNext()) {
-    voltdb::Row prow = iterator.next();
-    DbosId partitionNum = prow.getInt64(0);
-    targetPartitions.push_back(partitionNum);
+  decoder_.decode(pr);
+  for (int32_t i = 0; i < decoder_.rowCount(); ++i) {
+    targetPartitions.push_back(decoder_.getInt64(i, 0));
   }
   // Poll until a slot is found, randomly selecting partitions.
   while (true) {  // TODO:  Add timeout.
@@ -68,9 +67,7 @@ DbosId SparkScheduler::selectWorker(DbosId targetData) {
                 << std::endl;
       return -1;
     }
-    std::vector<voltdb::Table> results = r.results();
-    voltdb::Row row = results[0].iterator().next();
-    DbosId selectedWorker = row.getInt64(0);
+    DbosId selectedWorker = VoltdbResultDecoder::getScalarInt64(r);
     if (selectedWorker != -1) { return selectedWorker; }
   }
   return -1;
@@ -88,8 +85,32 @@ std::shared_ptr<Channel> SparkScheduler::addrToChannel(std::string workerAddr) {
   }
 }
 
-DbosStatus SparkScheduler::assignTaskToWorker(DbosId taskId, DbosId workerId,
-                                              Task* task) {
+DbosStatus SparkScheduler::assignTaskToWorker(TaskData* taskData,
+                                              DbosId workerId) {
+  DbosId taskId = taskData->taskID;
+  Task* task = taskData->taskStruct;
+  if (streamDispatch_) {
+    WorkerStream* stream;
+    while (true) {
+      stream = workerStream(workerId);
+      std::lock_guard<std::mutex> lk(stream->lock);
+      // If it broke since workerStream() looked, the next call replaces it.
+      if (stream->broken) { continue; }
+      stream->outstanding[taskId] = taskData;
+      dbos_scheduler::TaskAssignment* assignment = stream->pending.add_tasks();
+      assignment->set_taskid(taskId);
+      assignment->set_targetdata(task->targetData);
+      assignment->set_exectime(task->execTime);
+      assignment->set_type(task->type);
+      if (task->payloadSize > 0) {
+        assignment->set_payload(task->payload, task->payloadSize);
+      }
+      break;
+    }
+    stream->cv.notify_one();
+    return true;
+  }
+
   // TODO:  Actually lookup the address somehow.
   const std::string& port = std::to_string(8000 + workerId);
   std::string workerAddr = "localhost:" + port;
@@ -100,14 +121,13 @@ DbosStatus SparkScheduler::assignTaskToWorker(DbosId taskId, DbosId workerId,
       dbos_scheduler::Frontend::NewStub(channel);
 
   // Submit task
-  dbos_scheduler::SubmitTaskRequest st_request;
-  st_request.set_targetdata(task->targetData);
-  st_request.set_exectime(task->execTime);
+  dbos_scheduler::SubmitTaskRequest st_request = taskToProtobuf(task);
 
   // Call object to store rpc data
   AsyncClientCall* call = new AsyncClientCall;
   call->workerID = workerId;
   call->taskID = taskId;
+  call->taskData = taskData;
   // stub_->AsyncSubmitTask() performs the RPC call, returning an instance to
   // store in "call". Because we are using the asynchronous API, we need to
   // hold on to the "call" instance in order to get updates on the ongoing RPC.
@@ -121,42 +141,198 @@ DbosStatus SparkScheduler::assignTaskToWorker(DbosId taskId, DbosId workerId,
   return true;
 }
 
+void SparkScheduler::resendTask(TaskData* taskData) {
+  std::lock_guard<std::mutex> lk(taskProcessMutex);
+  taskQueue.push(taskData);
+  taskProcessCV.notify_one();
+}
+
+SparkScheduler::WorkerStream* SparkScheduler::workerStream(DbosId workerId) {
+  auto got = streams_.find(workerId);
+  if (got != streams_.end()) {
+    WorkerStream* stream = got->second.get();
+    {
+      std::lock_guard<std::mutex> lk(stream->lock);
+      if (!stream->broken) { return stream; }
+    }
+    // Its threads exit on their own; it is finished once its reader returned.
+    retiredStreams_.push_back(std::move(got->second));
+    streams_.erase(got);
+    for (auto it = retiredStreams_.begin(); it != retiredStreams_.end();) {
+      if ((*it)->done.load()) {
+        finishStream(it->get());
+        it = retiredStreams_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // TODO:  Actually lookup the address somehow.
+  std::string workerAddr = "localhost:" + std::to_string(8000 + workerId);
+  std::unique_ptr<dbos_scheduler::Schedule::Stub> stub =
+      dbos_scheduler::Schedule::NewStub(addrToChannel(workerAddr));
+  WorkerStream* stream = new WorkerStream();
+  stream->workerId = workerId;
+  stream->finisher.reset(new TaskFinisher(
+      workerId, workerId % workerPartitions_, dbAddr_, username_, password_,
+      kFinishBatch, kFinishDelayUsec));
+  stream->finisher->start();
+  stream->stream = stub->Dispatch(&stream->context);
+  stream->writer =
+      new std::thread(&SparkScheduler::writeAssignments, this, stream);
+  stream->reader = new std::thread(&SparkScheduler::readReports, this, stream);
+  streams_.emplace(workerId, std::unique_ptr<WorkerStream>(stream));
+  return stream;
+}
+
+void SparkScheduler::writeAssignments(WorkerStream* stream) {
+  dbos_scheduler::DispatchBatch batch;
+  std::unique_lock<std::mutex> lk(stream->lock);
+  while (true) {
+    stream->cv.wait(lk, [stream] {
+      return stream->closed || stream->pending.tasks_size() > 0;
+    });
+    if (stream->pending.tasks_size() == 0) { break; }
+    // Swap the batch out so assignments can keep queueing while we write.
+    batch.Swap(&stream->pending);
+    lk.unlock();
+    bool ok = stream->stream->Write(batch);
+    batch.Clear();
+    lk.lock();
+    if (!ok) {
+      std::cout << "Dispatch stream to worker " << stream->workerId
+                << " broke." << std::endl;
+      break;
+    }
+  }
+  lk.unlock();
+  stream->stream->WritesDone();
+}
+
+void SparkScheduler::readReports(WorkerStream* stream) {
+  static const std::string kNoResult;
+  dbos_scheduler::WorkerReport report;
+  while (stream->stream->Read(&report)) {
+    {
+      std::lock_guard<std::mutex> lk(stream->lock);
+      for (int32_t taskId : report.completedtaskids()) {
+        stream->outstanding.erase(taskId);
+      }
+    }
+    // Notify the clients that the tasks are complete.
+    {
+      std::lock_guard<std::mutex> lk(taskCompletionMutex);
+      for (int32_t taskId : report.completedtaskids()) {
+        taskCompletionSet.insert(taskId);
+      }
+    }
+    taskCompletionCV.notify_all();
+    // The report carries one result per task, or none at all.
+    for (int i = 0; i < report.completedtaskids_size(); ++i) {
+      stream->finisher->add(report.completedtaskids(i),
+                            report.results_size() > i ? report.results(i)
+                                                      : kNoResult);
+    }
+  }
+
+  // The worker ends the stream once it reported all tasks, so anything still
+  // outstanding was lost with the worker. Stop the writer, and send the tasks
+  // again; they no longer go to this stream.
+  std::vector<TaskData*> lost;
+  {
+    std::lock_guard<std::mutex> lk(stream->lock);
+    for (auto& it : stream->outstanding) { lost.push_back(it.second); }
+    stream->outstanding.clear();
+    stream->closed = true;
+    stream->broken = true;
+  }
+  stream->cv.notify_one();
+  if (!lost.empty()) {
+    std::cout << "Dispatch stream to worker " << stream->workerId
+              << " ended with " << lost.size() << " tasks outstanding, "
+              << "sending them again." << std::endl;
+  }
+  for (TaskData* taskData : lost) { resendTask(taskData); }
+  stream->done = true;
+}
+
+void SparkScheduler::finishStream(WorkerStream* stream) {
+  {
+    std::lock_guard<std::mutex> lk(stream->lock);
+    stream->closed = true;
+  }
+  stream->cv.notify_one();
+  stream->writer->join();
+  // The worker ends the stream once it reported all tasks.
+  stream->reader->join();
+  Status status = stream->stream->Finish();
+  if (!status.ok()) {
+    std::cout << "Dispatch stream to worker " << stream->workerId
+              << " failed. " << status.error_message() << std::endl;
+  }
+  delete stream->writer;
+  delete stream->reader;
+  // Mark the reported tasks complete.
+  stream->finisher->stop();
+}
+
+void SparkScheduler::closeStreams() {
+  for (auto& it : streams_) { finishStream(it.second.get()); }
+  streams_.clear();
+  for (auto& stream : retiredStreams_) { finishStream(stream.get()); }
+  retiredStreams_.clear();
+}
+
 void SparkScheduler::finishRequests() {
   void* got_tag;
   bool ok = false;
-  // TODO:  Don't hardcode.
   voltdb::Client client =
-      VoltdbSchedulerUtil::createVoltdbClient("testuser", "testpassword");
-  client.createConnection("localhost");
+      VoltdbSchedulerUtil::createVoltdbClient(username_, password_);
+  VoltdbSchedulerUtil::connectVoltdbClient(&client, dbAddr_);
   // Block until the next result is available in the completion queue "cq".
   while (cq_.Next(&got_tag, &ok)) {
     // The tag in this example is the memory location of the call object
     AsyncClientCall* call = static_cast<AsyncClientCall*>(got_tag);
     assert(ok);
-    assert(call->status.ok());
-    finishTask(client, call->taskID, call->workerID);
+    if (!call->status.ok()) {
+      // The worker is gone or failed the task; send it to another worker.
+      std::cout << "SubmitTask to worker " << call->workerID << " failed. "
+                << call->status.error_message() << std::endl;
+      resendTask(call->taskData);
+      delete call;
+      continue;
+    }
+    finishTask(client, call->taskID, call->workerID, call->reply.result());
     delete call;
   }
   client.close();
 }
 
 DbosStatus SparkScheduler::finishTask(voltdb::Client client, DbosId taskId,
-                                      DbosId workerId) {
+                                      DbosId workerId,
+                                      const std::string& result) {
   // Notify the client that the task is complete.
   taskCompletionMutex.lock();
   taskCompletionSet.insert(taskId);
   taskCompletionCV.notify_all();
   taskCompletionMutex.unlock();
   // Update the task's entries in the database.
-  std::vector<voltdb::Parameter> parameterTypes(3);
+  std::vector<voltdb::Parameter> parameterTypes(4);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY);
 
   voltdb::Procedure procedure("FinishWorkerTask", parameterTypes);
   voltdb::ParameterSet* params = procedure.params();
   params->addInt32(workerId).addInt32(taskId).addInt32(workerId %
                                                        workerPartitions_);
+  if (result.empty()) {
+    params->addNull();
+  } else {
+    params->addBytes(result.size(), (const uint8_t*)result.data());
+  }
   voltdb::InvocationResponse r = client.invoke(procedure);
   if (r.failure()) {
     std::cout << "finishTask procedure failed. " << r.toString();
@@ -165,6 +341,18 @@ DbosStatus SparkScheduler::finishTask(voltdb::Client client, DbosId taskId,
   return true;
 }
 
+void SparkScheduler::stopTaskQueue() {
+  {
+    std::lock_guard<std::mutex> lk(taskProcessMutex);
+    if (!runTaskQueueThread) { return; }
+    runTaskQueueThread = false;
+    taskProcessCV.notify_one();
+  }
+  processTaskQueueThread_->join();
+  delete processTaskQueueThread_;
+  processTaskQueueThread_ = NULL;
+}
+
 void SparkScheduler::processTaskQueue() {
   std::unique_lock<std::mutex> lock(taskProcessMutex);
   while (runTaskQueueThread) {
@@ -173,7 +361,7 @@ void SparkScheduler::processTaskQueue() {
       TaskData* taskData = taskQueue.front();
       DbosId workerId = selectWorker(taskData->taskStruct->targetData);
       assert(workerId >= 0);
-      assignTaskToWorker(taskData->taskID, workerId, taskData->taskStruct);
+      assignTaskToWorker(taskData, workerId);
       taskQueue.pop();
     }
   }
@@ -193,6 +381,10 @@ DbosStatus SparkScheduler::setup() {
 }
 
 DbosStatus SparkScheduler::teardown() {
+  // Nothing is assigned any more, so the streams send what is left and end
+  // once the workers reported all tasks; only then may the workers stop.
+  stopTaskQueue();
+  closeStreams();
   // Clean up data from previous run.
   truncateWorkerTable();
   for (WorkerManager* worker : SparkScheduler::workers_) {
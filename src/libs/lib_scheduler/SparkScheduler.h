@@ -3,14 +3,20 @@
 #define SPARK_SCHEDULER_H
 
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "VoltdbSchedulerUtil.h"
 #include "voltdb-client-cpp/include/Client.h"
 
 #include "MockGRPCWorker.h"
+#include "TaskFinisher.h"
 #include "WorkerManager.h"
+#include "scheduler.grpc.pb.h"
 
 using grpc::CompletionQueue;
 using grpc::ClientAsyncResponseReader;
@@ -21,12 +27,28 @@ using grpc::ClientAsyncResponseReader;
 // (2) pass the pointer to construct SparkScheduler.
 class SparkScheduler : public VoltdbSchedulerUtil {
 public:
+  // setup() starts the workers with workerOptions. If streamDispatch is
+  // true, tasks go to each worker over one long-lived Dispatch stream instead
+  // of one SubmitTask call per task. A task whose call fails, or that is still
+  // outstanding when its Dispatch stream breaks, goes back to the queue and is
+  // sent to the worker selectWorker() picks then; once the LivenessDetector
+  // reaps a dead worker, that is a live one. The threads that finish tasks
+  // connect to dbAddr with username and password.
   SparkScheduler(voltdb::Client* client, std::string dbAddr,
-                 int workerPartitions, int workerCapacity, int numWorkers)
+                 const std::string& username, const std::string& password,
+                 int workerPartitions, int workerCapacity, int numWorkers,
+                 const MockGRPCWorker::ServerOptions& workerOptions =
+                     MockGRPCWorker::ServerOptions(),
+                 bool streamDispatch = false)
       : VoltdbSchedulerUtil(client, dbAddr),
         workerPartitions_(workerPartitions),
         workerCapacity_(workerCapacity),
-        numWorkers_(numWorkers) {
+        numWorkers_(numWorkers),
+        workerOptions_(workerOptions),
+        dbAddr_(dbAddr),
+        username_(username),
+        password_(password),
+        streamDispatch_(streamDispatch) {
     // Create the thread that processes the queue.
     processTaskQueueThread_ =
         new std::thread(&SparkScheduler::processTaskQueue, this);
@@ -37,7 +59,8 @@ public:
   // Setup the database.
   DbosStatus setup();
 
-  // Tear down the database after benchmarking.
+  // Close the Dispatch streams, stop the workers and tear down the database
+  // after benchmarking.
   DbosStatus teardown();
 
   // Create and schedule a task, return when task complete.
@@ -46,15 +69,17 @@ public:
   // Destructor
   ~SparkScheduler() {
     cq_.Shutdown();
-    runTaskQueueThread = false;
-    taskProcessMutex.lock();
-    taskProcessCV.notify_one();
-    taskProcessMutex.unlock();
-    processTaskQueueThread_->join();
+    stopTaskQueue();
     finishRequestsThread_->join();
+    closeStreams();
   }
 
 private:
+  struct TaskData {
+    DbosId taskID;
+    Task* taskStruct;
+  };
+
   struct AsyncClientCall {
     // Container for the data we expect from the server.
     dbos_scheduler::SubmitTaskResponse reply;
@@ -67,14 +92,36 @@ private:
     int workerID;
     // Task ID.
     int taskID;
+    // Task to send again if the call fails.
+    TaskData* taskData;
     std::unique_ptr<
         ClientAsyncResponseReader<dbos_scheduler::SubmitTaskResponse>>
         response_reader;
   };
 
-  struct TaskData {
-    DbosId taskID;
-    Task* taskStruct;
+  // Scheduler side of the Dispatch stream to one worker. Assignments queue up
+  // in pending, and a writer thread sends everything that queued up during its
+  // previous write as one DispatchBatch. A reader thread notifies the clients
+  // of the tasks the worker reports back and hands them to the finisher, which
+  // marks them complete in batches. If the stream breaks, the reader sends the
+  // outstanding tasks again and marks the stream broken, so the next
+  // assignment opens a new one.
+  struct WorkerStream {
+    DbosId workerId;
+    ClientContext context;
+    std::unique_ptr<grpc::ClientReaderWriter<dbos_scheduler::DispatchBatch,
+                                             dbos_scheduler::WorkerReport>>
+        stream;
+    std::mutex lock;  // protects pending, outstanding, closed and broken
+    std::condition_variable cv;  // wakes the writer up
+    dbos_scheduler::DispatchBatch pending;
+    std::unordered_map<DbosId, TaskData*> outstanding;
+    bool closed = false;
+    bool broken = false;
+    std::thread* writer = nullptr;
+    std::thread* reader = nullptr;
+    std::unique_ptr<TaskFinisher> finisher;
+    std::atomic<bool> done{false};  // the reader returned
   };
 
   // Truncate the worker table;
@@ -90,10 +137,31 @@ private:
 
   // Update which worker the task is assigned to, and update worker status to
   // scheduled.
-  DbosStatus assignTaskToWorker(DbosId taskId, DbosId workerId, Task* task);
+  DbosStatus assignTaskToWorker(TaskData* taskData, DbosId workerId);
+
+  // Put a task whose worker failed back in the queue.
+  void resendTask(TaskData* taskData);
+
+  // Complete a task, updating the capacity of its worker, and store its
+  // result blob, if any.
+  DbosStatus finishTask(voltdb::Client client, DbosId taskId, DbosId workerId,
+                        const std::string& result = std::string());
+
+  // Return the Dispatch stream to a worker, opening it on first use or if the
+  // previous one broke; a broken stream is retired, and retired streams whose
+  // reader returned are finished. Only called from the processTaskQueue
+  // thread.
+  WorkerStream* workerStream(DbosId workerId);
 
-  // Complete a task, updating the capacity of its worker.
-  DbosStatus finishTask(voltdb::Client client, DbosId taskId, DbosId workerId);
+  // Writer and reader thread main loops of a Dispatch stream.
+  void writeAssignments(WorkerStream* stream);
+  void readReports(WorkerStream* stream);
+
+  // Close a stream, wait for its threads and finish it and its finisher.
+  void finishStream(WorkerStream* stream);
+
+  // Send the remaining assignments and close all Dispatch streams.
+  void closeStreams();
 
   std::shared_ptr<Channel> addrToChannel(std::string workerAddr);
   std::unordered_map<std::string, std::shared_ptr<Channel>> channelMap;
@@ -102,17 +170,32 @@ private:
   int workerPartitions_;
   int numWorkers_;
   int dataPerWorker_ = 10;
+  MockGRPCWorker::ServerOptions workerOptions_;
+  std::string dbAddr_;
+  std::string username_;
+  std::string password_;
+  bool streamDispatch_;
+  std::unordered_map<DbosId, std::unique_ptr<WorkerStream>> streams_;
+  std::vector<std::unique_ptr<WorkerStream>> retiredStreams_;
   CompletionQueue cq_;
   std::atomic_int taskIDs;
   std::thread* finishRequestsThread_ = NULL;
   std::thread* processTaskQueueThread_ = NULL;
-  bool runTaskQueueThread = true;
+  bool runTaskQueueThread = true;  // protected by taskProcessMutex
+
+  // A stream's finisher flushes at most kFinishBatch tasks per call, and a
+  // task waits at most kFinishDelayUsec for its batch.
+  static const size_t kFinishBatch = 256;
+  static const uint64_t kFinishDelayUsec = 1000;
 
   static std::vector<WorkerManager*> workers_;
 
   void finishRequests();
   void processTaskQueue();
 
+  // Stop the processTaskQueue thread and wait for it, if it still runs.
+  void stopTaskQueue();
+
   std::queue<TaskData*> taskQueue;
   std::condition_variable taskCompletionCV;
   std::mutex taskCompletionMutex;
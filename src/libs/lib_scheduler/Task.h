@@ -1,27 +1,21 @@
 #ifndef DBOS_SCHEDULER_TASK_H
 #define DBOS_SCHEDULER_TASK_H
 
-#include <grpcpp/grpcpp.h>
-
-#include "frontend.grpc.pb.h"
+#include <cstddef>
 
+// The protobuf conversions are in TaskProtobuf.h, so that executors can take
+// a Task without pulling in gRPC.
 struct Task {
+  Task()
+      : targetData(0), execTime(0), type(0), payload(nullptr), payloadSize(0) {}
+
   int targetData;
   int execTime;
+  int type;  // task function in the worker's TaskRegistry, 0 = workload
+  // A view of the task's opaque payload, not owned by the task: whoever hands
+  // the task to an executor keeps the bytes alive until it returns.
+  const char* payload;
+  size_t payloadSize;
 };
 
-static dbos_scheduler::SubmitTaskRequest taskToProtobuf(Task* task) {
-  dbos_scheduler::SubmitTaskRequest st_request;
-  st_request.set_targetdata(task->targetData);
-  st_request.set_exectime(task->execTime);
-  return st_request;
-}
-
-static Task protobufToTask(const dbos_scheduler::SubmitTaskRequest* request) {
-  Task task;
-  task.targetData = request->targetdata();
-  task.execTime = request->exectime();
-  return task;
-}
-
 #endif  // DBOS_SCHEDULER_TASK_H
@@ -0,0 +1,60 @@
+// This file contains a per-worker batcher of the tasks a scheduler finishes.
+#ifndef DBOS_TASK_FINISHER_H
+#define DBOS_TASK_FINISHER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BatchFlusher.h"
+#include "CompletionAggregator.h"
+#include "DbosDefs.h"
+#include "voltdb-client-cpp/include/Client.h"
+
+// The scheduler side of CompletionAggregator, for tasks a worker reports back
+// to the scheduler. A flusher thread with its own VoltDB client finishes them
+// with one FinishWorkerTasks call per batch, which gives back the worker
+// capacity they held. A batch is flushed when it reaches maxBatch tasks or its
+// oldest task has waited maxDelayUsec. A failed flush is retried with the
+// tasks added meanwhile and dropped after kMaxRetries failures in a row.
+// add() is thread safe.
+class TaskFinisher : public BatchFlusher<TaskCompletion> {
+public:
+  TaskFinisher(DbosId workerId, int pkey, const std::string& dbAddr,
+               const std::string& username, const std::string& password,
+               size_t maxBatch, uint64_t maxDelayUsec)
+      : BatchFlusher<TaskCompletion>(maxBatch, maxDelayUsec, false),
+        workerId_(workerId),
+        pkey_(pkey),
+        dbAddr_(dbAddr),
+        username_(username),
+        password_(password) {}
+
+  ~TaskFinisher() { stop(); }
+
+  // Record a finished task and its result, which may be empty.
+  void add(DbosId taskId, const std::string& result) {
+    BatchFlusher<TaskCompletion>::add(TaskCompletion{
+        taskId, std::vector<char>(result.begin(), result.end())});
+  }
+
+protected:
+  void setup() override;
+  bool flush(const std::vector<TaskCompletion>& batch) override;
+
+private:
+  DbosId workerId_;
+  int pkey_;
+  std::string dbAddr_;
+  std::string username_;
+  std::string password_;
+
+  // Only used by the flusher thread.
+  std::unique_ptr<voltdb::Client> client_;
+  std::unique_ptr<voltdb::Procedure> procedure_;
+  std::vector<int32_t> taskIds_;
+  std::vector<voltdb::buffer_t> resultViews_;
+};
+
+#endif  // #ifndef DBOS_TASK_FINISHER_H
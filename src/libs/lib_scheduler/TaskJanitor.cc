@@ -0,0 +1,40 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <iostream>
+#include <vector>
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+#include "TaskJanitor.h"
+#include "VoltdbResultDecoder.h"
+
+void TaskJanitor::report() {
+  std::cout << "TaskJanitor purged " << purged_.load() << " tasks\n";
+}
+
+int64_t TaskJanitor::purgePartition(voltdb::Client* client, int pkey) {
+  std::vector<voltdb::Parameter> parameterTypes(3);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  voltdb::Procedure procedure("PurgeCompletedTasks", parameterTypes);
+  voltdb::ParameterSet* params = procedure.params();
+  params->addInt32(pkey).addInt64(retentionMsec_).addInt32(batchSize_);
+  voltdb::InvocationResponse r = client->invoke(procedure);
+  if (r.failure()) {
+    std::cout << "PurgeCompletedTasks procedure failed. " << r.toString();
+    return -1;
+  }
+  return VoltdbResultDecoder::getScalarInt64(r);
+}
+
+bool TaskJanitor::sweepPartition(voltdb::Client* client, int pkey) {
+  int64_t deleted = purgePartition(client, pkey);
+  if (deleted < 0) { return false; }
+  purged_ += deleted;
+  // A full batch means there may be more to delete in this partition.
+  return deleted >= batchSize_;
+}
@@ -0,0 +1,51 @@
+// This file contains a background janitor that purges completed tasks.
+#ifndef DBOS_TASK_JANITOR_H
+#define DBOS_TASK_JANITOR_H
+
+#include <atomic>
+#include <string>
+
+#include "DbosDefs.h"
+#include "PeriodicJob.h"
+#include "voltdb-client-cpp/include/Client.h"
+
+// Completed tasks are never deleted by the task procedures, so without a
+// janitor the Task table and its indexes grow for the lifetime of the system.
+// Each sweep calls PurgeCompletedTasks on each partition. Each call deletes at
+// most batchSize tasks that completed more than retentionMsec ago, so a single
+// transaction never blocks a partition for long. A full batch counts as a
+// backlog, so the next sweep starts right away.
+class TaskJanitor : public PeriodicJob {
+public:
+  TaskJanitor(const std::string& dbAddr, const std::string& username,
+              const std::string& password, int partitions,
+              int64_t retentionMsec, int batchSize = 1000,
+              int intervalMsec = 1000)
+      : PeriodicJob(dbAddr, username, password, partitions, intervalMsec),
+        retentionMsec_(retentionMsec),
+        batchSize_(batchSize),
+        purged_(0) {}
+
+  ~TaskJanitor() { stop(); }
+
+  // Number of tasks purged so far.
+  int64_t purged() const { return purged_.load(); }
+
+protected:
+  // Purge one batch from a partition.
+  bool sweepPartition(voltdb::Client* client, int pkey) override;
+
+  void report() override;
+
+private:
+  // Purge one batch from a partition. Return the number of deleted tasks,
+  // or -1 on failure.
+  int64_t purgePartition(voltdb::Client* client, int pkey);
+
+  int64_t retentionMsec_;
+  int batchSize_;
+
+  std::atomic<int64_t> purged_;
+};
+
+#endif  // #ifndef DBOS_TASK_JANITOR_H
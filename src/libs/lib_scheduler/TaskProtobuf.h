@@ -0,0 +1,31 @@
+// This file contains the conversions between a Task and its SubmitTask
+// request.
+#ifndef DBOS_SCHEDULER_TASK_PROTOBUF_H
+#define DBOS_SCHEDULER_TASK_PROTOBUF_H
+
+#include "Task.h"
+#include "frontend.pb.h"
+
+inline dbos_scheduler::SubmitTaskRequest taskToProtobuf(const Task* task) {
+  dbos_scheduler::SubmitTaskRequest st_request;
+  st_request.set_targetdata(task->targetData);
+  st_request.set_exectime(task->execTime);
+  st_request.set_type(task->type);
+  if (task->payloadSize > 0) {
+    st_request.set_payload(task->payload, task->payloadSize);
+  }
+  return st_request;
+}
+
+// The task views the payload of the request, so the request has to outlive it.
+inline Task protobufToTask(const dbos_scheduler::SubmitTaskRequest* request) {
+  Task task;
+  task.targetData = request->targetdata();
+  task.execTime = request->exectime();
+  task.type = request->type();
+  task.payload = request->payload().data();
+  task.payloadSize = request->payload().size();
+  return task;
+}
+
+#endif  // DBOS_SCHEDULER_TASK_PROTOBUF_H
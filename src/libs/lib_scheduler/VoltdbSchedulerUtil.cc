@@ -33,7 +33,12 @@ voltdb::Client VoltdbSchedulerUtil::createVoltdbClient(std::string username,
 
 VoltdbSchedulerUtil::VoltdbSchedulerUtil(voltdb::Client* client,
                                          std::string& dbAddr)
-    : client_(client) {
+    : client_(client), pushWakeup_(true) {
+  connectVoltdbClient(client_, dbAddr);
+}
+
+void VoltdbSchedulerUtil::connectVoltdbClient(voltdb::Client* client,
+                                              const std::string& dbAddr) {
   // Comma-separated list of hostnames or IPs.
   std::istringstream addrStream(dbAddr);
   std::string host;
@@ -46,7 +51,7 @@ VoltdbSchedulerUtil::VoltdbSchedulerUtil(voltdb::Client* client,
 
   while (std::getline(addrStream, host, delim)) {
     try {
-      client_->createConnection(host);
+      client->createConnection(host);
     } catch (std::exception& e) {
       std::cerr << "An exception occured while connecting to VoltDB " << host
                 << std::endl;
@@ -78,3 +83,35 @@ VoltdbSchedulerUtil::VoltdbSchedulerUtil(voltdb::Client* client,
   std::cout << "=== Connected to VoltDB at " << host << " ===\n";
   */
 }
+
+std::string VoltdbSchedulerUtil::hostsForClient(const std::string& dbAddr,
+                                                int index, int count) {
+  std::istringstream addrStream(dbAddr);
+  std::vector<std::string> hosts;
+  std::string host;
+  while (std::getline(addrStream, host, ',')) { hosts.push_back(host); }
+  if (hosts.empty() || count <= 0) { return dbAddr; }
+
+  int numHosts = hosts.size();
+  if (count >= numHosts) { return hosts[index % numHosts]; }
+  std::string subset;
+  for (int h = index % count; h < numHosts; h += count) {
+    if (!subset.empty()) { subset += ","; }
+    subset += hosts[h];
+  }
+  return subset;
+}
+
+DbosStatus VoltdbSchedulerUtil::warmup(int rounds) {
+  // @Ping is a no-op system procedure, so it leaves the tables untouched.
+  std::vector<voltdb::Parameter> parameterTypes;
+  voltdb::Procedure procedure("@Ping", parameterTypes);
+  for (int i = 0; i < rounds; ++i) {
+    voltdb::InvocationResponse r = client_->invoke(procedure);
+    if (r.failure()) {
+      std::cout << "@Ping procedure failed. " << r.toString();
+      return false;
+    }
+  }
+  return true;
+}
@@ -9,6 +9,7 @@
 
 #include "DbosDefs.h"
 #include "Task.h"
+#include "VoltdbResultDecoder.h"
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ProcedureCallback.hpp"
 
@@ -69,6 +70,17 @@ public:
   // Tear down the database after benchmarking.
   virtual DbosStatus teardown() = 0;
 
+  // Issue <rounds> calls before measuring so that connections, the client
+  // event loop and the server side of the procedures are warm. The default
+  // only pings the DB; override it to prime the procedures schedule() uses
+  // when doing so does not consume benchmark state.
+  virtual DbosStatus warmup(int rounds);
+
+  // Whether the procedures that queue a task look its worker up in
+  // IdleWorker to push a wakeup. On by default; turn it off when no worker
+  // parks (no worker polls with a wakeup url) to save the lookup.
+  void setPushWakeup(bool pushWakeup) { pushWakeup_ = pushWakeup; }
+
   // Virutal destructor so that derived classes can be freed.
   virtual ~VoltdbSchedulerUtil() = 0;
 
@@ -76,8 +88,22 @@ public:
   static voltdb::Client createVoltdbClient(std::string username,
                                            std::string password);
 
+  // Connect a client to each host of the comma-separated dbAddr.
+  static void connectVoltdbClient(voltdb::Client* client,
+                                  const std::string& dbAddr);
+
+  // The hosts of the comma-separated dbAddr that client <index> of <count>
+  // connects to when parallel clients split the hosts between them: with at
+  // least as many clients as hosts each client takes one host, round-robin;
+  // otherwise client i takes every host h with h % count == i. Each client
+  // then reaches the cluster through fewer hosts, so callers opt in.
+  static std::string hostsForClient(const std::string& dbAddr, int index,
+                                    int count);
+
 protected:
   voltdb::Client* client_;
+  VoltdbResultDecoder decoder_;  // Reused to decode multi-row results.
+  bool pushWakeup_;
 };
 
 #endif  // #ifndef DBOS_VOLTDB_SCHEDULER_UTIL_H
@@ -0,0 +1,37 @@
+// This file contains a reusable thread barrier (std::barrier is C++20).
+#ifndef DBOS_BARRIER_H
+#define DBOS_BARRIER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Block until <count> threads have called wait(). Benchmarks use it to start
+// the measurement clock only after every thread finished its setup.
+class Barrier {
+public:
+  explicit Barrier(size_t count)
+      : count_(count), waiting_(0), generation_(0) {}
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t generation = generation_;
+    if (++waiting_ == count_) {
+      // Last arrival releases everyone and resets for the next round.
+      waiting_ = 0;
+      generation_++;
+      cv_.notify_all();
+      return;
+    }
+    cv_.wait(lock, [this, generation] { return generation != generation_; });
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  const size_t count_;
+  size_t waiting_;
+  size_t generation_;
+};
+
+#endif  // #ifndef DBOS_BARRIER_H
@@ -0,0 +1,156 @@
+// This file contains the base of the threads that store items in batches.
+#ifndef DBOS_BATCH_FLUSHER_H
+#define DBOS_BATCH_FLUSHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtil.h"
+
+// Threads add() items and move on; a flusher thread hands them to flush() in
+// batches. A batch is flushed when it reaches maxBatch items or its oldest
+// item has waited maxDelayUsec, whichever comes first, and whatever is left
+// on stop(). A failed flush is retried with a growing backoff, together with
+// the items added meanwhile. After kMaxRetries failures in a row, the flusher
+// aborts if abortOnFailure, and drops the batch otherwise.
+// Subclasses must call stop() in their destructor, while their state is still
+// alive. add() is thread safe.
+template <typename T>
+class BatchFlusher {
+public:
+  BatchFlusher(size_t maxBatch, uint64_t maxDelayUsec, bool abortOnFailure)
+      : maxBatch_(maxBatch),
+        maxDelayUsec_(maxDelayUsec),
+        abortOnFailure_(abortOnFailure),
+        firstAddUsec_(0),
+        stop_(false),
+        thread_(nullptr) {
+    pending_.reserve(maxBatch);
+  }
+
+  virtual ~BatchFlusher() {}
+
+  // Start the flusher thread.
+  void start() {
+    thread_ = new std::thread(&BatchFlusher::run, this);
+  }
+
+  // Flush the remaining items and stop the flusher thread.
+  void stop() {
+    if (thread_ == nullptr) { return; }
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_->join();
+    delete thread_;
+    thread_ = nullptr;
+  }
+
+  // Whether the flusher thread runs.
+  bool started() const { return thread_ != nullptr; }
+
+  void add(T item) {
+    bool full;
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      if (pending_.empty()) {
+        firstAddUsec_ = BenchmarkUtil::getCurrTimeUsec();
+      }
+      pending_.push_back(std::move(item));
+      full = (pending_.size() >= maxBatch_);
+    }
+    // The flusher wakes up on its own when the time threshold expires.
+    if (full) { cv_.notify_one(); }
+  }
+
+protected:
+  static const int kMaxRetries = 5;
+  static const uint64_t kRetryUsec = 1000;  // doubled on every retry
+
+  // Called on the flusher thread before the first flush, e.g. to connect.
+  virtual void setup() {}
+
+  // Store a batch on the flusher thread. Return false if it failed.
+  virtual bool flush(const std::vector<T>& batch) = 0;
+
+private:
+  // Flusher thread main loop.
+  void run() {
+    setup();
+    std::vector<T> batch;
+    batch.reserve(maxBatch_);
+    int failures = 0;  // consecutive failed flushes
+    std::unique_lock<std::mutex> lk(lock_);
+    while (true) {
+      // Sleep until the batch is full, the oldest item is due, or stop.
+      auto ready = [this] {
+        return stop_ || pending_.size() >= maxBatch_ ||
+               (!pending_.empty() && BenchmarkUtil::getCurrTimeUsec() >=
+                                         firstAddUsec_ + maxDelayUsec_);
+      };
+      while (!ready()) {
+        if (pending_.empty()) {
+          cv_.wait(lk);
+        } else {
+          uint64_t due = firstAddUsec_ + maxDelayUsec_;
+          uint64_t now = BenchmarkUtil::getCurrTimeUsec();
+          cv_.wait_for(lk,
+                       std::chrono::microseconds(due > now ? due - now : 0));
+        }
+      }
+      if (pending_.empty() && stop_) { break; }
+
+      // Swap the batch out so threads can keep adding while we flush.
+      uint64_t batchFirstAddUsec = firstAddUsec_;
+      batch.swap(pending_);
+      lk.unlock();
+      bool ok = flush(batch);
+      lk.lock();
+      if (ok) {
+        failures = 0;
+        batch.clear();
+        continue;
+      }
+      if (++failures > kMaxRetries) {
+        if (abortOnFailure_) { abort(); }
+        std::cout << "Dropped a batch of " << batch.size() << " items after "
+                  << kMaxRetries << " retries" << std::endl;
+        failures = 0;
+        batch.clear();
+        continue;
+      }
+
+      // Put the batch back in front of the items added meanwhile and retry
+      // it with them after a backoff.
+      batch.insert(batch.end(), std::make_move_iterator(pending_.begin()),
+                   std::make_move_iterator(pending_.end()));
+      pending_.swap(batch);
+      batch.clear();
+      firstAddUsec_ = batchFirstAddUsec;
+      cv_.wait_for(lk, std::chrono::microseconds(kRetryUsec << failures),
+                   [this] { return stop_; });
+    }
+  }
+
+  size_t maxBatch_;
+  uint64_t maxDelayUsec_;
+  bool abortOnFailure_;
+
+  std::mutex lock_;             // protects the fields below
+  std::condition_variable cv_;  // wakes the flusher up
+  std::vector<T> pending_;      // added, not yet flushed
+  uint64_t firstAddUsec_;       // when the oldest pending item was added
+  bool stop_;
+  std::thread* thread_;
+};
+
+#endif  // #ifndef DBOS_BATCH_FLUSHER_H
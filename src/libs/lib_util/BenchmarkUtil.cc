@@ -1,5 +1,7 @@
 #include "BenchmarkUtil.h"
 
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -132,3 +134,16 @@ void BenchmarkUtil::printStats(const BenchmarkUtil::Statistics& stats,
       stats.min, stats.max, stats.P99, throughput);
   fflush(stdout);
 }
+
+bool BenchmarkUtil::pinThreadToCore(int core) {
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+  if (ret != 0) {
+    std::cerr << "Failed to pin thread to core " << core << ": "
+              << strerror(ret) << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -2,6 +2,7 @@
 #ifndef DBOS_BENCHMARK_UTIL_H
 #define DBOS_BENCHMARK_UTIL_H
 
+#include <time.h>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -43,6 +44,9 @@ public:
   static void printStats(const Statistics& stats, const std::string& header,
                          const double throughput);
 
+  // Pin the calling thread to a CPU core. Return false on failure.
+  static bool pinThreadToCore(int core);
+
 private:
   // Convert timespec to uint64_t timestamp in usec.
   static inline uint64_t timespecToUsec(const struct timespec& a) {
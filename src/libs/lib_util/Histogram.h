@@ -0,0 +1,81 @@
+// This file contains a lock-free histogram of non-negative integer samples.
+#ifndef DBOS_HISTOGRAM_H
+#define DBOS_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear buckets: values below kSubBuckets have a bucket each; above,
+// every power of two is split into kSubBuckets buckets, so a bucket is at most
+// 1/kSubBuckets (12.5%) wide relative to its values. The whole uint64_t range
+// fits in about 500 buckets.
+// record() is a few relaxed atomic adds and is safe from any thread. Readers
+// may see a sample in some counters and not yet in others.
+class Histogram {
+public:
+  Histogram() : count_(0), sum_(0), max_(0) {
+    for (size_t i = 0; i < kNumBuckets; ++i) { buckets_[i].store(0); }
+  }
+
+  void record(uint64_t value) {
+    buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(
+                              max, value, std::memory_order_relaxed)) {}
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  double mean() const {
+    uint64_t n = count();
+    return n > 0 ? (double)sum() / n : 0;
+  }
+
+  // Upper bound of the bucket that holds the p-th percentile (0 < p <= 100),
+  // capped at the largest sample. 0 if empty.
+  uint64_t percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) { return 0; }
+    uint64_t rank = (uint64_t)(p / 100.0 * n + 0.5);
+    if (rank < 1) { rank = 1; }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      seen += buckets_[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        uint64_t upper = upperBound(i);
+        return upper < max() ? upper : max();
+      }
+    }
+    return max();
+  }
+
+private:
+  static const int kSubBits = 3;
+  static const uint64_t kSubBuckets = 1 << kSubBits;
+  static const size_t kNumBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+  static size_t bucketOf(uint64_t value) {
+    if (value < kSubBuckets) { return value; }
+    int shift = 63 - __builtin_clzll(value) - kSubBits;
+    return (shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+  }
+
+  static uint64_t upperBound(size_t bucket) {
+    if (bucket < kSubBuckets) { return bucket; }
+    int shift = bucket / kSubBuckets - 1;
+    uint64_t lower = (kSubBuckets + bucket % kSubBuckets) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+  }
+
+  std::atomic<uint64_t> buckets_[kNumBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+#endif  // #ifndef DBOS_HISTOGRAM_H
@@ -0,0 +1,46 @@
+// This file contains a one-shot countdown latch (std::latch is C++20).
+#ifndef DBOS_LATCH_H
+#define DBOS_LATCH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Threads count down as they finish their part; wait() blocks until the count
+// reaches zero. Workers use it to tell other threads the moment they finished
+// draining, instead of having them poll.
+class Latch {
+public:
+  explicit Latch(size_t count) : count_(count) {}
+
+  void countDown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ > 0 && --count_ == 0) { cv_.notify_all(); }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return count_ == 0; });
+  }
+
+  // Wait up to timeoutUsec. Return true if the count reached zero.
+  bool waitFor(uint64_t timeoutUsec) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, std::chrono::microseconds(timeoutUsec),
+                        [this] { return count_ == 0; });
+  }
+
+  size_t count() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t count_;
+};
+
+#endif  // #ifndef DBOS_LATCH_H
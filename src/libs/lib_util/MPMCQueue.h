@@ -0,0 +1,182 @@
+// This file contains a bounded lock-free multi-producer multi-consumer queue.
+#ifndef DBOS_MPMC_QUEUE_H
+#define DBOS_MPMC_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bounded ring buffer after Dmitry Vyukov's MPMC queue: every cell carries a
+// sequence number that tells producers and consumers whether it is free or
+// full for the current lap, so push and pop are a single CAS on the
+// enqueue/dequeue position in the common case.
+// Consumers that find the queue empty spin for a while and then park on a
+// condition variable. Producers only take the mutex to wake them when some
+// consumer is actually parked, so the fast path never locks or syscalls.
+// T must be default constructible and copy assignable.
+template <typename T>
+class MPMCQueue {
+public:
+  // The capacity is rounded up to a power of two.
+  explicit MPMCQueue(size_t capacity)
+      : mask_(roundUpPow2(capacity) - 1),
+        cells_(mask_ + 1),
+        enqueuePos_(0),
+        dequeuePos_(0),
+        sleepers_(0),
+        closed_(false) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Return false if the queue is full.
+  bool tryPush(const T& value) {
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          cell.data = value;
+          cell.seq.store(pos + 1, std::memory_order_release);
+          wakeOne();
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Push, spinning (and yielding) while the queue is full.
+  void push(const T& value) {
+    while (!tryPush(value)) { std::this_thread::yield(); }
+  }
+
+  // Pop up to <max> consecutive elements with a single CAS. Return the
+  // number of popped elements, 0 if the queue is empty.
+  size_t tryPopBatch(T* out, size_t max) {
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+      // Count how many cells from pos on are ready for this lap.
+      size_t n = 0;
+      while (n < max) {
+        size_t seq = cells_[(pos + n) & mask_].seq.load(
+            std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + n + 1) != 0) { break; }
+        n++;
+      }
+      if (n == 0) {
+        size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) { return 0; }  // empty
+        // Another consumer moved past pos; retry from the new position.
+        pos = dequeuePos_.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (dequeuePos_.compare_exchange_weak(pos, pos + n,
+                                            std::memory_order_relaxed)) {
+        for (size_t i = 0; i < n; ++i) {
+          Cell& cell = cells_[(pos + i) & mask_];
+          out[i] = cell.data;
+          cell.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return n;
+      }
+    }
+  }
+
+  bool tryPop(T& value) { return tryPopBatch(&value, 1) == 1; }
+
+  // Pop up to <max> elements; block while the queue is empty. Spin first,
+  // then park. Return 0 only if the queue is closed and drained.
+  size_t popBatch(T* out, size_t max) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      size_t n = tryPopBatch(out, max);
+      if (n > 0) { return n; }
+      if (closed_.load(std::memory_order_acquire)) { break; }
+    }
+    for (;;) {
+      size_t n = tryPopBatch(out, max);
+      if (n > 0) { return n; }
+      std::unique_lock<std::mutex> lk(mutex_);
+      // Announce before re-checking, so a concurrent push sees a sleeper.
+      sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      cv_.wait(lk, [this] {
+        return !empty() || closed_.load(std::memory_order_acquire);
+      });
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      if (empty() && closed_.load(std::memory_order_acquire)) { return 0; }
+    }
+  }
+
+  // Wake up all consumers; popBatch() returns 0 once the queue is drained.
+  void close() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    closed_.store(true, std::memory_order_release);
+    cv_.notify_all();
+  }
+
+  bool empty() const {
+    size_t pos = dequeuePos_.load(std::memory_order_acquire);
+    size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)(pos + 1) < 0;
+  }
+
+  // Approximate number of queued elements.
+  size_t size() const {
+    size_t head = dequeuePos_.load(std::memory_order_relaxed);
+    size_t tail = enqueuePos_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+private:
+  static const int kSpinCount = 1000;
+  static const size_t kCacheLine = 64;
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  static size_t roundUpPow2(size_t v) {
+    size_t p = 2;
+    while (p < v) { p <<= 1; }
+    return p;
+  }
+
+  void wakeOne() {
+    // Pairs with the fetch_add in popBatch(): either the consumer sees the
+    // new element or we see it parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      cv_.notify_one();
+    }
+  }
+
+  const size_t mask_;
+  std::vector<Cell> cells_;
+  // Keep producer and consumer positions on separate cache lines. Explicit
+  // padding rather than alignas, which C++11 operator new does not honor.
+  char pad0_[kCacheLine];
+  std::atomic<size_t> enqueuePos_;
+  char pad1_[kCacheLine - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> dequeuePos_;
+  char pad2_[kCacheLine - sizeof(std::atomic<size_t>)];
+  std::atomic<int> sleepers_;
+  char pad3_[kCacheLine - sizeof(std::atomic<int>)];
+  std::atomic<bool> closed_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+#endif  // #ifndef DBOS_MPMC_QUEUE_H
@@ -0,0 +1,223 @@
+#include "ThreadPlacement.h"
+
+#include <dirent.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "BenchmarkUtil.h"
+
+const int ThreadPlacement::kPinOption;
+
+// Parse a Linux CPU list such as "0-3,8,10-11". Return false if malformed.
+static bool parseCpuList(const std::string& list, std::vector<int>* cpus) {
+  std::istringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) { continue; }
+    char* end;
+    long first = strtol(range.c_str(), &end, 10);
+    long last = first;
+    if (*end == '-') { last = strtol(end + 1, &end, 10); }
+    if (*end != '\0' && *end != '\n') { return false; }
+    if (first < 0 || last < first) { return false; }
+    for (long cpu = first; cpu <= last; ++cpu) { cpus->push_back(cpu); }
+  }
+  return !cpus->empty();
+}
+
+// Read the first line of a sysfs file.
+static bool readLine(const std::string& path, std::string* line) {
+  std::ifstream file(path);
+  return file.is_open() && std::getline(file, *line);
+}
+
+// Read an integer from a sysfs file, or return defaultValue.
+static int readInt(const std::string& path, int defaultValue) {
+  std::string line;
+  if (!readLine(path, &line) || line.empty()) { return defaultValue; }
+  return atoi(line.c_str());
+}
+
+std::vector<ThreadPlacement::CpuInfo> ThreadPlacement::loadTopology() {
+  // NUMA node of each CPU; machines without NUMA have no node directory.
+  std::map<int, int> nodes;
+  const std::string nodeDir = "/sys/devices/system/node/";
+  DIR* dir = opendir(nodeDir.c_str());
+  if (dir != nullptr) {
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+      std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          name.find_first_not_of("0123456789", 4) != std::string::npos) {
+        continue;
+      }
+      std::string list;
+      std::vector<int> cpus;
+      if (readLine(nodeDir + name + "/cpulist", &list) &&
+          parseCpuList(list, &cpus)) {
+        for (int cpu : cpus) { nodes[cpu] = atoi(name.c_str() + 4); }
+      }
+    }
+    closedir(dir);
+  }
+
+  // Only the CPUs this process may run on, e.g. inside a cpuset.
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+  std::vector<int> online;
+  std::string list;
+  if (!readLine("/sys/devices/system/cpu/online", &list) ||
+      !parseCpuList(list, &online)) {
+    online.clear();
+    for (unsigned i = 0; i < std::thread::hardware_concurrency(); ++i) {
+      online.push_back(i);
+    }
+  }
+
+  std::vector<CpuInfo> topology;
+  for (int cpu : online) {
+    if (haveMask && cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &allowed)) {
+      continue;
+    }
+    std::string base =
+        "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+    CpuInfo info;
+    info.cpu = cpu;
+    info.node = nodes.count(cpu) ? nodes[cpu] : 0;
+    info.package = readInt(base + "physical_package_id", 0);
+    info.core = readInt(base + "core_id", cpu);
+    topology.push_back(info);
+  }
+  return topology;
+}
+
+int ThreadPlacement::nodeOf(int cpu) const {
+  for (const CpuInfo& info : topology_) {
+    if (info.cpu == cpu) { return info.node; }
+  }
+  return -1;
+}
+
+bool ThreadPlacement::parse(const std::string& spec) {
+  spec_ = spec;
+  enabled_ = false;
+  order_.clear();
+  if (spec == "none") { return true; }
+
+  topology_ = loadTopology();
+  if (topology_.empty()) {
+    std::cerr << "No CPUs found to place threads on" << std::endl;
+    return false;
+  }
+
+  // Compact order: by node, then physical core, SMT siblings adjacent.
+  std::vector<CpuInfo> compact = topology_;
+  std::sort(compact.begin(), compact.end(),
+            [](const CpuInfo& a, const CpuInfo& b) {
+              return std::make_tuple(a.node, a.package, a.core, a.cpu) <
+                     std::make_tuple(b.node, b.package, b.core, b.cpu);
+            });
+
+  if (spec == "compact") {
+    for (const CpuInfo& info : compact) { order_.push_back(info.cpu); }
+  } else if (spec == "scatter") {
+    // Rank each CPU among the SMT siblings of its core, and each core among
+    // the cores of its node, then take rank 0 of every core of every node
+    // round-robin before any sibling.
+    std::map<std::pair<int, int>, int> siblings;  // (package, core) -> count
+    std::map<int, std::set<std::pair<int, int>>> nodeCores;
+    std::vector<std::tuple<int, int, int, int>> keys;
+    for (const CpuInfo& info : compact) {
+      std::pair<int, int> core(info.package, info.core);
+      int siblingRank = siblings[core]++;
+      std::set<std::pair<int, int>>& cores = nodeCores[info.node];
+      cores.insert(core);
+      int coreRank = std::distance(cores.begin(), cores.find(core));
+      keys.emplace_back(siblingRank, coreRank, info.node, info.cpu);
+    }
+    std::sort(keys.begin(), keys.end());
+    for (auto& key : keys) { order_.push_back(std::get<3>(key)); }
+  } else if (spec.compare(0, 4, "nic:") == 0) {
+    std::string ifname = spec.substr(4);
+    int nicNode =
+        readInt("/sys/class/net/" + ifname + "/device/numa_node", -1);
+    if (nicNode < 0) {
+      std::cerr << "NUMA node of " << ifname
+                << " is unknown; placing threads compactly" << std::endl;
+    }
+    for (const CpuInfo& info : compact) {
+      if (info.node == nicNode) { order_.push_back(info.cpu); }
+    }
+    for (const CpuInfo& info : compact) {
+      if (info.node != nicNode) { order_.push_back(info.cpu); }
+    }
+  } else if (spec.compare(0, 5, "list:") == 0) {
+    if (!parseCpuList(spec.substr(5), &order_)) {
+      std::cerr << "Invalid CPU list: " << spec.substr(5) << std::endl;
+      return false;
+    }
+  } else {
+    std::cerr << "Unknown placement policy: " << spec << std::endl;
+    return false;
+  }
+  enabled_ = true;
+  return true;
+}
+
+int ThreadPlacement::cpu(size_t slot) const {
+  if (!enabled_) { return -1; }
+  return order_[slot % order_.size()];
+}
+
+int ThreadPlacement::assign(size_t slot, const std::string& role) {
+  if (!enabled_) { return -1; }
+  int core = cpu(slot);
+  std::lock_guard<std::mutex> lk(lock_);
+  records_.push_back(Record{role, slot, core});
+  return core;
+}
+
+int ThreadPlacement::pin(size_t slot, const std::string& role) {
+  if (!enabled_) { return -1; }
+  int core = cpu(slot);
+  if (!BenchmarkUtil::pinThreadToCore(core)) { return -1; }
+  return assign(slot, role);
+}
+
+void ThreadPlacement::printResults(std::ostream& out) const {
+  std::lock_guard<std::mutex> lk(lock_);
+  out << "Role,Slot,CPU,Node\n";
+  for (const Record& record : records_) {
+    out << record.role << "," << record.slot << "," << record.cpu << ","
+        << nodeOf(record.cpu) << "\n";
+  }
+}
+
+bool ThreadPlacement::writeResults(const std::string& file) const {
+  std::ofstream out(file);
+  if (!out.is_open()) {
+    std::cerr << "Could not open file: " << file << std::endl;
+    return false;
+  }
+  out << "# --pin " << spec_ << "\n";
+  printResults(out);
+  std::cerr << "Stored thread placement to: " << file << std::endl;
+  return true;
+}
+
+void ThreadPlacement::printUsage(std::ostream& out) {
+  out << "\t--pin <thread placement (none, compact, scatter, nic:<ifname>, "
+      << "list:<cpus>)>: default none\n";
+}
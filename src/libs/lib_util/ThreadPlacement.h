@@ -0,0 +1,90 @@
+// This file contains a placement policy for benchmark threads on CPUs.
+#ifndef DBOS_THREAD_PLACEMENT_H
+#define DBOS_THREAD_PLACEMENT_H
+
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Benchmarks number their threads with placement slots, and the policy maps
+// slot i to the i-th CPU of an order built from the machine topology (sysfs),
+// restricted to the CPUs the process may run on. Slots wrap around the order
+// when there are more threads than CPUs. Policies, as given to --pin:
+//   none            do not pin (default)
+//   compact         fill one NUMA node, then the next; SMT siblings adjacent
+//   scatter         round-robin over NUMA nodes, one thread per physical
+//                   core before any SMT sibling is used
+//   nic:<ifname>    CPUs of the NUMA node of the network interface first
+//                   (compact), then the other nodes
+//   list:<cpus>     explicit CPU list in order, e.g. list:0-3,8,10
+// Every pinned or assigned thread is recorded with its role so benchmarks can
+// store the placement next to their results.
+// pin() and assign() are thread safe.
+class ThreadPlacement {
+public:
+  // getopt_long value of the --pin option.
+  static const int kPinOption = 0x100;
+
+  ThreadPlacement() : enabled_(false), spec_("none") {}
+
+  // Parse a policy and build the CPU order. Print the reason and return false
+  // if the policy is invalid.
+  bool parse(const std::string& spec);
+
+  bool enabled() const { return enabled_; }
+
+  // The policy as given to parse().
+  const std::string& spec() const { return spec_; }
+
+  // CPU of a slot, or -1 if placement is disabled.
+  int cpu(size_t slot) const;
+
+  // Pin the calling thread to the CPU of a slot and record it under role.
+  // Return the CPU, or -1 if placement is disabled or pinning failed.
+  int pin(size_t slot, const std::string& role);
+
+  // Record a thread that someone else pins to the CPU of a slot (e.g. an
+  // executor pinned by its worker). Return the CPU, or -1 if disabled.
+  int assign(size_t slot, const std::string& role);
+
+  // Print the recorded threads, one "role,slot,cpu,node" line each.
+  void printResults(std::ostream& out) const;
+
+  // Write the recorded threads to a CSV file. Return false on failure.
+  bool writeResults(const std::string& file) const;
+
+  // Print the --pin usage line.
+  static void printUsage(std::ostream& out);
+
+private:
+  struct CpuInfo {
+    int cpu;
+    int node;
+    int package;
+    int core;
+  };
+
+  struct Record {
+    std::string role;
+    size_t slot;
+    int cpu;
+  };
+
+  // Read the CPUs the process may run on and their topology.
+  static std::vector<CpuInfo> loadTopology();
+
+  // NUMA node of a CPU in the loaded topology, -1 if unknown.
+  int nodeOf(int cpu) const;
+
+  bool enabled_;
+  std::string spec_;
+  std::vector<CpuInfo> topology_;
+  std::vector<int> order_;  // CPU of each slot, before wrapping
+
+  mutable std::mutex lock_;  // protects records_
+  std::vector<Record> records_;
+};
+
+#endif  // #ifndef DBOS_THREAD_PLACEMENT_H
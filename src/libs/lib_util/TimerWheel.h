@@ -0,0 +1,157 @@
+// This file contains a hashed timer wheel that fires callbacks on deadlines.
+#ifndef DBOS_TIMER_WHEEL_H
+#define DBOS_TIMER_WHEEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Time is cut into ticks of tickUsec, and a timer due at tick t lives in slot
+// t % numSlots, so scheduling is O(1) and a tick only scans one slot. Timers
+// more than one rotation away stay in their slot until their tick comes.
+// A single thread advances the wheel and calls expire(value) for every due
+// timer, in tick order, outside the lock. Timers fire at most one tick late.
+// The thread sleeps while the wheel is empty.
+// schedule() is thread safe.
+template <typename T>
+class TimerWheel {
+public:
+  // The number of slots is rounded up to a power of two.
+  TimerWheel(uint64_t tickUsec, size_t numSlots,
+             std::function<void(const T&)> expire)
+      : tickUsec_(tickUsec > 0 ? tickUsec : 1),
+        mask_(roundUpPow2(numSlots) - 1),
+        slots_(mask_ + 1),
+        expire_(expire),
+        start_(std::chrono::steady_clock::now()),
+        currentTick_(0),
+        count_(0),
+        stop_(false),
+        thread_(nullptr) {}
+
+  ~TimerWheel() { stop(); }
+
+  // Start the thread that advances the wheel.
+  void start() { thread_ = new std::thread(&TimerWheel::run, this); }
+
+  // Stop the thread. Timers that are still pending are dropped.
+  void stop() {
+    if (thread_ == nullptr) { return; }
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_->join();
+    delete thread_;
+    thread_ = nullptr;
+  }
+
+  // Call expire(value) after delayUsec.
+  void schedule(const T& value, uint64_t delayUsec) {
+    uint64_t due = (nowUsec() + delayUsec + tickUsec_ - 1) / tickUsec_;
+    bool wasEmpty;
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      // The current tick is already scanned.
+      if (due <= currentTick_) { due = currentTick_ + 1; }
+      slots_[due & mask_].push_back(Timer{due, value});
+      wasEmpty = (count_++ == 0);
+    }
+    if (wasEmpty) { cv_.notify_one(); }
+  }
+
+  // Number of pending timers.
+  size_t size() {
+    std::lock_guard<std::mutex> lk(lock_);
+    return count_;
+  }
+
+private:
+  struct Timer {
+    uint64_t tick;
+    T value;
+  };
+
+  static size_t roundUpPow2(size_t v) {
+    size_t p = 1;
+    while (p < v) { p <<= 1; }
+    return p;
+  }
+
+  uint64_t nowUsec() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+  // Move the timers of slot that are due by tick to fired.
+  void collect(size_t slot, uint64_t tick, std::vector<T>* fired) {
+    std::vector<Timer>& timers = slots_[slot];
+    size_t kept = 0;
+    for (size_t i = 0; i < timers.size(); ++i) {
+      if (timers[i].tick <= tick) {
+        fired->push_back(timers[i].value);
+      } else {
+        timers[kept++] = timers[i];
+      }
+    }
+    timers.resize(kept);
+  }
+
+  void run() {
+    std::vector<T> fired;
+    std::unique_lock<std::mutex> lk(lock_);
+    while (!stop_) {
+      if (count_ == 0) {
+        cv_.wait(lk, [this] { return stop_ || count_ > 0; });
+        continue;
+      }
+      uint64_t target = nowUsec() / tickUsec_;
+      if (target > currentTick_) {
+        if (target - currentTick_ > mask_) {
+          // Fell behind by a whole rotation; every slot may have due timers.
+          for (size_t slot = 0; slot <= mask_; ++slot) {
+            collect(slot, target, &fired);
+          }
+        } else {
+          for (uint64_t tick = currentTick_ + 1; tick <= target; ++tick) {
+            collect(tick & mask_, tick, &fired);
+          }
+        }
+        currentTick_ = target;
+        count_ -= fired.size();
+      }
+      if (!fired.empty()) {
+        lk.unlock();
+        for (const T& value : fired) { expire_(value); }
+        fired.clear();
+        lk.lock();
+        continue;
+      }
+      // Sleep until the next tick starts.
+      cv_.wait_until(lk, start_ + std::chrono::microseconds(
+                                      (currentTick_ + 1) * tickUsec_));
+    }
+  }
+
+  const uint64_t tickUsec_;
+  const size_t mask_;
+  std::vector<std::vector<Timer>> slots_;
+  std::function<void(const T&)> expire_;
+  const std::chrono::steady_clock::time_point start_;
+
+  std::mutex lock_;             // protects the fields below and slots_
+  std::condition_variable cv_;  // wakes the wheel thread up
+  uint64_t currentTick_;        // the last scanned tick
+  size_t count_;                // pending timers
+  bool stop_;
+  std::thread* thread_;
+};
+
+#endif  // #ifndef DBOS_TIMER_WHEEL_H
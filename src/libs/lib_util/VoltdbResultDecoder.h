@@ -0,0 +1,264 @@
+// This file contains a light-weight decoder for small VoltDB result tables.
+#ifndef DBOS_VOLTDB_RESULT_DECODER_H
+#define DBOS_VOLTDB_RESULT_DECODER_H
+
+#include <endian.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "voltdb-client-cpp/include/Exception.hpp"
+#include "voltdb-client-cpp/include/InvocationResponse.hpp"
+#include "voltdb-client-cpp/include/Table.h"
+#include "voltdb-client-cpp/include/WireType.h"
+
+// The generic path (results() -> iterator() -> next() -> getInt64()) copies
+// the vector of tables, then builds an iterator, a column schema pointer and a
+// per-row offsets vector for every response. This decoder reaches the tables
+// through InvocationResponse::resultsRef() and parses the wire format in place
+// in the response buffer (Table::serializedData()):
+//   int32 headerLen | int8 status | int16 numCols | int8 types[numCols] |
+//   names... | int32 numRows | (int32 rowLen, row)*
+// All integers are big-endian. The decoder keeps a reference to the decoded
+// table, so the response may go away before the rows are read. The row
+// offsets vector is reused across calls, so after the first few responses
+// decoding does not allocate. Every read is checked against the table size,
+// so empty or malformed tables are rejected.
+// Note: not thread safe. Use one decoder per thread (same as voltdb::Client).
+class VoltdbResultDecoder {
+public:
+  VoltdbResultDecoder() : data_(nullptr), size_(0), numRows_(0), numCols_(0) {
+    rowOffsets_.reserve(kInitRows);
+  }
+
+  // Decode the result table at <index>. Return false, with no rows, if there
+  // is no such table, the schema has more than kMaxColumns columns, or the
+  // table is malformed.
+  bool decode(const voltdb::InvocationResponse& r, size_t index = 0) {
+    reset();
+    const std::vector<voltdb::Table>& tables = r.resultsRef();
+    if (index >= tables.size()) { return false; }
+    // Only bumps the reference count of the response buffer.
+    table_ = tables[index];
+    data_ = table_.serializedData(&size_);
+    if (data_ == nullptr || size_ < 0 || !parse()) {
+      reset();
+      return false;
+    }
+    return true;
+  }
+
+  int32_t rowCount() const { return numRows_; }
+
+  int32_t columnCount() const { return numCols_; }
+
+  // Read an integer column (TINYINT to BIGINT) of a row as int64. Throw
+  // IndexOutOfBoundsException or InvalidColumnException if there is no such
+  // row or column.
+  int64_t getInt64(int32_t row, int32_t column) const {
+    int32_t pos = columnOffset(row, column);
+    int32_t len = columnLength(column, pos);
+    if (len < 0 || len > rowEnd(row) - pos) {
+      throw voltdb::IndexOutOfBoundsException();
+    }
+    switch (types_[column]) {
+      case voltdb::WIRE_TYPE_BIGINT:
+      case voltdb::WIRE_TYPE_TIMESTAMP:
+        return readInt64(pos);
+      case voltdb::WIRE_TYPE_INTEGER:
+        return readInt32(pos);
+      case voltdb::WIRE_TYPE_SMALLINT:
+        return readInt16(pos);
+      case voltdb::WIRE_TYPE_TINYINT:
+        return static_cast<int8_t>(data_[pos]);
+      default:
+        throw voltdb::InvalidColumnException(column, numCols_);
+    }
+  }
+
+  // Return a view of a VARBINARY or VARCHAR column of a row and store its
+  // length in size, or return nullptr if it is NULL. The view points into the
+  // response buffer, so it is valid until the next decode(), unless the table
+  // is taken first. Throws like getInt64().
+  const char* getBytes(int32_t row, int32_t column, size_t* size) const {
+    int32_t pos = columnOffset(row, column);
+    int32_t len = columnLength(column, pos);
+    if (len < static_cast<int32_t>(sizeof(int32_t)) ||
+        len > rowEnd(row) - pos) {
+      throw voltdb::IndexOutOfBoundsException();
+    }
+    int32_t dataLen = readInt32(pos);
+    *size = dataLen > 0 ? dataLen : 0;
+    return dataLen < 0 ? nullptr : data_ + pos + sizeof(int32_t);
+  }
+
+  // Hand the decoded table, whose buffer the views of getBytes() point into,
+  // to the caller so they stay valid after the next decode().
+  void takeTable(voltdb::Table* out) {
+    *out = table_;
+    reset();
+  }
+
+  // Return the single value of a procedure that returns a long, i.e. a table
+  // with one row and one BIGINT column, or defaultValue if the response has
+  // no such table. Reads the value in place and keeps no state, so it is
+  // cheaper than keeping a decoder around for the common one-scalar case.
+  static int64_t getScalarInt64(const voltdb::InvocationResponse& r,
+                                int64_t defaultValue = -1) {
+    const std::vector<voltdb::Table>& tables = r.resultsRef();
+    if (tables.empty()) { return defaultValue; }
+    int32_t size;
+    const char* data = tables[0].serializedData(&size);
+    if (data == nullptr || size < static_cast<int32_t>(sizeof(int32_t))) {
+      return defaultValue;
+    }
+    int32_t headerLen = static_cast<int32_t>(be32toh(load<uint32_t>(data)));
+    // Header length, header, row count, row length, value.
+    const int32_t kFixedBytes = 3 * sizeof(int32_t) + sizeof(int64_t);
+    if (headerLen < 0 || headerLen > size - kFixedBytes) {
+      return defaultValue;
+    }
+    int32_t rowCountPos = sizeof(int32_t) + headerLen;
+    if (be32toh(load<uint32_t>(data + rowCountPos)) == 0) {
+      return defaultValue;
+    }
+    int32_t pos = rowCountPos + 2 * sizeof(int32_t);
+    return static_cast<int64_t>(be64toh(load<uint64_t>(data + pos)));
+  }
+
+private:
+  static const int32_t kMaxColumns = 16;
+  static const size_t kInitRows = 64;
+
+  template <typename T>
+  static T load(const char* p) {
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+  }
+
+  int64_t readInt64(int32_t pos) const {
+    return static_cast<int64_t>(be64toh(load<uint64_t>(data_ + pos)));
+  }
+
+  int32_t readInt32(int32_t pos) const {
+    return static_cast<int32_t>(be32toh(load<uint32_t>(data_ + pos)));
+  }
+
+  int16_t readInt16(int32_t pos) const {
+    return static_cast<int16_t>(be16toh(load<uint16_t>(data_ + pos)));
+  }
+
+  void reset() {
+    table_ = voltdb::Table();
+    data_ = nullptr;
+    size_ = 0;
+    numRows_ = 0;
+    numCols_ = 0;
+    rowOffsets_.clear();
+  }
+
+  // True if <len> bytes starting at <pos> lie within the table.
+  bool fits(int32_t pos, int32_t len) const {
+    return pos >= 0 && len >= 0 && len <= size_ - pos;
+  }
+
+  // Parse the header and row offsets of the table at data_.
+  bool parse() {
+    int32_t pos = 0;
+    if (!fits(pos, sizeof(int32_t))) { return false; }
+    int32_t headerLen = readInt32(pos);
+    pos += sizeof(int32_t);
+    if (!fits(pos, headerLen)) { return false; }
+    int32_t rowCountPos = pos + headerLen;
+    pos += sizeof(int8_t);  // status
+    if (headerLen < static_cast<int32_t>(sizeof(int8_t) + sizeof(int16_t))) {
+      return false;
+    }
+    int32_t numCols = readInt16(pos);
+    if (numCols < 0 || numCols > kMaxColumns) { return false; }
+    pos += sizeof(int16_t);
+    if (!fits(pos, numCols) || pos + numCols > rowCountPos) { return false; }
+    for (int32_t i = 0; i < numCols; ++i) { types_[i] = data_[pos + i]; }
+
+    if (!fits(rowCountPos, sizeof(int32_t))) { return false; }
+    int32_t numRows = readInt32(rowCountPos);
+    if (numRows < 0) { return false; }
+    pos = rowCountPos + sizeof(int32_t);
+    for (int32_t i = 0; i < numRows; ++i) {
+      if (!fits(pos, sizeof(int32_t))) { return false; }
+      int32_t rowLen = readInt32(pos);
+      pos += sizeof(int32_t);
+      if (!fits(pos, rowLen)) { return false; }
+      rowOffsets_.push_back(pos);
+      pos += rowLen;
+    }
+    rowOffsets_.push_back(pos);  // end of the last row, see rowEnd()
+    numCols_ = numCols;
+    numRows_ = numRows;
+    return true;
+  }
+
+  // End of a row's data: the next row's length prefix, or the table end.
+  int32_t rowEnd(int32_t row) const {
+    return row + 1 < numRows_ ? rowOffsets_[row + 1] - sizeof(int32_t)
+                              : rowOffsets_[numRows_];
+  }
+
+  // Start of a column of a row. Throw if there is no such row or column, or
+  // an earlier column runs past the row.
+  int32_t columnOffset(int32_t row, int32_t column) const {
+    if (row < 0 || row >= numRows_) {
+      throw voltdb::IndexOutOfBoundsException();
+    }
+    if (column < 0 || column >= numCols_) {
+      throw voltdb::InvalidColumnException(column, numCols_);
+    }
+    int32_t pos = rowOffsets_[row];
+    int32_t end = rowEnd(row);
+    for (int32_t i = 0; i < column; ++i) {
+      int32_t len = columnLength(i, pos);
+      if (len < 0 || len > end - pos) {
+        throw voltdb::IndexOutOfBoundsException();
+      }
+      pos += len;
+    }
+    return pos;
+  }
+
+  // Serialized length of column <i> whose value starts at <pos>, or -1 if a
+  // variable-length prefix does not fit.
+  int32_t columnLength(int32_t i, int32_t pos) const {
+    switch (types_[i]) {
+      case voltdb::WIRE_TYPE_TINYINT:
+        return 1;
+      case voltdb::WIRE_TYPE_SMALLINT:
+        return 2;
+      case voltdb::WIRE_TYPE_INTEGER:
+        return 4;
+      case voltdb::WIRE_TYPE_BIGINT:
+      case voltdb::WIRE_TYPE_FLOAT:
+      case voltdb::WIRE_TYPE_TIMESTAMP:
+        return 8;
+      case voltdb::WIRE_TYPE_DECIMAL:
+        return 16;
+      default: {
+        // Variable length: int32 length prefix, -1 means NULL.
+        if (!fits(pos, sizeof(int32_t))) { return -1; }
+        int32_t len = readInt32(pos);
+        return sizeof(int32_t) + (len > 0 ? len : 0);
+      }
+    }
+  }
+
+  voltdb::Table table_;              // keeps the response buffer alive
+  const char* data_;                 // the table in the response buffer
+  int32_t size_;                     // bytes of the table at data_
+  // Start of each row's data at data_, then the end of the last row.
+  std::vector<int32_t> rowOffsets_;
+  int8_t types_[kMaxColumns];        // column wire types
+  int32_t numRows_;
+  int32_t numCols_;
+};
+
+#endif  // #ifndef DBOS_VOLTDB_RESULT_DECODER_H
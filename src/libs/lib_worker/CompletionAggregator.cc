@@ -0,0 +1,62 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <iostream>
+#include <vector>
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+#include "CompletionAggregator.h"
+#include "VoltdbResultDecoder.h"
+#include "WorkerManager.h"
+
+void CompletionAggregator::setup() {
+  // Create a local VoltDB client.
+  client_.reset(
+      new voltdb::Client(WorkerManager::createVoltdbClient(dbAddr_)));
+  std::vector<voltdb::Parameter> parameterTypes(4);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY, true);
+  procedure_.reset(new voltdb::Procedure("WorkerCompleteTasks", parameterTypes));
+}
+
+bool CompletionAggregator::flush(const std::vector<TaskCompletion>& batch) {
+  // One view per task into the results, or none at all.
+  bool hasResults = false;
+  for (const TaskCompletion& completion : batch) {
+    taskIds_.push_back(completion.taskId);
+    hasResults = hasResults || !completion.result.empty();
+  }
+  if (hasResults) {
+    for (const TaskCompletion& completion : batch) {
+      resultViews_.push_back(voltdb::buffer_t(completion.result.data(),
+                                              completion.result.size()));
+    }
+  }
+  voltdb::ParameterSet* params = procedure_->params();
+  params->addInt32(pkey_).addInt32(workerId_).addInt32(taskIds_);
+  params->addBytes(resultViews_);
+  voltdb::InvocationResponse r = client_->invoke(*procedure_);
+  taskIds_.clear();
+  resultViews_.clear();
+  if (r.failure()) {
+    std::cout << "WorkerCompleteTasks procedure failed. " << r.toString()
+              << std::endl;
+    return false;
+  }
+
+  // Tasks that are no longer running, e.g. whose lease expired, are not
+  // completed again.
+  int64_t completed = VoltdbResultDecoder::getScalarInt64(r, 0);
+  if (completed != static_cast<int64_t>(batch.size())) {
+    std::cout << "WorkerCompleteTasks completed " << completed << " of "
+              << batch.size() << " tasks of worker " << workerId_
+              << std::endl;
+  }
+  WorkerManager::totalFinishedTasks_.fetch_add(completed);
+  return true;
+}
@@ -0,0 +1,62 @@
+// This file contains a per-worker aggregator of task completions.
+#ifndef DBOS_COMPLETION_AGGREGATOR_H
+#define DBOS_COMPLETION_AGGREGATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BatchFlusher.h"
+#include "DbosDefs.h"
+#include "voltdb-client-cpp/include/Client.h"
+
+// A finished task and its result, which may be empty.
+struct TaskCompletion {
+  int32_t taskId;
+  std::vector<char> result;
+};
+
+// Executors hand finished task ids to add() and move on. A flusher thread with
+// its own VoltDB client reports them with one WorkerCompleteTasks call per
+// batch, which also credits the worker capacity once per batch. A batch is
+// flushed when it reaches maxBatch tasks or its oldest task has waited
+// maxDelayUsec, whichever comes first. Task results are stored by the same
+// call; a batch without results sends none. A failed flush is retried with
+// the tasks added meanwhile; the worker aborts after kMaxRetries failures in
+// a row, as it did when each task was reported on its own.
+// add() is thread safe.
+class CompletionAggregator : public BatchFlusher<TaskCompletion> {
+public:
+  CompletionAggregator(DbosId workerId, int pkey, std::string dbAddr,
+                       size_t maxBatch, uint64_t maxDelayUsec)
+      : BatchFlusher<TaskCompletion>(maxBatch, maxDelayUsec, true),
+        workerId_(workerId),
+        pkey_(pkey),
+        dbAddr_(dbAddr) {}
+
+  ~CompletionAggregator() { stop(); }
+
+  // Record a finished task and its result, which may be empty.
+  void add(DbosId taskId,
+           const std::vector<char>& result = std::vector<char>()) {
+    BatchFlusher<TaskCompletion>::add(TaskCompletion{taskId, result});
+  }
+
+protected:
+  void setup() override;
+  bool flush(const std::vector<TaskCompletion>& batch) override;
+
+private:
+  DbosId workerId_;
+  int pkey_;
+  std::string dbAddr_;
+
+  // Only used by the flusher thread.
+  std::unique_ptr<voltdb::Client> client_;
+  std::unique_ptr<voltdb::Procedure> procedure_;
+  std::vector<int32_t> taskIds_;
+  std::vector<voltdb::buffer_t> resultViews_;
+};
+
+#endif  // #ifndef DBOS_COMPLETION_AGGREGATOR_H
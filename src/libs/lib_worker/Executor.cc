@@ -1,3 +1,23 @@
+#include <chrono>
+
 #include "Executor.h"
 
 Executor::~Executor(){};
+
+DbosStatus Executor::executeTask(const Task& task, uint64_t* serviceTimeUsec) {
+  auto start = std::chrono::steady_clock::now();
+  result_.clear();
+  DbosStatus status = run(task);
+  if (serviceTimeUsec != nullptr) {
+    *serviceTimeUsec = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  }
+  return status;
+}
+
+DbosStatus Executor::beginTask(const Task& task, uint64_t* waitUsec) {
+  *waitUsec = 0;
+  result_.clear();
+  return run(task);
+}
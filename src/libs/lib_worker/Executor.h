@@ -1,18 +1,40 @@
 #ifndef EXECUTOR_H
 #define EXECUTOR_H
 
+#include <cstdint>
+#include <vector>
+
 #include "DbosDefs.h"
+#include "Task.h"
 
+// Executors are not thread safe; use one instance per thread.
 class Executor {
 public:
   // Task state.
   Executor(){};
 
-  // TODO: Use Task as an argument here.
-  virtual DbosStatus executeTask() = 0;
+  // Run a task. If serviceTimeUsec is not null, store the measured time the
+  // task took.
+  DbosStatus executeTask(const Task& task, uint64_t* serviceTimeUsec = nullptr);
+
+  // Run the part of a task that needs the CPU, and store in waitUsec how long
+  // the task then blocks on (simulated) I/O, so that a FiberExecutor can wait
+  // without holding the thread. By default the whole task runs here.
+  virtual DbosStatus beginTask(const Task& task, uint64_t* waitUsec);
+
+  // Result blob of the last task, empty if it produced none. Valid until the
+  // next task runs; the buffer is reused across tasks.
+  const std::vector<char>& result() const { return result_; }
 
   // Virtual destructor so that derived classes can be freed.
   virtual ~Executor() = 0;
+
+protected:
+  // Do the actual work of a task.
+  virtual DbosStatus run(const Task& task) = 0;
+
+  // Set by run(), cleared before every task.
+  std::vector<char> result_;
 };
 
 #endif  // #ifndef EXECUTOR_H
@@ -0,0 +1,175 @@
+// This file contains an executor that runs many tasks at once on one thread.
+#ifndef FIBER_EXECUTOR_H
+#define FIBER_EXECUTOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "SyntheticExecutor.h"
+
+// Every task runs as a stackless fiber: Executor::beginTask() runs the CPU
+// part of the task on the calling thread and returns how long the task then
+// waits on (simulated) I/O. The fiber parks in a heap ordered by wake-up
+// time, holding no thread and no stack, and finishes once its wait is over.
+// A fiber costs a heap entry, and switching fibers costs a heap operation,
+// so one thread can keep tens of thousands of sleeping tasks in flight.
+// Tasks that never wait (spin, memory) run to completion one at a time; use
+// executor threads for those.
+// At most maxFibers tasks run at once; the others wait in arrival order.
+// submit() and close() are thread safe; run() is called by one thread.
+template <typename T>
+class FiberExecutor {
+public:
+  // Called on the run() thread when a task finishes, with the time it took
+  // and its result blob, empty if it produced none.
+  typedef std::function<void(const T& value, uint64_t serviceTimeUsec,
+                             const std::vector<char>& result)>
+      DoneCallback;
+  // Called on the run() thread right before a task starts.
+  typedef std::function<void(const T& value)> StartCallback;
+  // Called on the run() thread right after the CPU part of a task ran, before
+  // its fiber waits or the task finishes.
+  typedef std::function<void(const T& value)> BegunCallback;
+
+  FiberExecutor(const WorkloadConfig& workload, size_t maxFibers)
+      : workload_(workload),
+        maxFibers_(std::max(maxFibers, (size_t)1)),
+        closed_(false),
+        waiting_(false),
+        peakFibers_(0) {}
+
+  // Queue a task; value is handed back to the done callback.
+  void submit(const T& value, const Task& task) {
+    bool wake;
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      inbox_.push_back(Pending{value, task});
+      wake = waiting_;
+    }
+    if (wake) { cv_.notify_one(); }
+  }
+
+  // No more tasks will be submitted; run() returns once all are done.
+  void close() {
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      closed_ = true;
+    }
+    cv_.notify_one();
+  }
+
+  // Run tasks on the calling thread until closed and drained.
+  void run(const DoneCallback& done,
+           const StartCallback& start = StartCallback(),
+           const BegunCallback& begun = BegunCallback()) {
+    std::unique_ptr<Executor> executor(createExecutor(workload_));
+    std::deque<Pending> backlog;  // arrived, waiting for a free fiber
+    for (;;) {
+      // Finish the fibers whose wait is over.
+      Clock::time_point now = Clock::now();
+      while (!sleeping_.empty() && sleeping_.top().wakeTime <= now) {
+        const Fiber& fiber = sleeping_.top();
+        done(fiber.value, elapsedUsec(fiber.startTime, now), fiber.result);
+        sleeping_.pop();
+      }
+
+      {
+        std::unique_lock<std::mutex> lk(lock_);
+        bool canStart = !backlog.empty() && sleeping_.size() < maxFibers_;
+        if (!canStart && inbox_.empty()) {
+          // Sleep until a task arrives or the next fiber wakes up.
+          waiting_ = true;
+          if (sleeping_.empty()) {
+            cv_.wait(lk, [this] { return closed_ || !inbox_.empty(); });
+          } else {
+            cv_.wait_until(lk, sleeping_.top().wakeTime,
+                           [this] { return !inbox_.empty(); });
+          }
+          waiting_ = false;
+          if (sleeping_.empty() && backlog.empty() && inbox_.empty()) {
+            return;  // closed and drained
+          }
+        }
+        backlog.insert(backlog.end(), inbox_.begin(), inbox_.end());
+        inbox_.clear();
+      }
+
+      // Start tasks while fibers are free.
+      while (!backlog.empty() && sleeping_.size() < maxFibers_) {
+        const Pending& pending = backlog.front();
+        if (start) { start(pending.value); }
+        Clock::time_point startTime = Clock::now();
+        uint64_t waitUsec = 0;
+        executor->beginTask(pending.task, &waitUsec);
+        if (begun) { begun(pending.value); }
+        if (waitUsec == 0) {
+          done(pending.value, elapsedUsec(startTime, Clock::now()),
+               executor->result());
+        } else {
+          // The executor is reused by the next task, so the fiber keeps a
+          // copy of the result.
+          sleeping_.push(Fiber{
+              pending.value, startTime,
+              Clock::now() + std::chrono::microseconds(waitUsec),
+              executor->result()});
+        }
+        backlog.pop_front();
+      }
+      peakFibers_ = std::max(peakFibers_, sleeping_.size());
+    }
+  }
+
+  // Most fibers that were waiting at once. Read after run() returns.
+  size_t peakFibers() const { return peakFibers_; }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Pending {
+    T value;
+    Task task;
+  };
+
+  struct Fiber {
+    T value;
+    Clock::time_point startTime;
+    Clock::time_point wakeTime;
+    std::vector<char> result;
+  };
+
+  // Orders the heap by the earliest wake-up time.
+  struct WakesLater {
+    bool operator()(const Fiber& a, const Fiber& b) const {
+      return a.wakeTime > b.wakeTime;
+    }
+  };
+
+  static uint64_t elapsedUsec(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+        .count();
+  }
+
+  const WorkloadConfig workload_;
+  const size_t maxFibers_;
+
+  std::mutex lock_;             // protects the fields below
+  std::condition_variable cv_;  // wakes up run()
+  std::vector<Pending> inbox_;  // submitted, not yet taken by run()
+  bool closed_;
+  bool waiting_;  // run() is parked on cv_
+
+  // Only touched by run().
+  std::priority_queue<Fiber, std::vector<Fiber>, WakesLater> sleeping_;
+  size_t peakFibers_;
+};
+
+#endif  // #ifndef FIBER_EXECUTOR_H
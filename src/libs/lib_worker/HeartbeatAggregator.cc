@@ -0,0 +1,82 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+#include "HeartbeatAggregator.h"
+#include "WorkerManager.h"
+
+void HeartbeatAggregator::start() {
+  thread_ = new std::thread(&HeartbeatAggregator::run, this);
+}
+
+void HeartbeatAggregator::stop() {
+  if (thread_ == nullptr) { return; }
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_->join();
+  delete thread_;
+  thread_ = nullptr;
+}
+
+void HeartbeatAggregator::add(DbosId workerId, int pkey) {
+  {
+    std::lock_guard<std::mutex> lk(lock_);
+    workers_[pkey].push_back(workerId);
+    changed_ = true;
+  }
+  // Beat now, so a worker that dies before the next interval is tracked.
+  cv_.notify_one();
+}
+
+void HeartbeatAggregator::remove(DbosId workerId, int pkey) {
+  std::lock_guard<std::mutex> lk(lock_);
+  auto it = workers_.find(pkey);
+  if (it == workers_.end()) { return; }
+  std::vector<int32_t>& ids = it->second;
+  ids.erase(std::remove(ids.begin(), ids.end(), workerId), ids.end());
+  if (ids.empty()) { workers_.erase(it); }
+}
+
+void HeartbeatAggregator::run() {
+  // Create a local VoltDB client.
+  voltdb::Client voltdbClient = WorkerManager::createVoltdbClient(dbAddr_);
+
+  std::vector<voltdb::Parameter> parameterTypes(2);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  voltdb::Procedure procedure("WorkerHeartbeat", parameterTypes);
+
+  std::map<int, std::vector<int32_t>> workers;
+  std::unique_lock<std::mutex> lk(lock_);
+  while (!stop_) {
+    // Copy the workers so add() and remove() do not wait for the DB.
+    workers = workers_;
+    changed_ = false;
+    lk.unlock();
+
+    for (auto& it : workers) {
+      voltdb::ParameterSet* params = procedure.params();
+      params->addInt32(it.first).addInt32(it.second);
+      voltdb::InvocationResponse r = voltdbClient.invoke(procedure);
+      if (r.failure()) {
+        std::cout << "WorkerHeartbeat procedure failed. " << r.toString()
+                  << std::endl;
+      }
+    }
+
+    lk.lock();
+    cv_.wait_for(lk, std::chrono::milliseconds(intervalMsec_),
+                 [this] { return stop_ || changed_; });
+  }
+}
@@ -0,0 +1,59 @@
+// This file contains a per-process aggregator of worker heartbeats.
+#ifndef DBOS_HEARTBEAT_AGGREGATOR_H
+#define DBOS_HEARTBEAT_AGGREGATOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DbosDefs.h"
+
+// Workers of a process add() themselves when they start serving. A thread
+// with its own VoltDB client refreshes the liveness of all of them every
+// intervalMsec, with one WorkerHeartbeat call per partition, however many
+// workers there are. A worker that stops beating, because it was removed or
+// its process died, is reaped by the LivenessDetector after its timeout.
+// add() and remove() are thread safe.
+class HeartbeatAggregator {
+public:
+  HeartbeatAggregator(std::string dbAddr, int intervalMsec)
+      : dbAddr_(dbAddr),
+        intervalMsec_(intervalMsec),
+        changed_(false),
+        stop_(false),
+        thread_(nullptr) {}
+
+  ~HeartbeatAggregator() { stop(); }
+
+  // Start the heartbeat thread.
+  void start();
+
+  // Stop the heartbeat thread.
+  void stop();
+
+  // Beat for a worker from now on. The first beat is sent right away.
+  void add(DbosId workerId, int pkey);
+
+  // Stop beating for a worker.
+  void remove(DbosId workerId, int pkey);
+
+private:
+  // Heartbeat thread main loop.
+  void run();
+
+  std::string dbAddr_;
+  int intervalMsec_;
+
+  std::mutex lock_;             // protects the fields below
+  std::condition_variable cv_;  // wakes the heartbeat thread up
+  std::map<int, std::vector<int32_t>> workers_;  // worker ids by partition
+  bool changed_;  // a worker was added since the last beat
+  bool stop_;
+  std::thread* thread_;
+};
+
+#endif  // #ifndef DBOS_HEARTBEAT_AGGREGATOR_H
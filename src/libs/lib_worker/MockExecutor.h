@@ -3,16 +3,18 @@
 
 #include "Executor.h"
 
+// Does nothing; the task takes no time.
 class MockExecutor : public Executor {
 public:
   MockExecutor() : Executor(){};
 
-  DbosStatus executeTask();
-
   ~MockExecutor(){
       /* placeholder for now. */
   };
 
+protected:
+  DbosStatus run(const Task& task) override;
+
 private:
 };
 
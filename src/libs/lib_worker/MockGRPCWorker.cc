@@ -14,8 +14,11 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BenchmarkUtil.h"
 #include "MockExecutor.h"
 #include "MockGRPCWorker.h"
+#include "SyntheticExecutor.h"
+#include "TaskProtobuf.h"
 
 namespace dbos_scheduler {
 
@@ -41,20 +44,255 @@ private:
 /*
  * Receive a submitted task from the client.
  */
-Status FrontendServiceImpl::SubmitTask(ServerContext* context,
+Status FrontendServiceImpl::SubmitTask(ServerContext* /*context*/,
                                        const SubmitTaskRequest* request,
                                        SubmitTaskResponse* reply) {
   // std::cout << "Received a task: " << request->requirement() << ", "
   //           << request->exectime() << "μs." << std::endl;
-  // TODO: Call executor_->executeTask here.
-  // executor_->executeTask();
-  usleep(request->exectime());
+  // Executors are per thread; the sync server runs handlers concurrently.
+  static thread_local SleepExecutor executor;
+  uint64_t serviceTimeUsec;
+  executor.executeTask(protobufToTask(request), &serviceTimeUsec);
+  WorkerManager::recordServiceTime(serviceTimeUsec);
   reply->set_status(DbosStatusEnum::SUCCESS);
   return Status::OK;
 }
 
 }  // namespace dbos_scheduler
 
+// A task taken by the timer wheel or the executors.
+class MockGRPCWorker::RunningTask {
+public:
+  virtual ~RunningTask() {}
+
+  // Tell the sender that the task finished. Can be called from any thread.
+  virtual void done() = 0;
+
+  // Hand the result blob of the task to the sender, before done(). Senders
+  // that cannot carry results drop it.
+  virtual void setResult(const std::vector<char>& /*result*/) {}
+
+  Task task;
+  uint64_t startUsec = 0;
+};
+
+// One SubmitTask call of the async server. As soon as a request arrives, the
+// call asks its completion queue for the next one, so every queue always has
+// a call waiting. Goes from kRequested to kRunning to kFinishing, then it is
+// deleted by the completion queue thread.
+class MockGRPCWorker::AsyncCall : public RunningTask {
+public:
+  AsyncCall(MockGRPCWorker* worker,
+            dbos_scheduler::Frontend::AsyncService* service,
+            grpc::ServerCompletionQueue* cq)
+      : worker_(worker),
+        service_(service),
+        cq_(cq),
+        responder_(&context_),
+        state_(kRequested) {
+    service_->RequestSubmitTask(&context_, &request_, &responder_, cq_, cq_,
+                                this);
+  }
+
+  // Handle an event of this call on its completion queue.
+  void proceed(bool ok) {
+    // Not ok: the server shut down before a request arrived.
+    if (!ok || state_ == kFinishing) {
+      delete this;
+      return;
+    }
+    new AsyncCall(worker_, service_, cq_);
+    state_ = kRunning;
+    task = protobufToTask(&request_);
+    worker_->startTask(this);
+  }
+
+  void setResult(const std::vector<char>& result) override {
+    reply_.set_result(result.data(), result.size());
+  }
+
+  // Send the reply.
+  void done() override {
+    state_ = kFinishing;
+    reply_.set_status(dbos_scheduler::DbosStatusEnum::SUCCESS);
+    responder_.Finish(reply_, Status::OK, this);
+  }
+
+private:
+  enum State { kRequested, kRunning, kFinishing };
+
+  MockGRPCWorker* worker_;
+  dbos_scheduler::Frontend::AsyncService* service_;
+  grpc::ServerCompletionQueue* cq_;
+  ServerContext context_;
+  dbos_scheduler::SubmitTaskRequest request_;
+  dbos_scheduler::SubmitTaskResponse reply_;
+  grpc::ServerAsyncResponseWriter<dbos_scheduler::SubmitTaskResponse>
+      responder_;
+  State state_;
+};
+
+// Worker side of one Dispatch stream. Finished tasks queue up here, and a
+// writer thread sends everything that queued up during its previous write as
+// one WorkerReport.
+class MockGRPCWorker::DispatchStream {
+public:
+  DispatchStream(MockGRPCWorker* worker,
+                 grpc::ServerReaderWriter<dbos_scheduler::WorkerReport,
+                                          dbos_scheduler::DispatchBatch>* stream)
+      : worker_(worker), stream_(stream), running_(0), closing_(false) {}
+
+  // A task of this stream started.
+  void start() {
+    std::lock_guard<std::mutex> lk(lock_);
+    running_++;
+  }
+
+  // A task of this stream finished, with its result blob, if any.
+  void complete(DbosId taskId, std::vector<char> result) {
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      running_--;
+      completed_.push_back(taskId);
+      results_.push_back(std::move(result));
+    }
+    cv_.notify_one();
+  }
+
+  // The scheduler is done sending. Report the tasks that are still running
+  // once they finish, then stop the writer.
+  void close() {
+    {
+      std::lock_guard<std::mutex> lk(lock_);
+      closing_ = true;
+    }
+    cv_.notify_one();
+  }
+
+  // Writer thread main loop.
+  void writeReports() {
+    std::vector<DbosId> batch;
+    std::vector<std::vector<char>> results;
+    std::unique_lock<std::mutex> lk(lock_);
+    while (true) {
+      cv_.wait(lk, [this] {
+        return !completed_.empty() || (closing_ && running_ == 0);
+      });
+      if (completed_.empty()) { break; }
+      batch.swap(completed_);
+      results.swap(results_);
+      lk.unlock();
+
+      dbos_scheduler::WorkerReport report;
+      report.set_workerid(worker_->workerId_);
+      for (DbosId taskId : batch) { report.add_completedtaskids(taskId); }
+      // One result per task, or none at all.
+      bool hasResults = false;
+      for (const std::vector<char>& result : results) {
+        hasResults = hasResults || !result.empty();
+      }
+      if (hasResults) {
+        for (const std::vector<char>& result : results) {
+          report.add_results(result.data(), result.size());
+        }
+      }
+      bool ok = stream_->Write(report);
+      batch.clear();
+      results.clear();
+
+      lk.lock();
+      // The stream is broken; drop the completions that are still to come.
+      if (!ok) { break; }
+    }
+  }
+
+private:
+  MockGRPCWorker* worker_;
+  grpc::ServerReaderWriter<dbos_scheduler::WorkerReport,
+                           dbos_scheduler::DispatchBatch>* stream_;
+  std::mutex lock_;             // protects the fields below
+  std::condition_variable cv_;  // wakes the writer up
+  std::vector<DbosId> completed_;
+  std::vector<std::vector<char>> results_;  // one per completed_
+  int running_;
+  bool closing_;
+};
+
+// A task that arrived on a Dispatch stream. Tasks keep their stream alive
+// until they finish, even if the stream handler returned, and the batch they
+// arrived in, which holds their payload.
+class MockGRPCWorker::StreamTask : public RunningTask {
+public:
+  StreamTask(std::shared_ptr<DispatchStream> stream,
+             std::shared_ptr<const dbos_scheduler::DispatchBatch> batch,
+             const dbos_scheduler::TaskAssignment& assignment)
+      : stream_(stream), batch_(batch), taskId_(assignment.taskid()) {
+    task.targetData = assignment.targetdata();
+    task.execTime = assignment.exectime();
+    task.type = assignment.type();
+    task.payload = assignment.payload().data();
+    task.payloadSize = assignment.payload().size();
+  }
+
+  void setResult(const std::vector<char>& result) override {
+    result_ = result;
+  }
+
+  void done() override {
+    stream_->complete(taskId_, std::move(result_));
+    delete this;
+  }
+
+private:
+  std::shared_ptr<DispatchStream> stream_;
+  std::shared_ptr<const dbos_scheduler::DispatchBatch> batch_;
+  DbosId taskId_;
+  std::vector<char> result_;
+};
+
+// Implement the Dispatch part of the Schedule service. The other RPCs of the
+// service are not implemented.
+class MockGRPCWorker::DispatchService final
+    : public dbos_scheduler::Schedule::Service {
+public:
+  explicit DispatchService(MockGRPCWorker* worker) : worker_(worker) {}
+
+private:
+  Status Dispatch(
+      ServerContext* context,
+      grpc::ServerReaderWriter<dbos_scheduler::WorkerReport,
+                               dbos_scheduler::DispatchBatch>* stream) override;
+
+  MockGRPCWorker* worker_;
+};
+
+/*
+ * Run the tasks of every DispatchBatch read from the stream until the
+ * scheduler closes it, and report them back as they finish.
+ */
+Status MockGRPCWorker::DispatchService::Dispatch(
+    ServerContext* /*context*/,
+    grpc::ServerReaderWriter<dbos_scheduler::WorkerReport,
+                             dbos_scheduler::DispatchBatch>* stream) {
+  std::shared_ptr<DispatchStream> dispatch(new DispatchStream(worker_, stream));
+  std::thread writer(&DispatchStream::writeReports, dispatch.get());
+  // Every batch is read into a new message that its tasks share, so their
+  // payloads are not copied out of it.
+  std::shared_ptr<dbos_scheduler::DispatchBatch> batch(
+      new dbos_scheduler::DispatchBatch);
+  while (stream->Read(batch.get())) {
+    for (const dbos_scheduler::TaskAssignment& assignment : batch->tasks()) {
+      StreamTask* task = new StreamTask(dispatch, batch, assignment);
+      dispatch->start();
+      worker_->startTask(task);
+    }
+    batch.reset(new dbos_scheduler::DispatchBatch);
+  }
+  dispatch->close();
+  writer.join();
+  return Status::OK;
+}
+
 /*
  * Actually start the gRPC server on a port number.
  */
@@ -62,6 +300,7 @@ void MockGRPCWorker::RunServer(const std::string& port) {
   std::string addr = "0.0.0.0:" + port;
 
   dbos_scheduler::FrontendServiceImpl service;
+  DispatchService dispatchService(this);
   ServerBuilder builder;
 
   // Listen on the given address without any authentication mechanism.
@@ -69,14 +308,125 @@ void MockGRPCWorker::RunServer(const std::string& port) {
   // Register "service" as the instance through which we'll communicate with
   // clients. In this case it corresponds to an *synchronous* service.
   builder.RegisterService(&service);
+  builder.RegisterService(&dispatchService);
   // Set max message size.
   builder.SetMaxMessageSize(INT32_MAX);
 
   // Finally, assemble the server.
-  workerServer_ = builder.BuildAndStart();
+  std::unique_ptr<Server> server = builder.BuildAndStart();
+  Server* started = server.get();
+  setServer(std::move(server));
   // Wait for the server to shutdown. Note that some other thread must be
   // responsible for shutting down the server for this call to ever return.
-  workerServer_->Wait();
+  started->Wait();
+}
+
+/*
+ * Start the async gRPC server and poll its completion queues until
+ * endServing() shuts them down.
+ */
+void MockGRPCWorker::RunAsyncServer(const std::string& port) {
+  std::string addr = "0.0.0.0:" + port;
+
+  dbos_scheduler::Frontend::AsyncService service;
+  DispatchService dispatchService(this);
+  ServerBuilder builder;
+  builder.AddListeningPort(addr, grpc::InsecureServerCredentials());
+  builder.RegisterService(&service);
+  builder.RegisterService(&dispatchService);
+  builder.SetMaxMessageSize(INT32_MAX);
+  for (int i = 0; i < options_.numCqThreads; ++i) {
+    cqs_.push_back(builder.AddCompletionQueue());
+  }
+
+  std::unique_ptr<Server> server = builder.BuildAndStart();
+  std::vector<std::thread> pollers;
+  for (auto& cq : cqs_) {
+    new AsyncCall(this, &service, cq.get());
+    pollers.emplace_back(&MockGRPCWorker::pollCompletionQueue, this, cq.get());
+  }
+  setServer(std::move(server));
+
+  for (std::thread& poller : pollers) { poller.join(); }
+}
+
+void MockGRPCWorker::setServer(std::unique_ptr<Server> server) {
+  {
+    std::lock_guard<std::mutex> lk(serverLock_);
+    workerServer_ = std::move(server);
+  }
+  serverCv_.notify_all();
+}
+
+void MockGRPCWorker::pollCompletionQueue(grpc::ServerCompletionQueue* cq) {
+  void* tag;
+  bool ok;
+  while (cq->Next(&tag, &ok)) { static_cast<AsyncCall*>(tag)->proceed(ok); }
+}
+
+void MockGRPCWorker::startRunner() {
+  if (options_.numExecutors > 0) {
+    readyTasks_.reset(new MPMCQueue<RunningTask*>(kReadyTasksSize));
+    for (int i = 0; i < options_.numExecutors; ++i) {
+      threads_.push_back(new std::thread(&MockGRPCWorker::execute, this));
+    }
+  } else {
+    timerWheel_.reset(new TimerWheel<RunningTask*>(
+        options_.tickUsec, kTimerWheelSlots, [this](RunningTask* const& task) {
+          WorkerManager::recordServiceTime(BenchmarkUtil::getCurrTimeUsec() -
+                                           task->startUsec);
+          finishTask(task);
+        }));
+    timerWheel_->start();
+  }
+}
+
+void MockGRPCWorker::stopRunner() {
+  // Let the tasks on the wheel finish; stopping drops them.
+  while (timerWheel_ != nullptr && timerWheel_->size() > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(options_.tickUsec));
+  }
+  if (readyTasks_ != nullptr) {
+    readyTasks_->close();
+    for (std::thread* thread : threads_) {
+      thread->join();
+      delete thread;
+    }
+    threads_.clear();
+  }
+  if (timerWheel_ != nullptr) { timerWheel_->stop(); }
+}
+
+void MockGRPCWorker::startTask(RunningTask* task) {
+  int inFlight = inFlight_.fetch_add(1) + 1;
+  int peak = peakInFlight_.load();
+  while (inFlight > peak &&
+         !peakInFlight_.compare_exchange_weak(peak, inFlight)) {}
+  task->startUsec = BenchmarkUtil::getCurrTimeUsec();
+  if (readyTasks_ != nullptr) {
+    readyTasks_->push(task);
+  } else {
+    timerWheel_->schedule(task, task->task.execTime > 0
+                                    ? task->task.execTime
+                                    : 0);
+  }
+}
+
+void MockGRPCWorker::execute() {
+  std::unique_ptr<Executor> executor(createExecutor(options_.workload));
+  RunningTask* task;
+  while (readyTasks_->popBatch(&task, 1) > 0) {
+    uint64_t serviceTimeUsec;
+    executor->executeTask(task->task, &serviceTimeUsec);
+    WorkerManager::recordServiceTime(serviceTimeUsec);
+    if (!executor->result().empty()) { task->setResult(executor->result()); }
+    finishTask(task);
+  }
+}
+
+void MockGRPCWorker::finishTask(RunningTask* task) {
+  inFlight_.fetch_sub(1);
+  task->done();
 }
 
 DbosStatus MockGRPCWorker::startServing() {
@@ -107,18 +457,44 @@ DbosStatus MockGRPCWorker::startServing() {
     }
   }
 
+  startRunner();
   const std::string& port = std::to_string(8000 + workerId_);
-  workerThread_ = new std::thread(&MockGRPCWorker::RunServer, this, port);
+  if (options_.numCqThreads > 0) {
+    workerThread_ =
+        new std::thread(&MockGRPCWorker::RunAsyncServer, this, port);
+  } else {
+    workerThread_ = new std::thread(&MockGRPCWorker::RunServer, this, port);
+  }
   workerAddr = "localhost:" + port;
-  while (workerServer_ == NULL) { ; }  // Spin until server is online.
+  {
+    // Wait until the server is online.
+    std::unique_lock<std::mutex> lk(serverLock_);
+    serverCv_.wait(lk, [this] { return workerServer_ != nullptr; });
+  }
+  if (options_.heartbeat != nullptr) {
+    options_.heartbeat->add(workerId_, workerId_ % workerPartitions_);
+  }
 
   return true;
 }
 
 DbosStatus MockGRPCWorker::endServing() {
-  // Clean up data and threads.
-  workerServer_->Shutdown();
+  // Clean up data and threads. Shutdown() stops taking new calls; calls and
+  // Dispatch streams that are still open after a grace period are cancelled.
+  // Tasks that are still running reply through their completion queue, so
+  // the runner stops before the queues shut down, and the pollers drain them.
+  if (options_.heartbeat != nullptr) {
+    options_.heartbeat->remove(workerId_, workerId_ % workerPartitions_);
+  }
+  workerServer_->Shutdown(std::chrono::system_clock::now() +
+                          std::chrono::milliseconds(kShutdownGraceMsec));
+  stopRunner();
+  for (auto& cq : cqs_) { cq->Shutdown(); }
   workerThread_->join();
   delete workerThread_;
+  if (peakInFlight_.load() > 0) {
+    std::cout << "Worker " << workerId_ << " peak in-flight tasks: "
+              << peakInFlight_.load() << std::endl;
+  }
   return true;
 }
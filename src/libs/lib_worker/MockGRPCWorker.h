@@ -3,19 +3,25 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "HeartbeatAggregator.h"
+#include "MPMCQueue.h"
 #include "MockExecutor.h"
+#include "SyntheticExecutor.h"
+#include "TimerWheel.h"
 #include "WorkerManager.h"
 #include "voltdb-client-cpp/include/Client.h"
 
 #include <grpcpp/grpcpp.h>
 
 #include "frontend.grpc.pb.h"
+#include "scheduler.grpc.pb.h"
 
 using grpc::Server;
 using grpc::ServerBuilder;
@@ -27,14 +33,38 @@ using grpc::Status;
 
 class MockGRPCWorker : public WorkerManager {
 public:
+  // How SubmitTask is served. The defaults run the sync server, where every
+  // in-flight task sleeps on one of its pool threads. Tasks that arrive on a
+  // Dispatch stream always run like those of the async server.
+  struct ServerOptions {
+    ServerOptions()
+        : numCqThreads(0), numExecutors(0), tickUsec(100), heartbeat(nullptr) {}
+
+    // If > 0, serve SubmitTask with the async API, one completion queue per
+    // thread. A task then holds no thread while it runs.
+    int numCqThreads;
+    // If > 0, run the workload of each async or streamed task on this many
+    // executor threads. Otherwise a timer wheel completes the task after its
+    // execution time, like a task that sleeps.
+    int numExecutors;
+    WorkloadConfig workload;
+    uint64_t tickUsec;  // timer wheel granularity
+    // If not null, every worker beats through this aggregator while serving.
+    HeartbeatAggregator* heartbeat;
+  };
+
   MockGRPCWorker(voltdb::Client* voltdbClient, int workerId,
                  int workerPartitions, int capacity,
-                 std::vector<int> workerData)
-      : client_(voltdbClient),
-        WorkerManager(workerId, "example"),
-        workerData_(workerData),
+                 std::vector<int> workerData,
+                 const ServerOptions& options = ServerOptions())
+      : WorkerManager(workerId, "example"),
+        client_(voltdbClient),
+        workerPartitions_(workerPartitions),
         capacity_(capacity),
-        workerPartitions_(workerPartitions){};
+        workerData_(workerData),
+        options_(options),
+        inFlight_(0),
+        peakInFlight_(0){};
 
   // Setup the worker.
   // E.g., setup dispatch thread, and multiple executor threads.
@@ -45,11 +75,41 @@ public:
 
   void RunServer(const std::string& port);
 
+  // Same as above, with the async API.
+  void RunAsyncServer(const std::string& port);
+
   // Destructor
   ~MockGRPCWorker() { /* placeholder for now. */
   }
 
 private:
+  class RunningTask;
+  class AsyncCall;
+  class DispatchStream;
+  class StreamTask;
+  class DispatchService;
+
+  // Poll a completion queue of the async server.
+  void pollCompletionQueue(grpc::ServerCompletionQueue* cq);
+
+  // Start the timer wheel or the executor threads.
+  void startRunner();
+
+  // Stop them once all tasks are done.
+  void stopRunner();
+
+  // Publish the server that RunServer() or RunAsyncServer() built.
+  void setServer(std::unique_ptr<Server> server);
+
+  // Run a task that just arrived on the timer wheel or the executors.
+  void startTask(RunningTask* task);
+
+  // Executor thread main loop.
+  void execute();
+
+  // Report a task that finished to whoever sent it.
+  void finishTask(RunningTask* task);
+
   voltdb::Client* client_;
   int workerPartitions_;
   int capacity_;
@@ -59,7 +119,19 @@ private:
       threads_;  // including dispatch and executor threads
   bool stopDispatch_ = false;
   std::thread* workerThread_;
+  std::mutex serverLock_;             // protects workerServer_
+  std::condition_variable serverCv_;  // signals that the server is up
   std::unique_ptr<Server> workerServer_ = NULL;
+  static const int kTimerWheelSlots = 4096;
+  static const int kReadyTasksSize = 65536;
+  static const int kShutdownGraceMsec = 1000;
+  ServerOptions options_;
+  std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs_;
+  // Run async and streamed tasks.
+  std::unique_ptr<TimerWheel<RunningTask*>> timerWheel_;
+  std::unique_ptr<MPMCQueue<RunningTask*>> readyTasks_;  // for the executors
+  std::atomic<int> inFlight_;  // tasks received and not yet finished
+  std::atomic<int> peakInFlight_;
 };
 
 #endif  // #ifndef MOCK_GRPC_WORKER_H
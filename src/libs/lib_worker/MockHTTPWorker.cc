@@ -3,7 +3,10 @@
 #define __STDC_LIMIT_MACROS
 
 #include <functional>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <thread>
+#include <unistd.h>
 #include <vector>
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ClientConfig.h"
@@ -14,13 +17,12 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
+#include "BenchmarkUtil.h"
 #include "MockHTTPWorker.h"
 
 #define HTTPSERVER_IMPL
 #include "httpserver.h"
 
-thread_local MockHTTPWorker* worker;
-
 DbosStatus MockHTTPWorker::startServing() {
   std::cout << "Setup worker " << workerId_ << std::endl;
 
@@ -43,8 +45,18 @@ DbosStatus MockHTTPWorker::startServing() {
     return false;
   }
 
-  // Start dispatch thread.
-  threads_.push_back(new std::thread(&MockHTTPWorker::dispatch, this));
+  aggregator_->start();
+  stopFd_ = eventfd(0, EFD_CLOEXEC);
+
+  // Start executors first, waiting for tasks.
+  for (int i = 0; i < numExecutors_; ++i) {
+    executors_.push_back(new std::thread(&MockHTTPWorker::execute, this, i));
+  }
+
+  // Start serving threads.
+  for (int i = 0; i < numThreads_; ++i) {
+    threads_.push_back(new std::thread(&MockHTTPWorker::dispatch, this, i));
+  }
   return true;
 }
 
@@ -52,54 +64,96 @@ DbosStatus MockHTTPWorker::endServing() {
   // Clean up data and threads.
   std::cout << "Stop worker " << workerId_ << std::endl;
   stopDispatch_ = true;
+  // Wake up all serving threads; nobody reads the counter, so it stays set.
+  uint64_t one = 1;
+  if (write(stopFd_, &one, sizeof(one)) != sizeof(one)) {
+    std::cout << "Failed to stop the serving threads of worker " << workerId_
+              << std::endl;
+  }
+  for (std::thread* thread : threads_) {
+    thread->join();
+    delete thread;
+  }
+  threads_.clear();
+  close(stopFd_);
+  stopFd_ = -1;
+
+  // Executors finish the queued tasks and exit.
+  taskQueue_.close();
+  for (std::thread* executor : executors_) {
+    executor->join();
+    delete executor;
+  }
+  executors_.clear();
+
+  // Report the completions that are still buffered.
+  aggregator_->stop();
   return true;
 }
 
 #define RESPONSE "Hello, World!"
 void MockHTTPWorker::handle_request(struct http_request_s* request) {
+  MockHTTPWorker* worker =
+      static_cast<MockHTTPWorker*>(http_request_server_userdata(request));
+
   struct http_string_s taskIdRaw = http_request_header(request, "taskID");
   std::string taskIdStr(taskIdRaw.buf, taskIdRaw.len);
   int taskId = std::stoi(taskIdStr);
 
-  struct http_response_s* response = http_response_init();
+  struct http_response_s* response = http_request_response_init(request);
   http_response_status(response, 200);
   http_response_header(response, "Content-Type", "text/plain");
   http_response_body(response, RESPONSE, sizeof(RESPONSE) - 1);
   http_respond(request, response);
 
-  // TODO Do some work or sleep here...
   WorkerManager::totalTasks_.fetch_add(1);
-
-  // Signal completion to the database.
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-
-  voltdb::Procedure procedure("WorkerUpdateTask", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
-  params->addInt32(worker->pkey_)
-      .addInt32(worker->workerId_)
-      .addInt32(taskId)
-      .addInt32(COMPLETE);
-  voltdb::InvocationResponse r = worker->client_->invoke(procedure);
-  if (r.failure()) {
-    std::cout << "WorkerUpdateTask procedure failed. " << r.toString();
-  }
+  // Spins if the queue is full; wakes a parked executor if there is one.
+  worker->taskQueue_.push(taskId);
 }
 
-void MockHTTPWorker::dispatch() {
-  // Store worker pointer to access it from the request handling function.
-  worker = this;
-
-  std::cout << "Listen for HTTP requests for worker " << workerId_ << "\n";
+void MockHTTPWorker::dispatch(int threadId) {
+  std::cout << "Listen for HTTP requests for worker " << workerId_
+            << " on thread " << threadId << "\n";
+  // Every thread binds the same port; httpserver.h sets SO_REUSEPORT on the
+  // listener.
   struct http_server_s* server =
       http_server_init(9090 + workerId_, handle_request);
+  http_server_set_userdata(server, this);
   http_server_listen_poll(server);
-  do { http_server_poll(server); } while (!stopDispatch_);
+
+  // Block on the server's event fd instead of spinning on http_server_poll();
+  // endServing() signals stopFd_ to end the wait.
+  struct pollfd pfds[2];
+  pfds[0].fd = http_server_loop(server);
+  pfds[0].events = POLLIN;
+  pfds[1].fd = stopFd_;
+  pfds[1].events = POLLIN;
+  while (!stopDispatch_) {
+    if (::poll(pfds, 2, -1) <= 0) { continue; }
+    if (pfds[0].revents & POLLIN) {
+      while (http_server_poll(server) > 0) {}
+    }
+  }
+  http_server_free(server);
 }
 
 void MockHTTPWorker::execute(int execId) {
-  // No-op for HTTP server.
+  if (!executorCores_.empty()) {
+    BenchmarkUtil::pinThreadToCore(
+        executorCores_[execId % executorCores_.size()]);
+  }
+  std::unique_ptr<Executor> executor(createExecutor(workload_));
+
+  // Take one task at a time, so a long task does not hold back others that
+  // an idle executor could run. Blocks while the queue is empty; returns 0
+  // once closed and drained.
+  DbosId taskId;
+  while (taskQueue_.popBatch(&taskId, 1) > 0) {
+    uint64_t serviceTimeUsec;
+    executor->executeTask(task_, &serviceTimeUsec);
+    WorkerManager::recordServiceTime(serviceTimeUsec);
+
+    // Signal completion to the database from the aggregator's thread.
+    aggregator_->add(taskId, executor->result());
+  }
 }
@@ -1,35 +1,60 @@
 #ifndef MOCK_HTTP_WORKER_H
 #define MOCK_HTTP_WORKER_H
 
+#include <algorithm>
 #include <atomic>
-#include <condition_variable>
-#include <mutex>
-#include <queue>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
-#include "MockExecutor.h"
+#include "CompletionAggregator.h"
+#include "MPMCQueue.h"
+#include "SyntheticExecutor.h"
 #include "WorkerManager.h"
 #include "httpserver.h"
 #include "voltdb-client-cpp/include/Client.h"
 
 class MockHTTPWorker : public WorkerManager {
 public:
+  // Handlers never call the DB: they answer, hand the completion to a
+  // CompletionAggregator and return, so a DB round trip does not stall the
+  // other connections. The aggregator flushes batches of up to
+  // completionBatch tasks; 0 flushes as soon as possible, batching whatever
+  // arrived during the previous flush.
+  // Handlers answer a request and queue its task for a pool of numExecutors
+  // executor threads, which run <workload>, so a long task does not stall the
+  // event loop. If executorCores is not empty, executor i is pinned to core
+  // executorCores[i % executorCores.size()].
+  // numThreads threads serve the worker's port, each with its own event loop
+  // on a SO_REUSEPORT listener, so the kernel spreads connections across
+  // them. Handlers queue tasks on a lock-free queue, so intake takes no lock
+  // shared by the serving threads.
   MockHTTPWorker(voltdb::Client* voltdbClient, int workerId, int pkey,
-                 std::string dbAddr)
-      : client_(voltdbClient), WorkerManager(workerId, dbAddr), pkey_(pkey) {
-    executor_ = new MockExecutor();
+                 std::string dbAddr, size_t completionBatch = 0,
+                 uint64_t completionDelayUsec = 1000,
+                 const WorkloadConfig& workload = WorkloadConfig(),
+                 int numExecutors = 1, int numThreads = 1,
+                 const std::vector<int>& executorCores = std::vector<int>())
+      : WorkerManager(workerId, dbAddr),
+        client_(voltdbClient),
+        workload_(workload),
+        task_(workload.task()),
+        numExecutors_(std::max(numExecutors, 1)),
+        numThreads_(std::max(numThreads, 1)),
+        executorCores_(executorCores),
+        pkey_(pkey),
+        taskQueue_(kTaskQueueSize) {
+    aggregator_ = new CompletionAggregator(
+        workerId, pkey, dbAddr, std::max(completionBatch, (size_t)1),
+        completionDelayUsec);
   };
 
-  // Dispatch tasks that are assigned to this worker.
-  // Potentially run in a dedicated dispatch thread.
-  void dispatch();
+  // Serve HTTP requests on one of the worker's threads.
+  void dispatch(int threadId);
   static void handle_request(struct http_request_s* request);
 
-  // Execute tasks. Potentially run in dedicated executor thread pool.
-  // Borrow ideas from:
-  // https://github.com/embeddedartistry/embedded-resources/blob/master/examples/cpp/dispatch.cpp
+  // Run the queued tasks on executor thread execId until the worker stops.
   void execute(int execId);
 
   // Setup the worker.
@@ -40,15 +65,26 @@ public:
   DbosStatus endServing();
 
   // Destructor
-  ~MockHTTPWorker() { delete executor_; }
+  ~MockHTTPWorker() { delete aggregator_; }
 
 private:
+  static const size_t kTaskQueueSize = 4096;
+
   voltdb::Client* client_;
-  MockExecutor* executor_;
+  WorkloadConfig workload_;
+  Task task_;  // what every request runs
+  int numExecutors_;
+  int numThreads_;
+  std::vector<int> executorCores_;
   int pkey_;
-  std::vector<std::thread*>
-      threads_;  // including dispatch and executor threads
-  bool stopDispatch_ = false;
+  CompletionAggregator* aggregator_;  // reports completions to the DB
+  std::vector<std::thread*> threads_;    // serving threads
+  std::vector<std::thread*> executors_;  // executor threads
+  std::atomic<bool> stopDispatch_{false};
+  int stopFd_ = -1;  // eventfd that wakes the serving threads up to stop
+  // Answered tasks waiting for an executor; closed once the serving threads
+  // stopped.
+  MPMCQueue<DbosId> taskQueue_;
 };
 
 #endif  // #ifndef MOCK_HTTP_WORKER_H
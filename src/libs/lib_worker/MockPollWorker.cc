@@ -2,6 +2,13 @@
 #define __STDC_CONSTANT_MACROS
 #define __STDC_LIMIT_MACROS
 
+#include <iterator>
+#include <memory>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ClientConfig.h"
@@ -12,148 +19,815 @@
 #include "voltdb-client-cpp/include/TableIterator.h"
 #include "voltdb-client-cpp/include/WireType.h"
 
-#include "MockExecutor.h"
+#include "BenchmarkUtil.h"
 #include "MockPollWorker.h"
 
+// Passed to std::max/min by reference.
+const int MockPollWorker::kMinReadyQueueSize;
+const int MockPollWorker::kMaxPopBatch;
+const int MockPollWorker::kLeaseRenewals;
+
+// Parameters of WorkerExchange: pkey, workerId, completed task ids, their
+// results, topk, wakeup url, lease.
+static std::vector<voltdb::Parameter> exchangeParameterTypes() {
+  std::vector<voltdb::Parameter> parameterTypes(7);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY, true);
+  parameterTypes[4] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[5] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
+  parameterTypes[6] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  return parameterTypes;
+}
+
 DbosStatus MockPollWorker::startServing() {
   std::cout << "Setup worker " << workerId_ << std::endl;
 
+  if (aggregator_ != nullptr) { aggregator_->start(); }
+  if (accounting_ != nullptr) { accounting_->start(); }
+
   // Start executors first, waiting for tasks.
-  for (int i = 0; i < numExecutors_; ++i) {
-    threads_.push_back(new std::thread(&MockPollWorker::execute, this, i));
+  drained_.reset(new Latch(1));
+  if (queueType_ == kFibers) {
+    threads_.push_back(
+        new std::thread(&MockPollWorker::executeFibers, this));
+  }
+  for (int i = 0; i < numExecutors_ && queueType_ != kFibers; ++i) {
+    if (queueType_ == kLockFreeQueue) {
+      threads_.push_back(
+          new std::thread(&MockPollWorker::executeLockFree, this, i));
+    } else if (queueType_ == kWorkStealing) {
+      threads_.push_back(
+          new std::thread(&MockPollWorker::executeStealing, this, i));
+    } else {
+      threads_.push_back(new std::thread(&MockPollWorker::execute, this, i));
+    }
+  }
+
+  if (!wakeupUrl_.empty()) {
+    stopFd_ = eventfd(0, EFD_CLOEXEC);
+    wakeupThread_ = new std::thread(&MockPollWorker::listenWakeup, this);
   }
 
   // Start dispatch thread
   threads_.push_back(new std::thread(&MockPollWorker::dispatch, this));
+  if (poll_.heartbeat != nullptr) { poll_.heartbeat->add(workerId_, pkey_); }
   return true;
 }
 
 DbosStatus MockPollWorker::endServing() {
   // Clean up data and threads.
   std::cout << "Stop worker " << workerId_ << std::endl;
-  stopDispatch_ = true;
+  uint64_t drainStart = BenchmarkUtil::getCurrTimeUsec();
+  if (poll_.heartbeat != nullptr) { poll_.heartbeat->remove(workerId_, pkey_); }
+  {
+    // Cut a backoff sleep short.
+    std::lock_guard<std::mutex> lock(wakeLock_);
+    stopDispatch_ = true;
+  }
+  wakeCv_.notify_all();
+  if (stopFd_ >= 0) {
+    uint64_t one = 1;
+    if (write(stopFd_, &one, sizeof(one)) != sizeof(one)) {
+      std::cout << "Failed to stop the wakeup listener of worker " << workerId_
+                << std::endl;
+    }
+  }
 
-  // Join dispatch thread first.
+  // Join dispatch thread first, so no more tasks are queued.
   size_t totalThreads = threads_.size();
   threads_[totalThreads - 1]->join();
   delete threads_[totalThreads - 1];
-
-  // Wait until the queue is empty
-  while (taskQueue_.size()) {
-    std::cout << "Waiting to drain task queue\n";
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  if (wakeupThread_ != nullptr) {
+    wakeupThread_->join();
+    delete wakeupThread_;
+    wakeupThread_ = nullptr;
+    close(stopFd_);
+    stopFd_ = -1;
   }
-  // Stop all executors.
-  {
-    std::lock_guard<std::mutex> lock(lock_);
-    stop_ = true;
+  std::cout << "Worker " << workerId_ << " fetched " << fetches_ << " times, "
+            << emptyFetches_ << " empty, woken up by " << wakeups_
+            << " pushes\n";
+  if (poll_.leaseMsec > 0) {
+    std::cout << "Worker " << workerId_ << " renewed its task leases "
+              << leaseRenewals_ << " times\n";
+  }
+  if (poll_.prefetchUsec > 0) {
+    std::cout << "Worker " << workerId_ << " prefetch: drain rate "
+              << drainRate_ * 1000 << " tasks/msec, fetch " << fetchUsec_
+              << " usec, " << prefetchWaits_
+              << " rounds waited with enough tasks queued\n";
   }
-  cv_.notify_all();
 
+  if (queueType_ == kLockFreeQueue) {
+    // Executors drain the queue and exit once it is closed and empty.
+    readyQueue_->close();
+  } else if (queueType_ == kFibers) {
+    // The fibers finish the tasks they hold and the queued ones.
+    fibers_->close();
+  } else if (queueType_ == kWorkStealing) {
+    // Executors drain all queues and exit.
+    {
+      std::lock_guard<std::mutex> lock(idleLock_);
+      stealingClosed_ = true;
+    }
+    idleCv_.notify_all();
+  } else {
+    // Executors drain the queue and exit once it is stopped and empty.
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  // Executors exit once they ran out of tasks.
   for (size_t i = 0; i < totalThreads - 1; ++i) {
     threads_[i]->join();
     delete threads_[i];
   }
+  if (queueType_ == kWorkStealing) {
+    std::cout << "Worker " << workerId_ << " executors stole " << steals_
+              << " tasks\n";
+  }
+  if (queueType_ == kFibers) {
+    std::cout << "Worker " << workerId_ << " ran up to "
+              << fibers_->peakFibers() << " tasks at once on fibers\n";
+  }
+
+  // Report the completions that are still buffered.
+  if (aggregator_ != nullptr) { aggregator_->stop(); }
+  if (accounting_ != nullptr) {
+    accounting_->stop();
+    accounting_->print(std::cout);
+  }
+  if (exchange_ && !completed_.empty()) {
+    voltdb::Client voltdbClient = WorkerManager::createVoltdbClient(dbAddr_);
+    voltdb::Procedure procedure("WorkerExchange", exchangeParameterTypes());
+    VoltdbResultDecoder decoder;
+    fetchTasks(&voltdbClient, &procedure, 0, &decoder);
+  }
+  drainUsec_ = BenchmarkUtil::getCurrTimeUsec() - drainStart;
+  std::cout << "Worker " << workerId_ << " drained in " << drainUsec_
+            << " usec\n";
+  drained_->countDown();
   return true;
 }
 
+bool MockPollWorker::FetchCallback::callback(
+    voltdb::InvocationResponse response) throw(voltdb::Exception) {
+  response_ = response;
+  done_ = true;
+  return true;  // break out of runOnce()
+}
+
+int MockPollWorker::fetchTasks(voltdb::Client* client,
+                               voltdb::Procedure* procedure, int topk,
+                               VoltdbResultDecoder* decoder) {
+  sendFetch(client, procedure, topk);
+  int numTasks = receiveFetch(client, decoder);
+  if (numTasks > 0) { queueFetched(decoder); }
+  return numTasks;
+}
+
+void MockPollWorker::sendFetch(voltdb::Client* client,
+                               voltdb::Procedure* procedure, int topk) {
+  voltdb::ParameterSet* params = procedure->params();
+  params->addInt32(pkey_).addInt32(workerId_);
+  if (exchange_) {
+    {
+      std::lock_guard<std::mutex> lock(completedLock_);
+      fetchDone_.swap(completed_);
+      fetchResults_.swap(completedResults_);
+    }
+    // One view per task into the results, or none at all. The parameters
+    // are serialized here, so the views need not outlive the call.
+    bool hasResults = false;
+    for (const std::vector<char>& result : fetchResults_) {
+      hasResults = hasResults || !result.empty();
+    }
+    std::vector<voltdb::buffer_t> resultViews;
+    if (hasResults) {
+      for (const std::vector<char>& result : fetchResults_) {
+        resultViews.push_back(voltdb::buffer_t(result.data(), result.size()));
+      }
+    }
+    params->addInt32(fetchDone_).addBytes(resultViews);
+  }
+  params->addInt32(topk);
+  // Do not park a worker that is shutting down.
+  params->addString(stopDispatch_ ? std::string() : wakeupUrl_);
+  params->addInt64(poll_.leaseMsec);
+
+  fetchName_ = procedure->getName();
+  fetchCallback_->done_ = false;
+  fetchInFlight_ = true;
+  fetchSentUsec_ = BenchmarkUtil::getCurrTimeUsec();
+  client->invoke(*procedure, fetchCallback_);
+}
+
+int MockPollWorker::receiveFetch(voltdb::Client* client,
+                                 VoltdbResultDecoder* decoder) {
+  while (!fetchCallback_->done_) { client->runOnce(); }
+  fetchInFlight_ = false;
+  std::vector<int32_t> done;
+  done.swap(fetchDone_);
+  std::vector<std::vector<char>> results;
+  results.swap(fetchResults_);
+  const voltdb::InvocationResponse& r = fetchCallback_->response_;
+  if (r.failure()) {
+    std::cout << fetchName_ << " procedure failed. " << r.toString()
+              << std::endl;
+    if (!done.empty()) {
+      // Report them with the next call.
+      std::lock_guard<std::mutex> lock(completedLock_);
+      completed_.insert(completed_.end(), done.begin(), done.end());
+      completedResults_.insert(completedResults_.end(),
+                               std::make_move_iterator(results.begin()),
+                               std::make_move_iterator(results.end()));
+    }
+    return -1;
+  }
+  WorkerManager::totalFinishedTasks_.fetch_add(done.size());
+  if (poll_.prefetchUsec > 0) {
+    const double kAlpha = 0.25;
+    double usec = BenchmarkUtil::getCurrTimeUsec() - fetchSentUsec_;
+    fetchUsec_ =
+        fetchUsec_ == 0 ? usec : kAlpha * usec + (1 - kAlpha) * fetchUsec_;
+  }
+
+  decoder->decode(r);
+  // std::cout << r.toString();
+  return decoder->rowCount();
+}
+
+void MockPollWorker::queueFetched(VoltdbResultDecoder* decoder) {
+  // Tasks with a payload point into the decoded table, which a batch takes
+  // over; the dispatcher holds a reference until all tasks are queued.
+  int32_t numTasks = decoder->rowCount();
+  PayloadBatch* batch = nullptr;
+  for (int32_t i = 0; i < numTasks; ++i) {
+    DispatchedTask task;
+    task.taskId = decoder->getInt64(i, 0);
+    task.type = 0;
+    task.payload = nullptr;
+    task.payloadSize = 0;
+    task.batch = nullptr;
+    if (decoder->columnCount() > 1) {
+      task.payload = decoder->getBytes(i, 1, &task.payloadSize);
+    }
+    if (decoder->columnCount() > 2) {
+      task.type = static_cast<int>(decoder->getInt64(i, 2));
+    }
+    if (task.payload != nullptr) {
+      if (batch == nullptr) { batch = new PayloadBatch; }
+      batch->refs.fetch_add(1, std::memory_order_relaxed);
+      task.batch = batch;
+    }
+    enqueue(task);
+    WorkerManager::totalTasks_.fetch_add(1);
+    // std::cout << "dispatch taskId " << task.taskId << "\n";
+  }
+  if (batch != nullptr) {
+    // Holding the table keeps the payload views valid.
+    decoder->takeTable(&batch->table);
+    releasePayload(batch);
+  }
+}
+
+void MockPollWorker::renewLeases(voltdb::Client* client,
+                                 voltdb::Procedure* procedure) {
+  voltdb::ParameterSet* params = procedure->params();
+  params->addInt32(pkey_).addInt32(workerId_).addInt64(poll_.leaseMsec);
+  voltdb::InvocationResponse r = client->invoke(*procedure);
+  if (r.failure()) {
+    std::cout << "RenewTaskLeases procedure failed. " << r.toString()
+              << std::endl;
+    return;
+  }
+  leaseRenewals_++;
+}
+
+bool MockPollWorker::idleWait(uint64_t waitUsec) {
+  std::unique_lock<std::mutex> lock(wakeLock_);
+  wakeCv_.wait_for(lock, std::chrono::microseconds(waitUsec),
+                   [this] { return wakeup_ || stopDispatch_; });
+  // A push that arrived while we were fetching ends the next sleep at once.
+  bool woken = wakeup_;
+  wakeup_ = false;
+  return woken;
+}
+
+void MockPollWorker::handleWakeup(struct http_request_s* request) {
+  MockPollWorker* self =
+      static_cast<MockPollWorker*>(http_request_server_userdata(request));
+  struct http_response_s* response = http_request_response_init(request);
+  http_response_status(response, 200);
+  http_respond(request, response);
+
+  {
+    std::lock_guard<std::mutex> lock(self->wakeLock_);
+    self->wakeup_ = true;
+  }
+  self->wakeCv_.notify_one();
+}
+
+void MockPollWorker::listenWakeup() {
+  int port = poll_.wakeupPort + workerId_;
+  std::cout << "Listen for wakeups for worker " << workerId_ << " on port "
+            << port << "\n";
+  struct http_server_s* server = http_server_init(port, handleWakeup);
+  http_server_set_userdata(server, this);
+  http_server_listen_poll(server);
+
+  // Block on the server's event fd instead of spinning on http_server_poll();
+  // endServing() signals stopFd_ to end the wait.
+  struct pollfd pfds[2];
+  pfds[0].fd = http_server_loop(server);
+  pfds[0].events = POLLIN;
+  pfds[1].fd = stopFd_;
+  pfds[1].events = POLLIN;
+  while (!stopDispatch_) {
+    if (::poll(pfds, 2, -1) <= 0) { continue; }
+    if (pfds[0].revents & POLLIN) {
+      while (http_server_poll(server) > 0) {}
+    }
+  }
+  http_server_free(server);
+}
+
 void MockPollWorker::dispatch() {
   std::cout << "A dispatcher for worker " << workerId_ << "\n";
   // Create a local VoltDB client.
   voltdb::Client voltdbClient = WorkerManager::createVoltdbClient(dbAddr_);
 
-  std::vector<voltdb::Parameter> parameterTypes(3);
+  std::vector<voltdb::Parameter> parameterTypes(5);
   parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
   parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  voltdb::Procedure procedure("WorkerSelectTask", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
+  parameterTypes[4] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  if (exchange_) { parameterTypes = exchangeParameterTypes(); }
+  voltdb::Procedure procedure(exchange_ ? "WorkerExchange" : "WorkerSelectTask",
+                              parameterTypes);
+  std::vector<voltdb::Parameter> renewParameterTypes(3);
+  renewParameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  renewParameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  renewParameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  voltdb::Procedure renewProcedure("RenewTaskLeases", renewParameterTypes);
+  uint64_t renewIntervalUsec = poll_.leaseMsec * 1000ULL / kLeaseRenewals;
+  uint64_t nextRenewUsec = BenchmarkUtil::getCurrTimeUsec() + renewIntervalUsec;
+  VoltdbResultDecoder decoder;
+  int topk = topk_;
+  uint64_t backoffUsec = poll_.minBackoffUsec;
   do {
-    DbosId taskId = -1;
-    // Select top-k task(s) from DB.
-    params->addInt32(pkey_).addInt32(workerId_).addInt32(topk_);
+    if (poll_.leaseMsec > 0) {
+      // Renew before the tasks we hold get close to their deadline.
+      uint64_t now = BenchmarkUtil::getCurrTimeUsec();
+      if (now >= nextRenewUsec) {
+        renewLeases(&voltdbClient, &renewProcedure);
+        nextRenewUsec = now + renewIntervalUsec;
+      }
+    }
 
-    voltdb::InvocationResponse r = voltdbClient.invoke(procedure);
-    if (r.failure()) {
-      std::cout << "WorkerSelecTask procedure failed. " << r.toString()
-                << std::endl;
+    // Select top-k task(s) from DB.
+    int fetched;
+    if (poll_.prefetchUsec > 0) {
+      uint64_t waitUsec = 0;
+      if (!fetchInFlight_) {
+        topk = prefetchSize(0, &waitUsec);
+        if (topk == 0) {
+          // The executors have enough queued; fetch when it runs low.
+          prefetchWaits_++;
+          idleWait(waitUsec);
+          continue;
+        }
+        sendFetch(&voltdbClient, &procedure, topk);
+      }
+      fetched = receiveFetch(&voltdbClient, &decoder);
+      fetches_++;
+      if (fetched > 0) {
+        // Send the next fetch before queueing these tasks, so the round trip
+        // overlaps the queueing.
+        int nextTopk = prefetchSize(fetched, &waitUsec);
+        if (nextTopk > 0 && !stopDispatch_) {
+          sendFetch(&voltdbClient, &procedure, nextTopk);
+        }
+        queueFetched(&decoder);
+      }
+    } else {
+      fetched = fetchTasks(&voltdbClient, &procedure, topk, &decoder);
+      fetches_++;
+    }
+    if (fetched > 0) {
+      backoffUsec = poll_.minBackoffUsec;
+      // A full batch means more tasks are queued for us in the DB, so take
+      // more per round trip; shrink back once the queue runs low. Prefetch
+      // sizes fetches itself.
+      if (poll_.maxTopk > topk_ && poll_.prefetchUsec == 0) {
+        if (fetched == topk) {
+          topk = std::min(topk * 2, poll_.maxTopk);
+        } else if (fetched < topk / 2) {
+          topk = std::max(topk / 2, topk_);
+        }
+      }
       continue;
     }
-    voltdb::Table results = r.results()[0];
-    voltdb::TableIterator resIter = results.iterator();
-    // std::cout << r.toString();
-    while (resIter.hasNext()) {
-      voltdb::Row row = resIter.next();
-      taskId = row.getInt32(0);
+    emptyFetches_++;
+    if (poll_.maxBackoffUsec == 0) { continue; }  // Busy polling.
 
-      {
-        std::lock_guard<std::mutex> lock(lock_);
-        taskQueue_.push(taskId);
-      }
-      cv_.notify_one();
-      WorkerManager::totalTasks_.fetch_add(1);
-      // std::cout << "dispatch taskId " << taskId << "\n";
+    // Nothing to do: back off exponentially, unless woken up by a push.
+    uint64_t waitUsec = backoffUsec;
+    if (exchange_) {
+      // Finished tasks are only reported with the next fetch.
+      std::lock_guard<std::mutex> lock(completedLock_);
+      if (!completed_.empty()) { waitUsec = poll_.minBackoffUsec; }
+    }
+    if (poll_.leaseMsec > 0) {
+      // Do not sleep past the next renewal.
+      uint64_t now = BenchmarkUtil::getCurrTimeUsec();
+      waitUsec = std::min(waitUsec,
+                          nextRenewUsec > now ? nextRenewUsec - now : 0);
+    }
+    if (idleWait(waitUsec)) {
+      wakeups_++;
+      backoffUsec = poll_.minBackoffUsec;
+    } else {
+      backoffUsec = std::min(std::max(backoffUsec * 2, (uint64_t)1),
+                             poll_.maxBackoffUsec);
     }
-    // Busy polling or sleep?
-    // std::this_thread::sleep_for(std::chrono::microseconds(10 * topk_));
   } while (!stopDispatch_);
+  if (fetchInFlight_) {
+    // Its tasks already left the DB queue.
+    if (receiveFetch(&voltdbClient, &decoder) > 0) { queueFetched(&decoder); }
+    fetches_++;
+  }
   std::cout << "Stopped dispatcher for worker " << workerId_ << "\n";
 }
 
+void MockPollWorker::enqueue(DispatchedTask task) {
+  enqueued_++;
+  task.dispatchTimeUsec = BenchmarkUtil::getCurrTimeUsec();
+  if (queueType_ == kLockFreeQueue) {
+    // Spins if the queue is full; wakes a parked executor if there is one.
+    readyQueue_->push(task);
+    return;
+  }
+  if (queueType_ == kFibers) {
+    Task workloadTask = workload_.task();
+    if (task.type > 0) { workloadTask.type = task.type; }
+    if (task.payload != nullptr) {
+      workloadTask.payload = task.payload;
+      workloadTask.payloadSize = task.payloadSize;
+    }
+    fibers_->submit(task, workloadTask);
+    return;
+  }
+  if (queueType_ == kWorkStealing) {
+    // Round-robin over the executor queues, skipping full ones.
+    size_t n = localQueues_.size();
+    while (!localQueues_[nextLocalQueue_++ % n]->tryPush(task)) {
+      if (nextLocalQueue_ % n == 0) { std::this_thread::yield(); }
+    }
+    // Pairs with the fetch_add in waitForWork(): either the executor sees
+    // the task or we see it parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idleExecutors_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(idleLock_);
+      idleCv_.notify_one();
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    taskQueue_.push(task);
+  }
+  cv_.notify_one();
+}
+
+void MockPollWorker::runTask(Executor* executor, const Task& workloadTask,
+                             const DispatchedTask& task) {
+  TaskAccounting::Clock start = TaskAccounting::Clock();
+  if (accounting_ != nullptr) { start = TaskAccounting::Clock::now(); }
+  uint64_t queueUsec =
+      BenchmarkUtil::getCurrTimeUsec() - task.dispatchTimeUsec;
+  WorkerManager::recordDispatchLatency(queueUsec);
+  started_.fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t serviceTimeUsec;
+  if (task.payload == nullptr && task.type <= 0) {
+    executor->executeTask(workloadTask, &serviceTimeUsec);
+  } else {
+    Task dbTask = workloadTask;
+    if (task.type > 0) { dbTask.type = task.type; }
+    if (task.payload != nullptr) {
+      dbTask.payload = task.payload;
+      dbTask.payloadSize = task.payloadSize;
+    }
+    executor->executeTask(dbTask, &serviceTimeUsec);
+    if (task.batch != nullptr) { releasePayload(task.batch); }
+  }
+  WorkerManager::recordServiceTime(serviceTimeUsec);
+  if (accounting_ != nullptr) {
+    accounting_->record(task.taskId, queueUsec, start,
+                        TaskAccounting::Clock::now());
+  }
+}
+
+void MockPollWorker::releasePayload(PayloadBatch* batch) {
+  if (batch->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete batch;
+  }
+}
+
+int MockPollWorker::prefetchSize(int incoming, uint64_t* waitUsec) {
+  const double kAlpha = 0.25;  // weight of the newest rate sample
+  const uint64_t kMinSampleUsec = 1000;
+  uint64_t now = BenchmarkUtil::getCurrTimeUsec();
+  uint64_t started = started_.load(std::memory_order_relaxed);
+  if (lastSampleUsec_ == 0) {
+    lastSampleUsec_ = now;
+    lastStarted_ = started;
+  } else if (now - lastSampleUsec_ >= kMinSampleUsec) {
+    double rate = (double)(started - lastStarted_) / (now - lastSampleUsec_);
+    drainRate_ = drainRate_ == 0 ? rate
+                                 : kAlpha * rate + (1 - kAlpha) * drainRate_;
+    lastSampleUsec_ = now;
+    lastStarted_ = started;
+  }
+
+  // Tasks the executors take while the next fetch is in flight, and then
+  // while the prefetch horizon passes. Until there is a rate, assume they
+  // take topk, so an idle start does not fill the queue.
+  uint64_t queued = enqueued_ + incoming;
+  queued = queued > started ? queued - started : 0;
+  double horizonUsec = fetchUsec_ + poll_.prefetchUsec;
+  double needed = drainRate_ > 0 ? drainRate_ * horizonUsec : topk_;
+  if (queued >= needed) {
+    // Come back when the queue is down to what one horizon drains, or when
+    // the next rate sample is due.
+    *waitUsec = drainRate_ > 0
+                    ? (uint64_t)((queued - needed) / drainRate_) + 1
+                    : kMinSampleUsec;
+    *waitUsec = std::min(*waitUsec, poll_.prefetchUsec);
+    return 0;
+  }
+  // Fetch enough for two horizons: one to drain while the next fetch runs.
+  // Never queue more than two full fetches.
+  int maxTopk = std::max(topk_, poll_.maxTopk);
+  double want = std::min(2 * needed, 2.0 * maxTopk) - queued;
+  return want >= maxTopk ? maxTopk : std::max(topk_, (int)want + 1);
+}
+
+void MockPollWorker::reportTask(Reporter* reporter, DbosId taskId,
+                                const std::vector<char>& result) {
+  if (aggregator_ != nullptr) {
+    aggregator_->add(taskId, result);
+    return;
+  }
+  if (exchange_) {
+    // The dispatcher reports it with its next WorkerExchange call.
+    std::lock_guard<std::mutex> lock(completedLock_);
+    completed_.push_back(taskId);
+    completedResults_.push_back(result);
+    return;
+  }
+  if (reporter->client == nullptr) {
+    reporter->client.reset(
+        new voltdb::Client(WorkerManager::createVoltdbClient(dbAddr_)));
+    std::vector<voltdb::Parameter> parameterTypes(5);
+    parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+    parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+    parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+    parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+    parameterTypes[4] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY);
+    reporter->procedure.reset(
+        new voltdb::Procedure("WorkerUpdateTask", parameterTypes));
+  }
+
+  // Update task as completed from DB, and put back one capacity. A failed
+  // update is retried with a growing backoff, like a failed batch of the
+  // aggregator. If it keeps failing the task stays running, and is requeued
+  // once its lease expires.
+  for (int retries = 0;; ++retries) {
+    voltdb::ParameterSet* params = reporter->procedure->params();
+    params->addInt32(pkey_).addInt32(workerId_).addInt32(taskId).addInt32(
+        COMPLETE);
+    if (result.empty()) {
+      params->addNull();
+    } else {
+      params->addBytes(result.size(), (const uint8_t*)result.data());
+    }
+
+    voltdb::InvocationResponse r =
+        reporter->client->invoke(*reporter->procedure);
+    if (r.success()) { break; }
+    std::cout << "WorkerUpdateTask procedure failed. " << r.toString()
+              << std::endl;
+    if (retries == kMaxReportRetries) {
+      std::cout << "Dropped the completion of task " << taskId << " after "
+                << kMaxReportRetries << " retries" << std::endl;
+      return;
+    }
+    usleep(kReportRetryUsec << retries);
+  }
+  WorkerManager::totalFinishedTasks_.fetch_add(1);
+}
+
 void MockPollWorker::execute(int execId) {
   std::cout << "Executor " << execId << " for worker " << workerId_ << "\n";
-  MockExecutor executor = MockExecutor();
-
-  // Create a local VoltDB client.
-  voltdb::Client voltdbClient = WorkerManager::createVoltdbClient(dbAddr_);
+  pinExecutor(execId);
+  std::unique_ptr<Executor> executor(createExecutor(workload_));
+  const Task workloadTask = workload_.task();
 
-  std::vector<voltdb::Parameter> parameterTypes(4);
-  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
-  voltdb::Procedure procedure("WorkerUpdateTask", parameterTypes);
-  voltdb::ParameterSet* params = procedure.params();
+  // Connects on the first task reported with WorkerUpdateTask.
+  Reporter reporter;
 
   std::unique_lock<std::mutex> lock(lock_);
 
   // Wait for tasks
-  do {
+  while (true) {
     // Wait until we have a task, or stop signal.
     cv_.wait(lock, [this] { return (taskQueue_.size() || stop_); });
+    // Once stopped, finish the queued tasks before leaving.
+    if (taskQueue_.empty()) { break; }
 
     // Get one task
-    if (!stop_ && taskQueue_.size()) {
-      DbosId taskId = taskQueue_.front();
-      taskQueue_.pop();
-
-      // unlock the lock.
-      lock.unlock();
-
-      // std::cout << "worker " << workerId_ << " executor " << execId
-      //          << " process taskId " << taskId << std::endl;
-
-      // TODO: add parameter to mock execution time.
-      // Maybe move this whole function to the Executor class.
-      executor.executeTask();
-
-      // std::this_thread::sleep_for(std::chrono::microseconds(100));
-      // Update task as completed from DB, and put back one capacity.
-      params->addInt32(pkey_).addInt32(workerId_).addInt32(taskId).addInt32(
-          COMPLETE);
-
-      voltdb::InvocationResponse r = voltdbClient.invoke(procedure);
-      if (r.failure()) {
-        std::cout << "WorkerUpdateTask procedure failed. " << r.toString()
-                  << std::endl;
-        abort();  // TODO: better error handling.
-      }
+    DispatchedTask task = taskQueue_.front();
+    taskQueue_.pop();
+
+    // unlock the lock.
+    lock.unlock();
+    // std::cout << "worker " << workerId_ << " executor " << execId
+    //          << " process taskId " << taskId << std::endl;
+
+    runTask(executor.get(), workloadTask, task);
+
+    // std::this_thread::sleep_for(std::chrono::microseconds(100));
+    reportTask(&reporter, task.taskId, executor->result());
+
+    // Re-acquire the lock.
+    lock.lock();
+  }
+  lock.unlock();
+  std::cout << "Stopped executor " << execId << " for worker " << workerId_
+            << "\n";
+}
+
+void MockPollWorker::executeLockFree(int execId) {
+  std::cout << "Executor " << execId << " for worker " << workerId_
+            << " (lock-free queue)\n";
+  pinExecutor(execId);
+  std::unique_ptr<Executor> executor(createExecutor(workload_));
+  const Task workloadTask = workload_.task();
+
+  // Connects on the first task reported with WorkerUpdateTask.
+  Reporter reporter;
 
-      WorkerManager::totalFinishedTasks_.fetch_add(1);
-      // Re-acquire the lock.
-      lock.lock();
+  std::vector<DispatchedTask> batch(popBatch_);
+  // Blocks while the queue is empty; returns 0 once closed and drained.
+  size_t numTasks;
+  while ((numTasks = readyQueue_->popBatch(batch.data(), popBatch_)) > 0) {
+    for (size_t i = 0; i < numTasks; ++i) {
+      // Later tasks of a batch start after the earlier ones finish.
+      runTask(executor.get(), workloadTask, batch[i]);
+      reportTask(&reporter, batch[i].taskId, executor->result());
     }
-  } while (!stop_);
+  }
   std::cout << "Stopped executor " << execId << " for worker " << workerId_
             << "\n";
 }
+
+void MockPollWorker::pinExecutor(int execId) {
+  if (executorCores_.empty()) { return; }
+  int core = executorCores_[execId % executorCores_.size()];
+  if (BenchmarkUtil::pinThreadToCore(core)) {
+    std::cout << "Pinned executor " << execId << " of worker " << workerId_
+              << " to core " << core << "\n";
+  }
+}
+
+size_t MockPollWorker::steal(int execId, DispatchedTask* out) {
+  // Visit peers starting from the next one, so thieves spread out.
+  size_t n = localQueues_.size();
+  for (size_t i = 1; i < n; ++i) {
+    MPMCQueue<DispatchedTask>* victim = localQueues_[(execId + i) % n].get();
+    // Take up to half of the victim's backlog.
+    size_t want = std::min((size_t)kMaxPopBatch,
+                           std::max((size_t)1, victim->size() / 2));
+    size_t got = victim->tryPopBatch(out, want);
+    if (got > 0) {
+      steals_.fetch_add(got, std::memory_order_relaxed);
+      return got;
+    }
+  }
+  return 0;
+}
+
+bool MockPollWorker::waitForWork() {
+  auto queued = [this] {
+    for (auto& queue : localQueues_) {
+      if (!queue->empty()) { return true; }
+    }
+    return false;
+  };
+  std::unique_lock<std::mutex> lock(idleLock_);
+  // Announce before re-checking, so a concurrent enqueue sees a sleeper.
+  idleExecutors_.fetch_add(1, std::memory_order_seq_cst);
+  idleCv_.wait(lock, [&] { return stealingClosed_ || queued(); });
+  idleExecutors_.fetch_sub(1, std::memory_order_relaxed);
+  return !stealingClosed_ || queued();
+}
+
+void MockPollWorker::executeStealing(int execId) {
+  std::cout << "Executor " << execId << " for worker " << workerId_
+            << " (work stealing)\n";
+  pinExecutor(execId);
+  std::unique_ptr<Executor> executor(createExecutor(workload_));
+  const Task workloadTask = workload_.task();
+
+  // Connects on the first task reported with WorkerUpdateTask.
+  Reporter reporter;
+
+  MPMCQueue<DispatchedTask>* own = localQueues_[execId].get();
+  std::vector<DispatchedTask> stolen(kMaxPopBatch);
+  while (true) {
+    // Take one task at a time from our own queue, so the rest stays
+    // stealable while we run it.
+    DispatchedTask task;
+    if (!own->tryPop(task)) {
+      size_t n = steal(execId, stolen.data());
+      if (n == 0) {
+        if (!waitForWork()) { break; }
+        continue;
+      }
+      // Run the first stolen task; queue the others where peers can steal
+      // them back. Run them right away if our queue is full.
+      task = stolen[0];
+      for (size_t i = 1; i < n; ++i) {
+        if (!own->tryPush(stolen[i])) {
+          runTask(executor.get(), workloadTask, stolen[i]);
+          reportTask(&reporter, stolen[i].taskId, executor->result());
+        }
+      }
+    }
+    runTask(executor.get(), workloadTask, task);
+    reportTask(&reporter, task.taskId, executor->result());
+  }
+  std::cout << "Stopped executor " << execId << " for worker " << workerId_
+            << "\n";
+}
+
+void MockPollWorker::executeFibers() {
+  std::cout << "Fiber executor for worker " << workerId_ << " ("
+            << numExecutors_ << " fibers)\n";
+  pinExecutor(0);
+
+  // Connects on the first task reported with WorkerUpdateTask.
+  Reporter reporter;
+
+  // With accounting, the Clock readings before and after the CPU part of each
+  // running task. The fibers share this thread, so the CPU time and context
+  // switches of a task are only those of its CPU part; the wall time is its
+  // service time.
+  std::unordered_map<DbosId,
+                     std::pair<TaskAccounting::Clock, TaskAccounting::Clock>>
+      clocks;
+
+  // Fibers report back when they start, for prefetch, and when they finish;
+  // the task started serviceTime earlier.
+  auto done = [&](const DispatchedTask& task, uint64_t serviceTimeUsec,
+                  const std::vector<char>& result) {
+    uint64_t startUsec = BenchmarkUtil::getCurrTimeUsec() - serviceTimeUsec;
+    uint64_t queueUsec = 0;
+    if (startUsec > task.dispatchTimeUsec) {
+      queueUsec = startUsec - task.dispatchTimeUsec;
+      WorkerManager::recordDispatchLatency(queueUsec);
+    }
+    WorkerManager::recordServiceTime(serviceTimeUsec);
+    auto got = clocks.find(task.taskId);
+    if (got != clocks.end()) {
+      TaskAccounting::Clock end = got->second.second;
+      end.wallUsec = got->second.first.wallUsec + serviceTimeUsec;
+      accounting_->record(task.taskId, queueUsec, got->second.first, end);
+      clocks.erase(got);
+    }
+    if (task.batch != nullptr) { releasePayload(task.batch); }
+    // Without a completion batch or exchange, this call blocks all fibers.
+    reportTask(&reporter, task.taskId, result);
+  };
+  auto start = [&](const DispatchedTask& task) {
+    started_.fetch_add(1, std::memory_order_relaxed);
+    if (accounting_ != nullptr) {
+      clocks[task.taskId].first = TaskAccounting::Clock::now();
+    }
+  };
+  auto begun = [&](const DispatchedTask& task) {
+    if (accounting_ != nullptr) {
+      clocks[task.taskId].second = TaskAccounting::Clock::now();
+    }
+  };
+  fibers_->run(done, start, begun);
+  std::cout << "Stopped fiber executor for worker " << workerId_ << "\n";
+}
@@ -1,25 +1,151 @@
 #ifndef MOCK_POLL_WORKER_H
 #define MOCK_POLL_WORKER_H
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "CompletionAggregator.h"
+#include "FiberExecutor.h"
+#include "HeartbeatAggregator.h"
+#include "Latch.h"
+#include "MPMCQueue.h"
+#include "TaskAccounting.h"
+#include "SyntheticExecutor.h"
+#include "VoltdbResultDecoder.h"
 #include "WorkerManager.h"
+#include "httpserver.h"
 #include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/ProcedureCallback.hpp"
 
 class MockPollWorker : public WorkerManager {
 public:
+  // How the dispatcher hands tasks to executors.
+  enum QueueType {
+    kMutexQueue,    // std::queue guarded by a mutex and condition variable
+    kLockFreeQueue,  // bounded lock-free MPMC ring buffer with batch pops
+    kWorkStealing,   // a lock-free queue per executor, idle executors steal
+    kFibers          // one thread runs up to numExecutors tasks as fibers
+  };
+
+  // How the dispatcher polls the DB. The defaults poll back to back with a
+  // fixed top-k, as if the options did not exist.
+  struct PollOptions {
+    PollOptions()
+        : minBackoffUsec(10),
+          maxBackoffUsec(0),
+          maxTopk(0),
+          wakeupPort(0),
+          heartbeat(nullptr),
+          leaseMsec(0),
+          prefetchUsec(0),
+          accountTasks(false),
+          usageBatch(0) {}
+
+    // After an empty fetch, sleep minBackoffUsec and double the sleep after
+    // every further empty fetch, up to maxBackoffUsec. 0 means busy polling.
+    uint64_t minBackoffUsec;
+    uint64_t maxBackoffUsec;
+    // Double the top-k while fetches return full batches, up to maxTopk, and
+    // halve it again when they return less than half. 0 keeps it fixed.
+    int maxTopk;
+    // If > 0, listen on wakeupPort + workerId. An empty fetch parks the worker
+    // in IdleWorker, and the next task queued for it is pushed through the
+    // TaskAssign export stream and ends the backoff sleep right away.
+    int wakeupPort;
+    // If not null, beat through this aggregator while serving, so the
+    // LivenessDetector requeues the tasks of the worker if it dies.
+    HeartbeatAggregator* heartbeat;
+    // If > 0, fetched tasks are leased for leaseMsec. The dispatcher renews
+    // the leases of all tasks the worker holds every leaseMsec /
+    // kLeaseRenewals, so they expire and get requeued only if it stops.
+    int leaseMsec;
+    // If > 0, fetch ahead of the executors instead of back to back. The
+    // dispatcher measures how fast executors start tasks and how long a fetch
+    // takes, fetches once the local queue would run dry within one fetch plus
+    // prefetchUsec, and sizes the fetch to last twice that long, so the next
+    // batch lands while the current one is still queued. Until executors
+    // started any task, it keeps topk tasks queued, and it never queues more
+    // than two full fetches. The next fetch is sent before the tasks of the
+    // last one are queued, so its round trip overlaps queueing them. Fetches
+    // range from topk to max(topk, maxTopk) tasks.
+    uint64_t prefetchUsec;
+    // If true, measure the queueing delay, wall time, CPU time and context
+    // switches of every task, and print their distribution when the worker
+    // stops. If usageBatch > 0, also store them in the TaskUsage table in
+    // batches of usageBatch tasks.
+    bool accountTasks;
+    size_t usageBatch;
+  };
+
+  // If exchange is true, executors leave finished task ids to the dispatcher,
+  // which reports them and fetches new tasks with one WorkerExchange call.
+  // Otherwise, if completionBatch > 0, executors report finished tasks
+  // through a CompletionAggregator instead of one WorkerUpdateTask call per
+  // task. Each executor thread runs tasks with its own executor for
+  // <workload>. If executorCores is not empty, executor i is pinned to core
+  // executorCores[i % executorCores.size()]. With kFibers, numExecutors is
+  // the number of tasks one thread keeps in flight, which only pays off for
+  // workloads that sleep.
   MockPollWorker(int workerId, int pkey, std::string dbAddr, int numExecutors,
-                 int topk)
+                 int topk, QueueType queueType = kMutexQueue,
+                 size_t completionBatch = 0,
+                 uint64_t completionDelayUsec = 1000, bool exchange = false,
+                 const PollOptions& poll = PollOptions(),
+                 const WorkloadConfig& workload = WorkloadConfig(),
+                 const std::vector<int>& executorCores = std::vector<int>())
       : WorkerManager(workerId, dbAddr),
         pkey_(pkey),
         numExecutors_(numExecutors),
-        topk_(topk){};
+        topk_(topk),
+        queueType_(queueType),
+        popBatch_(std::min(kMaxPopBatch, std::max(1, topk / numExecutors))),
+        aggregator_(nullptr),
+        exchange_(exchange),
+        poll_(poll),
+        workload_(workload),
+        executorCores_(executorCores),
+        nextLocalQueue_(0),
+        idleExecutors_(0),
+        stealingClosed_(false),
+        steals_(0),
+        wakeupThread_(nullptr),
+        stopFd_(-1),
+        drainUsec_(0) {
+    if (queueType == kLockFreeQueue) {
+      readyQueue_.reset(new MPMCQueue<DispatchedTask>(std::max(
+          kMinReadyQueueSize, 4 * std::max(topk, poll.maxTopk) * numExecutors)));
+    }
+    if (queueType == kWorkStealing) {
+      for (int i = 0; i < numExecutors; ++i) {
+        localQueues_.emplace_back(new MPMCQueue<DispatchedTask>(
+            std::max(kMinReadyQueueSize, 4 * std::max(topk, poll.maxTopk))));
+      }
+    }
+    if (poll.accountTasks) {
+      accounting_.reset(
+          new TaskAccounting(workerId, pkey, dbAddr, poll.usageBatch));
+    }
+    if (queueType == kFibers) {
+      fibers_.reset(
+          new FiberExecutor<DispatchedTask>(workload, numExecutors));
+    }
+    if (poll.wakeupPort > 0) {
+      wakeupUrl_ = "http://localhost:" +
+                   std::to_string(poll.wakeupPort + workerId);
+    }
+    if (completionBatch > 0 && !exchange) {
+      aggregator_ = new CompletionAggregator(workerId, pkey, dbAddr,
+                                             completionBatch,
+                                             completionDelayUsec);
+    }
+  };
 
   // Dispatch tasks that are assigned to this worker.
   // Potentially run in a dedicated dispatch thread.
@@ -30,27 +156,202 @@ public:
   // https://github.com/embeddedartistry/embedded-resources/blob/master/examples/cpp/dispatch.cpp
   void execute(int execId);
 
+  // Executor loop on the lock-free queue.
+  void executeLockFree(int execId);
+
+  // Executor loop with per-executor queues and work stealing.
+  void executeStealing(int execId);
+
+  // Run all tasks as fibers on one thread.
+  void executeFibers();
+
   // Setup the worker.
   // E.g., setup dispatch thread, and multiple executor threads.
   DbosStatus startServing();
 
-  // Stop the worker (all executor and dispatch threads) and free up resources.
+  // Stop the worker and free up resources. Drains it: stop fetching, let the
+  // executors finish the queued and running tasks, flush the batched
+  // completions, and return once all of it is done.
   DbosStatus endServing();
 
-  // Destructor
-  ~MockPollWorker() { /* placeholder for now. */
+  // Time the last endServing() took to drain the worker.
+  uint64_t drainUsec() const { return drainUsec_; }
+
+  // Tasks executors took from each other's queues, with kWorkStealing.
+  uint64_t steals() const { return steals_.load(); }
+
+  // Wait up to timeoutUsec for endServing() to finish draining, from another
+  // thread. Return true once the executors stopped and the last completions
+  // were stored.
+  bool waitDrained(uint64_t timeoutUsec) {
+    return drained_ != nullptr && drained_->waitFor(timeoutUsec);
   }
 
+  // Destructor
+  ~MockPollWorker() { delete aggregator_; }
+
 private:
+  // The decoded result table of one fetch, whose response buffer the payloads
+  // of its tasks point into. Freed once the last of those tasks finished.
+  struct PayloadBatch {
+    voltdb::Table table;
+    std::atomic<size_t> refs{1};  // tasks with a payload, plus the dispatcher
+  };
+
+  // A task id, the time the dispatcher queued it, its type and its payload,
+  // if any.
+  struct DispatchedTask {
+    DbosId taskId;
+    uint64_t dispatchTimeUsec;
+    int type;             // 0: run the workload task type
+    const char* payload;  // null: run the workload task payload
+    size_t payloadSize;
+    PayloadBatch* batch;  // owns the payload
+  };
+
+  static const int kMinReadyQueueSize = 1024;
+  static const int kMaxPopBatch = 16;
+  static const int kLeaseRenewals = 3;     // renewals per lease period
+  static const int kMaxReportRetries = 5;  // WorkerUpdateTask retries
+  static const uint64_t kReportRetryUsec = 1000;  // doubled on every retry
+
+  // Hand a task to the executors.
+  void enqueue(DispatchedTask task);
+
+  // Drop a reference to a payload batch, and free it with the last one.
+  static void releasePayload(PayloadBatch* batch);
+
+  // Run a task taken off the queue on an executor thread, on its payload if it
+  // has one, and record its dispatch latency, service time and usage.
+  void runTask(Executor* executor, const Task& workloadTask,
+               const DispatchedTask& task);
+
+  // With prefetch, return how many tasks to fetch now, or 0 and the time to
+  // wait in waitUsec if enough tasks are queued. incoming tasks were fetched
+  // but not queued yet.
+  int prefetchSize(int incoming, uint64_t* waitUsec);
+
+  // Pin an executor thread to its core, if cores are given.
+  void pinExecutor(int execId);
+
+  // Take tasks from another executor's queue. Return the number of tasks.
+  size_t steal(int execId, DispatchedTask* out);
+
+  // Park an idle executor until a task is queued anywhere. Return false once
+  // the worker stops and all queues are drained.
+  bool waitForWork();
+
+  // The VoltDB client and WorkerUpdateTask call of one executor thread, set
+  // up by its first reportTask() that goes to the DB.
+  struct Reporter {
+    std::unique_ptr<voltdb::Client> client;
+    std::unique_ptr<voltdb::Procedure> procedure;
+  };
+
+  // Mark a task complete with its result blob, if any: hand it to the
+  // aggregator or the dispatcher, or call WorkerUpdateTask with the
+  // executor's reporter, retrying it up to kMaxReportRetries times.
+  void reportTask(Reporter* reporter, DbosId taskId,
+                  const std::vector<char>& result = std::vector<char>());
+
+  // Collects the response of the fetch in flight.
+  class FetchCallback : public voltdb::ProcedureCallback {
+  public:
+    bool callback(voltdb::InvocationResponse response) throw(voltdb::Exception);
+
+    voltdb::InvocationResponse response_;
+    bool done_ = false;
+  };
+
+  // Call WorkerSelectTask, or WorkerExchange with the completed task ids.
+  // Queue the returned tasks for the executors. Return the number of tasks,
+  // or -1 on failure.
+  int fetchTasks(voltdb::Client* client, voltdb::Procedure* procedure,
+                 int topk, VoltdbResultDecoder* decoder);
+
+  // The steps of fetchTasks(). sendFetch() invokes the procedure without
+  // waiting for it. receiveFetch() waits for the response and decodes it;
+  // it returns the number of tasks, or -1 on failure. queueFetched() queues
+  // the decoded tasks; their payloads stay in the decoded result.
+  void sendFetch(voltdb::Client* client, voltdb::Procedure* procedure,
+                 int topk);
+  int receiveFetch(voltdb::Client* client, VoltdbResultDecoder* decoder);
+  void queueFetched(VoltdbResultDecoder* decoder);
+
+  // Call RenewTaskLeases for the tasks this worker holds.
+  void renewLeases(voltdb::Client* client, voltdb::Procedure* procedure);
+
+  // Sleep up to waitUsec after an empty fetch. Return true if woken up by a
+  // push.
+  bool idleWait(uint64_t waitUsec);
+
+  // Listen for wakeup pushes from the TaskAssign exporter.
+  void listenWakeup();
+  static void handleWakeup(struct http_request_s* request);
+
   int pkey_;
   int numExecutors_;
   std::mutex lock_;  // protect the access to shared taskQueue_
   std::vector<std::thread*>
       threads_;                   // including dispatch and executor threads
-  std::queue<DbosId> taskQueue_;  // queue of task Ids
-  std::condition_variable cv_;    // used to sync dispatch queue and executors
-  bool stopDispatch_ = false;
+  std::queue<DispatchedTask> taskQueue_;  // queue of task Ids
+  std::condition_variable cv_;  // used to sync dispatch queue and executors
+  std::atomic<bool> stopDispatch_{false};
   int topk_;  // Select top-K tasks in a batch
+  QueueType queueType_;
+  // Used with kLockFreeQueue.
+  std::unique_ptr<MPMCQueue<DispatchedTask>> readyQueue_;
+  int popBatch_;  // max tasks an executor takes from readyQueue_ at once
+  CompletionAggregator* aggregator_;  // null: report each task synchronously
+  bool exchange_;  // piggyback completions on WorkerExchange
+  std::mutex completedLock_;        // protects the two fields below
+  std::vector<int32_t> completed_;  // finished tasks not yet reported
+  std::vector<std::vector<char>> completedResults_;  // one per completed_
+  PollOptions poll_;
+  WorkloadConfig workload_;
+  std::vector<int> executorCores_;
+  // Used with kWorkStealing.
+  std::vector<std::unique_ptr<MPMCQueue<DispatchedTask>>> localQueues_;
+  size_t nextLocalQueue_;  // round-robin position, only used by the dispatcher
+  std::mutex idleLock_;             // protects parking on idleCv_
+  std::condition_variable idleCv_;  // wakes up parked executors
+  std::atomic<int> idleExecutors_;
+  bool stealingClosed_;            // no more tasks will be queued
+  std::atomic<uint64_t> steals_;  // tasks taken from other executors
+  std::unique_ptr<FiberExecutor<DispatchedTask>> fibers_;  // with kFibers
+  std::unique_ptr<TaskAccounting> accounting_;  // null: no per-task usage
+  std::string wakeupUrl_;  // empty: never park in IdleWorker
+  std::thread* wakeupThread_;
+  int stopFd_;  // eventfd that ends the listener's poll, -1 if none
+  std::mutex wakeLock_;             // protects wakeup_
+  std::condition_variable wakeCv_;  // ends the dispatcher's backoff sleep
+  bool wakeup_ = false;
+  // Polling stats, only touched by the dispatcher.
+  uint64_t fetches_ = 0;
+  uint64_t emptyFetches_ = 0;
+  uint64_t wakeups_ = 0;
+  uint64_t leaseRenewals_ = 0;
+  // Prefetch state. started_ is bumped by executors, the rest is only
+  // touched by the dispatcher.
+  std::atomic<uint64_t> started_{0};  // tasks taken off the local queue
+  uint64_t enqueued_ = 0;             // tasks put on the local queue
+  double drainRate_ = 0;      // tasks per usec, moving average
+  double fetchUsec_ = 0;      // fetch round trip, moving average
+  uint64_t lastStarted_ = 0;  // started_ at the last rate sample
+  uint64_t lastSampleUsec_ = 0;
+  uint64_t prefetchWaits_ = 0;  // rounds skipped with enough tasks queued
+  // The fetch in flight, only touched by the dispatcher, and by endServing()
+  // once the dispatcher stopped.
+  boost::shared_ptr<FetchCallback> fetchCallback_{new FetchCallback()};
+  bool fetchInFlight_ = false;
+  std::string fetchName_;          // procedure name, for errors
+  std::vector<int32_t> fetchDone_;  // completions the fetch reports
+  std::vector<std::vector<char>> fetchResults_;  // one per fetchDone_
+  uint64_t fetchSentUsec_ = 0;
+  // Drain state. endServing() counts down once the executors stopped and the
+  // final completion flush is done.
+  std::unique_ptr<Latch> drained_;
+  uint64_t drainUsec_;
 };
 
 #endif  // #ifndef MOCK_POLL_WORKER_H
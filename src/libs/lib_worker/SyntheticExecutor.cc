@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "MockExecutor.h"
+#include "SyntheticExecutor.h"
+#include "TaskRegistry.h"
+
+Executor* createExecutor(const WorkloadConfig& config) {
+  switch (config.type) {
+    case WorkloadConfig::kSpin:
+      return new SpinExecutor();
+    case WorkloadConfig::kSleep:
+      return new SleepExecutor();
+    case WorkloadConfig::kMemory:
+      return new MemoryExecutor(config.memoryBytes);
+    case WorkloadConfig::kMixed:
+      return new MixedExecutor(config);
+    case WorkloadConfig::kPlugin:
+      return new PluginExecutor(config.registry, config.taskType);
+    case WorkloadConfig::kNone:
+    default:
+      return new MockExecutor();
+  }
+}
+
+// A xorshift step per iteration; the result is stored so the loop is not
+// optimized away.
+static volatile uint64_t spinSink;
+
+static inline void spin(uint64_t iterations) {
+  uint64_t x = 88172645463325252ULL;
+  for (uint64_t i = 0; i < iterations; ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  spinSink = x;
+}
+
+static double calibrateSpin() {
+  const uint64_t kIterations = 1 << 22;
+  const int kRounds = 5;
+  // Take the median of a few rounds, so preemption does not skew the rate.
+  std::vector<double> rates;
+  for (int i = 0; i < kRounds; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    spin(kIterations);
+    double usec = std::chrono::duration<double, std::micro>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    rates.push_back(kIterations / std::max(usec, 1.0));
+  }
+  std::sort(rates.begin(), rates.end());
+  return rates[kRounds / 2];
+}
+
+double SpinExecutor::iterationsPerUsec() {
+  static const double rate = calibrateSpin();
+  return rate;
+}
+
+DbosStatus SpinExecutor::run(const Task& task) {
+  if (task.execTime > 0) {
+    spin((uint64_t)(task.execTime * iterationsPerUsec()));
+  }
+  return true;
+}
+
+DbosStatus SleepExecutor::run(const Task& task) {
+  if (task.execTime > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(task.execTime));
+  }
+  return true;
+}
+
+DbosStatus SleepExecutor::beginTask(const Task& task, uint64_t* waitUsec) {
+  *waitUsec = task.execTime > 0 ? task.execTime : 0;
+  return true;
+}
+
+DbosStatus MemoryExecutor::run(const Task& task) {
+  if (task.execTime <= 0 || buffer_.empty()) { return true; }
+  auto end = std::chrono::steady_clock::now() +
+             std::chrono::microseconds(task.execTime);
+  do {
+    for (size_t i = 0; i < kLinesPerCheck; ++i) {
+      buffer_[pos_]++;
+      pos_ += kCacheLine;
+      if (pos_ >= buffer_.size()) { pos_ = 0; }
+    }
+  } while (std::chrono::steady_clock::now() < end);
+  return true;
+}
+
+MixedExecutor::MixedExecutor(const WorkloadConfig& config)
+    : Executor(),
+      memoryBytes_(config.memoryBytes),
+      gen_(std::random_device()()),
+      kind_({config.spinWeight, config.sleepWeight, config.memoryWeight}),
+      execTime_(1.0) {}
+
+MemoryExecutor* MixedExecutor::memory() {
+  if (memory_ == nullptr) { memory_.reset(new MemoryExecutor(memoryBytes_)); }
+  return memory_.get();
+}
+
+Task MixedExecutor::draw(const Task& task, Kind* kind) {
+  Task drawn = task;
+  drawn.execTime = (int)(task.execTime * execTime_(gen_));
+  *kind = (Kind)kind_(gen_);
+  return drawn;
+}
+
+DbosStatus MixedExecutor::run(const Task& task) {
+  Kind kind;
+  Task drawn = draw(task, &kind);
+  switch (kind) {
+    case kSpin:
+      return spin_.executeTask(drawn);
+    case kSleep:
+      return sleep_.executeTask(drawn);
+    default:
+      return memory()->executeTask(drawn);
+  }
+}
+
+DbosStatus MixedExecutor::beginTask(const Task& task, uint64_t* waitUsec) {
+  Kind kind;
+  Task drawn = draw(task, &kind);
+  if (kind == kSleep) { return sleep_.beginTask(drawn, waitUsec); }
+  *waitUsec = 0;
+  return kind == kSpin ? spin_.executeTask(drawn)
+                       : memory()->executeTask(drawn);
+}
@@ -0,0 +1,140 @@
+// This file contains executors that run synthetic task workloads.
+#ifndef SYNTHETIC_EXECUTOR_H
+#define SYNTHETIC_EXECUTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Executor.h"
+
+class TaskRegistry;
+
+// Every executor below keeps a task busy for about task.execTime usec.
+struct WorkloadConfig {
+  enum Type {
+    kNone,    // MockExecutor: return immediately
+    kSpin,    // calibrated CPU spin loop
+    kSleep,   // sleep, like a task blocked on I/O
+    kMemory,  // stream over a private buffer, bound by memory bandwidth
+    kMixed,   // a random one of the above, with random execution times
+    kPlugin   // PluginExecutor: a task function loaded from a plugin
+  };
+
+  WorkloadConfig()
+      : type(kNone),
+        execTimeUsec(0),
+        memoryBytes(64 << 20),
+        spinWeight(1.0),
+        sleepWeight(1.0),
+        memoryWeight(1.0),
+        taskType(0) {}
+
+  Type type;
+  int execTimeUsec;    // execution time of each task (mean for kMixed)
+  size_t memoryBytes;  // buffer size of each memory executor
+  // kMixed picks spin/sleep/memory with these relative weights.
+  double spinWeight;
+  double sleepWeight;
+  double memoryWeight;
+  // kPlugin runs task functions of this registry, taskType by default. Tasks
+  // carry a view of payload, shared by all copies of the config.
+  std::shared_ptr<const TaskRegistry> registry;
+  int taskType;
+  std::shared_ptr<const std::string> payload;
+
+  // The task handed to executors of this workload.
+  Task task() const {
+    Task task;
+    task.targetData = 0;
+    task.execTime = execTimeUsec;
+    task.type = taskType;
+    if (payload) {
+      task.payload = payload->data();
+      task.payloadSize = payload->size();
+    }
+    return task;
+  }
+};
+
+// Return a new executor for the workload.
+Executor* createExecutor(const WorkloadConfig& config);
+
+// Spin on the CPU. The loop is calibrated once per process, so a task does
+// not read the clock while it runs.
+class SpinExecutor : public Executor {
+public:
+  SpinExecutor() : Executor() { iterationsPerUsec(); }
+
+protected:
+  DbosStatus run(const Task& task) override;
+
+private:
+  // Spin loop iterations per usec on this machine.
+  static double iterationsPerUsec();
+};
+
+class SleepExecutor : public Executor {
+public:
+  SleepExecutor() : Executor(){};
+
+  // The whole task is a wait.
+  DbosStatus beginTask(const Task& task, uint64_t* waitUsec) override;
+
+protected:
+  DbosStatus run(const Task& task) override;
+};
+
+// Read and write one byte per cache line of a private buffer, wrapping
+// around, until the execution time has passed. Use a buffer well above the
+// last-level cache size to measure memory bandwidth.
+class MemoryExecutor : public Executor {
+public:
+  explicit MemoryExecutor(size_t bytes)
+      : Executor(), buffer_(bytes, 0), pos_(0){};
+
+protected:
+  DbosStatus run(const Task& task) override;
+
+private:
+  static const size_t kCacheLine = 64;
+  static const size_t kLinesPerCheck = 64;  // read the clock every 4KB
+
+  std::vector<char> buffer_;
+  size_t pos_;  // where the next task continues
+};
+
+// Draw the kind of each task from the configured weights and its execution
+// time from an exponential distribution with mean task.execTime.
+class MixedExecutor : public Executor {
+public:
+  explicit MixedExecutor(const WorkloadConfig& config);
+
+  // Sleeping tasks wait; the others run here.
+  DbosStatus beginTask(const Task& task, uint64_t* waitUsec) override;
+
+protected:
+  DbosStatus run(const Task& task) override;
+
+private:
+  enum Kind { kSpin, kSleep, kMemory };  // in the order of the weights
+
+  // Draw the kind and execution time of a task.
+  Task draw(const Task& task, Kind* kind);
+
+  // The memory executor, whose buffer is allocated by the first memory task,
+  // so a mix without them does not pay for it.
+  MemoryExecutor* memory();
+
+  SpinExecutor spin_;
+  SleepExecutor sleep_;
+  size_t memoryBytes_;
+  std::unique_ptr<MemoryExecutor> memory_;
+  std::mt19937 gen_;
+  std::discrete_distribution<int> kind_;
+  std::exponential_distribution<double> execTime_;  // mean 1
+};
+
+#endif  // #ifndef SYNTHETIC_EXECUTOR_H
@@ -0,0 +1,101 @@
+#define __STDC_CONSTANT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <iostream>
+#include <vector>
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+#include "BenchmarkUtil.h"
+#include "TaskAccounting.h"
+#include "WorkerManager.h"
+
+TaskAccounting::Clock TaskAccounting::Clock::now() {
+  Clock clock;
+  clock.wallUsec = BenchmarkUtil::getCurrTimeUsec();
+  struct timespec cpu;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+  clock.cpuUsec = (uint64_t)cpu.tv_sec * 1000000 + cpu.tv_nsec / 1000;
+  struct rusage usage;
+  getrusage(RUSAGE_THREAD, &usage);
+  clock.contextSwitches = usage.ru_nvcsw + usage.ru_nivcsw;
+  return clock;
+}
+
+void TaskAccounting::start() {
+  if (storeRows_) { BatchFlusher<TaskUsageRow>::start(); }
+}
+
+void TaskAccounting::record(DbosId taskId, uint64_t queueUsec,
+                            const Clock& start, const Clock& end) {
+  TaskUsage usage;
+  usage.queueUsec = queueUsec;
+  usage.wallUsec = end.wallUsec - start.wallUsec;
+  usage.cpuUsec = end.cpuUsec - start.cpuUsec;
+  usage.contextSwitches = end.contextSwitches - start.contextSwitches;
+  queueUsec_.record(usage.queueUsec);
+  wallUsec_.record(usage.wallUsec);
+  cpuUsec_.record(usage.cpuUsec);
+  contextSwitches_.record(usage.contextSwitches);
+  if (started()) { add(TaskUsageRow{taskId, usage}); }
+}
+
+static void printHistogram(std::ostream& out, const std::string& name,
+                           const Histogram& histogram) {
+  out << "  " << name << ": mean " << histogram.mean() << ", p50 "
+      << histogram.percentile(50) << ", p99 " << histogram.percentile(99)
+      << ", max " << histogram.max() << "\n";
+}
+
+void TaskAccounting::print(std::ostream& out) const {
+  out << "Worker " << workerId_ << " task usage over " << wallUsec_.count()
+      << " tasks:\n";
+  printHistogram(out, "queueing (usec)", queueUsec_);
+  printHistogram(out, "wall time (usec)", wallUsec_);
+  printHistogram(out, "CPU time (usec)", cpuUsec_);
+  printHistogram(out, "context switches", contextSwitches_);
+}
+
+void TaskAccounting::setup() {
+  // Create a local VoltDB client.
+  client_.reset(
+      new voltdb::Client(WorkerManager::createVoltdbClient(dbAddr_)));
+  std::vector<voltdb::Parameter> parameterTypes(7);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  for (int i = 3; i < 7; ++i) {
+    parameterTypes[i] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT, true);
+  }
+  procedure_.reset(new voltdb::Procedure("ReportTaskUsage", parameterTypes));
+}
+
+bool TaskAccounting::flush(const std::vector<TaskUsageRow>& batch) {
+  for (const TaskUsageRow& row : batch) {
+    taskIds_.push_back(row.taskId);
+    queue_.push_back(row.usage.queueUsec);
+    wall_.push_back(row.usage.wallUsec);
+    cpu_.push_back(row.usage.cpuUsec);
+    switches_.push_back(row.usage.contextSwitches);
+  }
+  voltdb::ParameterSet* params = procedure_->params();
+  params->addInt32(pkey_).addInt32(workerId_).addInt32(taskIds_);
+  params->addInt64(queue_).addInt64(wall_).addInt64(cpu_).addInt64(switches_);
+  voltdb::InvocationResponse r = client_->invoke(*procedure_);
+  taskIds_.clear();
+  queue_.clear();
+  wall_.clear();
+  cpu_.clear();
+  switches_.clear();
+  if (r.failure()) {
+    std::cout << "ReportTaskUsage procedure failed. " << r.toString()
+              << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,95 @@
+// This file contains per-worker accounting of the resources tasks use.
+#ifndef DBOS_TASK_ACCOUNTING_H
+#define DBOS_TASK_ACCOUNTING_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BatchFlusher.h"
+#include "DbosDefs.h"
+#include "Histogram.h"
+#include "voltdb-client-cpp/include/Client.h"
+
+// Resources one task used.
+struct TaskUsage {
+  uint64_t queueUsec;        // from dispatch until an executor took it
+  uint64_t wallUsec;         // from start to finish
+  uint64_t cpuUsec;          // CPU time of the executor thread meanwhile
+  uint64_t contextSwitches;  // voluntary and involuntary, meanwhile
+};
+
+// The usage of one task, as stored in TaskUsage.
+struct TaskUsageRow {
+  int32_t taskId;
+  TaskUsage usage;
+};
+
+// Executor threads take a Clock reading before and after each task and
+// record() the difference. The usage goes into lock-free histograms of the
+// worker. If maxBatch > 0, a flusher thread with its own VoltDB client also
+// stores one TaskUsage row per task, with one ReportTaskUsage call per batch
+// of maxBatch tasks or after maxDelayUsec, like the CompletionAggregator. A
+// batch that still fails after the retries is dropped; usage is only stats.
+// record() is thread safe.
+class TaskAccounting : public BatchFlusher<TaskUsageRow> {
+public:
+  // Wall clock, CPU time and context switches of the calling thread.
+  struct Clock {
+    uint64_t wallUsec;
+    uint64_t cpuUsec;
+    uint64_t contextSwitches;
+
+    static Clock now();
+  };
+
+  TaskAccounting(DbosId workerId, int pkey, std::string dbAddr,
+                 size_t maxBatch = 0, uint64_t maxDelayUsec = 100000)
+      : BatchFlusher<TaskUsageRow>(maxBatch, maxDelayUsec, false),
+        workerId_(workerId),
+        pkey_(pkey),
+        dbAddr_(dbAddr),
+        storeRows_(maxBatch > 0) {}
+
+  ~TaskAccounting() { stop(); }
+
+  // Start the flusher thread, if rows are stored.
+  void start();
+
+  // Record a task that ran on the calling thread between start and end.
+  void record(DbosId taskId, uint64_t queueUsec, const Clock& start,
+              const Clock& end);
+
+  // Print count, mean and percentiles of every resource.
+  void print(std::ostream& out) const;
+
+  const Histogram& queueUsec() const { return queueUsec_; }
+  const Histogram& wallUsec() const { return wallUsec_; }
+  const Histogram& cpuUsec() const { return cpuUsec_; }
+  const Histogram& contextSwitches() const { return contextSwitches_; }
+
+protected:
+  void setup() override;
+  bool flush(const std::vector<TaskUsageRow>& batch) override;
+
+private:
+  DbosId workerId_;
+  int pkey_;
+  std::string dbAddr_;
+  bool storeRows_;
+
+  Histogram queueUsec_;
+  Histogram wallUsec_;
+  Histogram cpuUsec_;
+  Histogram contextSwitches_;
+
+  // Only used by the flusher thread.
+  std::unique_ptr<voltdb::Client> client_;
+  std::unique_ptr<voltdb::Procedure> procedure_;
+  std::vector<int32_t> taskIds_;
+  std::vector<int64_t> queue_, wall_, cpu_, switches_;
+};
+
+#endif  // #ifndef DBOS_TASK_ACCOUNTING_H
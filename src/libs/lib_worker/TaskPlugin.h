@@ -0,0 +1,50 @@
+/* This file contains the C interface between workers and task plugins. */
+#ifndef DBOS_TASK_PLUGIN_H
+#define DBOS_TASK_PLUGIN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Passed to the entry point; plugins built against another version should
+ * fail to initialize. */
+#define DBOS_TASK_PLUGIN_ABI_VERSION 2
+
+/* Name of the entry point every plugin exports. */
+#define DBOS_TASK_PLUGIN_INIT "dbos_task_plugin_init"
+
+/* Arguments of one task. The payload is a view of the bytes the worker
+ * received; it is only valid until the task function returns. */
+typedef struct DbosTaskArgs {
+  const char* payload;
+  size_t payloadSize;
+  int targetData;
+  int execTime; /* usec */
+  /* Optionally called once with the result blob of the task, which the
+   * worker copies and reports with the completion. */
+  void (*setResult)(void* resultContext, const char* data, size_t size);
+  void* resultContext;
+} DbosTaskArgs;
+
+/* Run a task and return 0 on success. Executor threads call task functions
+ * concurrently, so they must be thread safe. */
+typedef int (*DbosTaskFunction)(const DbosTaskArgs* args);
+
+/* Handed to the entry point, which calls registerTask once per task type. */
+typedef struct DbosTaskRegistrar {
+  int abiVersion;
+  void* registry;
+  /* Return 0 on success, -1 if the name is taken. */
+  int (*registerTask)(void* registry, const char* name, DbosTaskFunction fn);
+} DbosTaskRegistrar;
+
+/* The entry point: register the task functions and return 0 on success. */
+typedef int (*DbosTaskPluginInit)(const DbosTaskRegistrar* registrar);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef DBOS_TASK_PLUGIN_H */
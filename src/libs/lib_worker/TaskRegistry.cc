@@ -0,0 +1,100 @@
+#include <dlfcn.h>
+
+#include <iostream>
+#include <sstream>
+
+#include "TaskRegistry.h"
+
+TaskRegistry::~TaskRegistry() {
+  for (void* handle : handles_) { dlclose(handle); }
+}
+
+bool TaskRegistry::load(const std::string& path) {
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    std::cerr << "Could not load task plugin: " << dlerror() << std::endl;
+    return false;
+  }
+  DbosTaskPluginInit init =
+      (DbosTaskPluginInit)dlsym(handle, DBOS_TASK_PLUGIN_INIT);
+  if (init == nullptr) {
+    std::cerr << "Task plugin " << path << " does not export "
+              << DBOS_TASK_PLUGIN_INIT << std::endl;
+    dlclose(handle);
+    return false;
+  }
+  // Keep the plugin loaded even if init fails halfway, since some of its
+  // functions may already be registered.
+  handles_.push_back(handle);
+
+  DbosTaskRegistrar registrar;
+  registrar.abiVersion = DBOS_TASK_PLUGIN_ABI_VERSION;
+  registrar.registry = this;
+  registrar.registerTask = &TaskRegistry::registerTask;
+  if (init(&registrar) != 0) {
+    std::cerr << "Task plugin " << path << " failed to initialize"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool TaskRegistry::loadAll(const std::string& paths) {
+  std::istringstream stream(paths);
+  std::string path;
+  while (std::getline(stream, path, ',')) {
+    if (!path.empty() && !load(path)) { return false; }
+  }
+  return true;
+}
+
+int TaskRegistry::add(const std::string& name, DbosTaskFunction function) {
+  if (function == nullptr || types_.count(name) > 0) {
+    std::cerr << "Cannot register task function: " << name << std::endl;
+    return 0;
+  }
+  functions_.push_back(function);
+  names_.push_back(name);
+  int type = (int)functions_.size();
+  types_[name] = type;
+  return type;
+}
+
+int TaskRegistry::registerTask(void* registry, const char* name,
+                               DbosTaskFunction function) {
+  return ((TaskRegistry*)registry)->add(name, function) > 0 ? 0 : -1;
+}
+
+int TaskRegistry::type(const std::string& name) const {
+  auto it = types_.find(name);
+  return it == types_.end() ? 0 : it->second;
+}
+
+void TaskRegistry::printTasks(std::ostream& out) const {
+  for (size_t i = 0; i < names_.size(); ++i) {
+    out << (i > 0 ? " " : "") << names_[i];
+  }
+}
+
+DbosStatus PluginExecutor::run(const Task& task) {
+  int type = task.type > 0 ? task.type : defaultType_;
+  DbosTaskFunction function = registry_->function(type);
+  if (function == nullptr) {
+    std::cerr << "No task function of type " << type << std::endl;
+    return false;
+  }
+  DbosTaskArgs args;
+  args.payload = task.payload;
+  args.payloadSize = task.payloadSize;
+  args.targetData = task.targetData;
+  args.execTime = task.execTime;
+  args.setResult = &PluginExecutor::setResult;
+  args.resultContext = this;
+  return function(&args) == 0;
+}
+
+void PluginExecutor::setResult(void* executor, const char* data,
+                               size_t size) {
+  std::vector<char>& result = ((PluginExecutor*)executor)->result_;
+  result.assign(data, data + size);
+}
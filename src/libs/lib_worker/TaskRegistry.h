@@ -0,0 +1,83 @@
+// This file contains the registry of task functions loaded from plugins.
+#ifndef DBOS_TASK_REGISTRY_H
+#define DBOS_TASK_REGISTRY_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Executor.h"
+#include "TaskPlugin.h"
+
+// Workers load plugins (shared libraries exporting dbos_task_plugin_init, see
+// TaskPlugin.h) at start. Every task function a plugin registers gets the next
+// task type, starting at 1, so workers that load the same plugins in the same
+// order agree on the types. Type 0 is no task function.
+// The registry is filled before executors start and is read only afterwards,
+// so lookups take no lock. Plugins stay loaded until the registry is freed.
+class TaskRegistry {
+public:
+  TaskRegistry() {}
+  ~TaskRegistry();
+
+  TaskRegistry(const TaskRegistry&) = delete;
+  TaskRegistry& operator=(const TaskRegistry&) = delete;
+
+  // Load a plugin and register its task functions. Print the reason and
+  // return false on failure.
+  bool load(const std::string& path);
+
+  // Load a comma-separated list of plugins.
+  bool loadAll(const std::string& paths);
+
+  // Register a task function under a new type. Return the type, or 0 if the
+  // name is taken.
+  int add(const std::string& name, DbosTaskFunction function);
+
+  // Type of a task name, or 0 if unknown.
+  int type(const std::string& name) const;
+
+  // Task function of a type, or nullptr if unknown.
+  DbosTaskFunction function(int type) const {
+    if (type <= 0 || (size_t)type > functions_.size()) { return nullptr; }
+    return functions_[type - 1];
+  }
+
+  size_t size() const { return functions_.size(); }
+
+  // Print the registered task names, space separated.
+  void printTasks(std::ostream& out) const;
+
+private:
+  // registerTask callback of DbosTaskRegistrar.
+  static int registerTask(void* registry, const char* name,
+                          DbosTaskFunction function);
+
+  std::vector<void*> handles_;               // dlopen handles
+  std::vector<DbosTaskFunction> functions_;  // of type i + 1
+  std::vector<std::string> names_;           // of type i + 1
+  std::unordered_map<std::string, int> types_;
+};
+
+// Call the task function of each task's type with a view of the task payload.
+// Tasks of type 0 run defaultType. The result blob a function sets is kept in
+// result().
+class PluginExecutor : public Executor {
+public:
+  PluginExecutor(std::shared_ptr<const TaskRegistry> registry, int defaultType)
+      : Executor(), registry_(registry), defaultType_(defaultType) {}
+
+protected:
+  DbosStatus run(const Task& task) override;
+
+private:
+  // setResult callback of DbosTaskArgs.
+  static void setResult(void* executor, const char* data, size_t size);
+
+  std::shared_ptr<const TaskRegistry> registry_;
+  int defaultType_;
+};
+
+#endif  // #ifndef DBOS_TASK_REGISTRY_H
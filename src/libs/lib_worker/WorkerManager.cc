@@ -23,6 +23,12 @@ static const std::string kTestPwd = "testpassword";
 
 std::atomic<uint64_t> WorkerManager::totalTasks_;
 std::atomic<uint64_t> WorkerManager::totalFinishedTasks_;
+double* WorkerManager::dispatchLatencies_ = nullptr;
+size_t WorkerManager::maxDispatchLatencies_ = 0;
+std::atomic<uint64_t> WorkerManager::dispatchLatsIndex_;
+double* WorkerManager::serviceTimes_ = nullptr;
+size_t WorkerManager::maxServiceTimes_ = 0;
+std::atomic<uint64_t> WorkerManager::serviceTimesIndex_;
 
 WorkerManager::~WorkerManager() {
   // placeholder.
@@ -35,6 +35,31 @@ public:
 
   static std::atomic<uint64_t> totalTasks_;
   static std::atomic<uint64_t> totalFinishedTasks_;
+
+  // Dispatch-to-start latency (usec) of executed tasks. Benchmarks allocate
+  // the array; recording is a no-op while it is null.
+  static double* dispatchLatencies_;
+  static size_t maxDispatchLatencies_;
+  static std::atomic<uint64_t> dispatchLatsIndex_;
+
+  static inline void recordDispatchLatency(double latencyUsec) {
+    if (dispatchLatencies_ == nullptr) { return; }
+    uint64_t index = dispatchLatsIndex_.fetch_add(1);
+    if (index < maxDispatchLatencies_) {
+      dispatchLatencies_[index] = latencyUsec;
+    }
+  }
+
+  // Measured service time (usec) of executed tasks, same as above.
+  static double* serviceTimes_;
+  static size_t maxServiceTimes_;
+  static std::atomic<uint64_t> serviceTimesIndex_;
+
+  static inline void recordServiceTime(double serviceTimeUsec) {
+    if (serviceTimes_ == nullptr) { return; }
+    uint64_t index = serviceTimesIndex_.fetch_add(1);
+    if (index < maxServiceTimes_) { serviceTimes_[index] = serviceTimeUsec; }
+  }
   std::string workerAddr;
 
 protected:
@@ -77,6 +77,11 @@
 *       request + headers cannot fit in this size the request body will be
 *       streamed in.
 *
+*     HTTP_POOL_MAX_FREE - default 1024 - Sessions, read/write buffers,
+*       responses and response headers are kept on per-server free lists and
+*       reused instead of freed. This is the maximum number of idle entries
+*       kept on each list; anything beyond it goes back to malloc.
+*
 *   For more details see the documentation of the interface and the example
 *   below.
 *
@@ -156,6 +161,11 @@ int http_server_listen_addr_poll(struct http_server_s* server, const char* ipadd
 // 0.
 int http_server_poll(struct http_server_s* server);
 
+// Closes the listening socket and the event loop of a server and frees it,
+// along with its pooled objects. Call it once the server is no longer polled.
+// Connections that are still open are not closed.
+void http_server_free(struct http_server_s* server);
+
 // Returns 1 if the flag is set and false otherwise. The flags that can be
 // queried are listed below
 int http_request_has_flag(struct http_request_s* request, int flag);
@@ -225,6 +235,12 @@ void http_request_free_buffer(struct http_request_s* request);
 // called.
 struct http_response_s* http_response_init();
 
+// Same as http_response_init, except that the response and its headers are
+// taken from the free lists of the request's server and returned to them when
+// http_respond is called, so responding does not allocate. Only use it from
+// the thread that polls the server.
+struct http_response_s* http_request_response_init(struct http_request_s* request);
+
 // Set the response status. Accepts values between 100 and 599 inclusive. Any
 // other value will map to 500.
 void http_response_status(struct http_response_s* response, int status);
@@ -311,7 +327,10 @@ int main() {
 
 #ifdef __linux__
 #define EPOLL
+// C++ compilers define _GNU_SOURCE, which already implies a newer level.
+#ifndef _POSIX_C_SOURCE
 #define _POSIX_C_SOURCE 199309L
+#endif
 #else
 #define KQUEUE
 #endif
@@ -348,6 +367,12 @@ int main() {
 #define HTTP_MAX_TOKEN_LENGTH 8192 // 8kb
 #define HTTP_MAX_TOTAL_EST_MEM_USAGE 4294967296 // 4gb
 #define HTTP_MAX_REQUEST_BUF_SIZE 8388608 // 8mb
+#define HTTP_POOL_MAX_FREE 1024
+
+// Pooled read/write buffers fit both an initial request and response buffer.
+#define HTTP_POOL_BUF_SIZE \
+  (HTTP_REQUEST_BUF_SIZE > HTTP_RESPONSE_BUF_SIZE ? \
+   HTTP_REQUEST_BUF_SIZE : HTTP_RESPONSE_BUF_SIZE)
 
 #define HTTP_MAX_HEADER_COUNT 127
 
@@ -448,6 +473,16 @@ typedef struct http_request_s {
   char flags;
 } http_request_t;
 
+// Free list of fixed size objects. The link is stored in the object itself.
+typedef struct hs_pool_node_s {
+  struct hs_pool_node_s* next;
+} hs_pool_node_t;
+
+typedef struct {
+  hs_pool_node_t* head;
+  int size;
+} hs_pool_t;
+
 typedef struct http_server_s {
 #ifdef KQUEUE
   void (*handler)(struct kevent* ev);
@@ -456,6 +491,10 @@ typedef struct http_server_s {
   epoll_cb_t timer_handler;
 #endif
   int64_t memused;
+  hs_pool_t session_pool;
+  hs_pool_t buf_pool;
+  hs_pool_t response_pool;
+  hs_pool_t header_pool;
   int socket;
   int port;
   int loop;
@@ -478,6 +517,7 @@ typedef struct http_response_s {
   char const * body;
   int content_length;
   int status;
+  struct http_server_s* server; // NULL if not taken from a server pool
 } http_response_t;
 
 typedef struct http_string_s http_string_t;
@@ -719,15 +759,56 @@ static int const hs_token_start_states[] = {
   0, 0, 0,
 };
 
+// *** memory pools ***
+
+// Pools are only touched by the thread that polls the server, so they need no
+// locking.
+
+void* hs_pool_get(hs_pool_t* pool) {
+  hs_pool_node_t* node = pool->head;
+  if (node) {
+    pool->head = node->next;
+    pool->size--;
+  }
+  return node;
+}
+
+// Returns 0 if the pool is full, in which case the caller frees the object.
+int hs_pool_put(hs_pool_t* pool, void* obj) {
+  if (pool->size >= HTTP_POOL_MAX_FREE) return 0;
+  hs_pool_node_t* node = (hs_pool_node_t*)obj;
+  node->next = pool->head;
+  pool->head = node;
+  pool->size++;
+  return 1;
+}
+
+char* hs_buf_get(http_server_t* server) {
+  server->memused += HTTP_POOL_BUF_SIZE;
+  char* buf = (char*)hs_pool_get(&server->buf_pool);
+  if (!buf) {
+    buf = (char*)malloc(HTTP_POOL_BUF_SIZE);
+    assert(buf != NULL);
+  }
+  return buf;
+}
+
+// Buffers that grew past HTTP_POOL_BUF_SIZE are not reused.
+void hs_buf_put(http_server_t* server, char* buf, int capacity) {
+  server->memused -= capacity;
+  if (capacity != HTTP_POOL_BUF_SIZE || !hs_pool_put(&server->buf_pool, buf)) {
+    free(buf);
+  }
+}
+
 // *** input stream ***
 
-int hs_stream_read_socket(hs_stream_t* stream, int socket, int64_t* memused) {
+int hs_stream_read_socket(hs_stream_t* stream, int socket, http_server_t* server) {
   if (stream->index < stream->length) return 1;
+  int64_t* memused = &server->memused;
   if (!stream->buf) {
-    *memused += HTTP_REQUEST_BUF_SIZE;
-    stream->buf = (char*)calloc(1, HTTP_REQUEST_BUF_SIZE);
-    assert(stream->buf != NULL);
-    stream->capacity = HTTP_REQUEST_BUF_SIZE;
+    stream->buf = hs_buf_get(server);
+    stream->capacity = HTTP_POOL_BUF_SIZE;
   }
   int bytes;
   do {
@@ -1037,8 +1118,7 @@ int hs_write_client_socket(http_request_t* session) {
 
 void hs_free_buffer(http_request_t* session) {
   if (session->stream.buf) {
-    free(session->stream.buf);
-    session->server->memused -= session->stream.capacity;
+    hs_buf_put(session->server, session->stream.buf, session->stream.capacity);
     session->stream.buf = NULL;
   }
 }
@@ -1047,20 +1127,37 @@ void hs_init_session(http_request_t* session) {
   session->flags = HTTP_AUTOMATIC;
   session->parser = (http_parser_t){ };
   session->stream = (hs_stream_t){ };
+  // Keep the token buffer across keep-alive requests.
   if (session->tokens.buf) {
-    free(session->tokens.buf);
-    session->tokens.buf = NULL;
+    session->tokens.size = 0;
+  } else {
+    http_token_dyn_init(&session->tokens, 32);
+  }
+}
+
+// Takes a session from the server pool. The token buffer of a pooled session
+// is kept for the next connection.
+http_request_t* hs_session_get(http_server_t* server) {
+  http_request_t* session = (http_request_t*)hs_pool_get(&server->session_pool);
+  if (!session) {
+    session = (http_request_t*)calloc(1, sizeof(http_request_t));
+    assert(session != NULL);
+    return session;
   }
-  http_token_dyn_init(&session->tokens, 32);
+  http_token_dyn_t tokens = session->tokens;
+  memset(session, 0, sizeof(http_request_t));
+  session->tokens = tokens;
+  return session;
 }
 
 void hs_end_session(http_request_t* session) {
   hs_delete_events(session);
   close(session->socket);
   hs_free_buffer(session);
-  free(session->tokens.buf);
-  session->tokens.buf = NULL;
-  free(session);
+  if (!hs_pool_put(&session->server->session_pool, session)) {
+    free(session->tokens.buf);
+    free(session);
+  }
 }
 
 void hs_reset_timeout(http_request_t* request, int time) {
@@ -1099,7 +1196,7 @@ void hs_write_response(http_request_t* request) {
 }
 
 void hs_error_response(http_request_t* request, int code, char const * message) {
-  struct http_response_s* response = http_response_init();
+  struct http_response_s* response = http_request_response_init(request);
   http_response_status(response, code);
   http_response_header(response, "Content-Type", "text/plain");
   http_response_body(response, message, strlen(message));
@@ -1111,7 +1208,7 @@ void hs_read_and_process_request(http_request_t* request) {
   request->state = HTTP_SESSION_READ;
   http_token_t token = {0, 0, 0};
   hs_reset_timeout(request, HTTP_REQUEST_TIMEOUT);
-  int rc = hs_stream_read_socket(&request->stream, request->socket, &request->server->memused);
+  int rc = hs_stream_read_socket(&request->stream, request->socket, request->server);
   if (rc == 0) {
     HTTP_FLAG_SET(request->flags, HTTP_END_SESSION);
     return;
@@ -1176,8 +1273,7 @@ void hs_accept_connections(http_server_t* server) {
   do {
     sock = accept(server->socket, (struct sockaddr *)&server->addr, &server->len);
     if (sock > 0) {
-      http_request_t* session = (http_request_t*)calloc(1, sizeof(http_request_t));
-      assert(session != NULL);
+      http_request_t* session = hs_session_get(server);
       session->socket = sock;
       session->server = server;
       session->timeout = HTTP_REQUEST_TIMEOUT;
@@ -1203,6 +1299,10 @@ http_server_t* http_server_init(int port, void (*handler)(http_request_t*)) {
   assert(serv != NULL);
   serv->port = port;
   serv->memused = 0;
+  serv->session_pool = (hs_pool_t){ };
+  serv->buf_pool = (hs_pool_t){ };
+  serv->response_pool = (hs_pool_t){ };
+  serv->header_pool = (hs_pool_t){ };
   serv->handler = hs_server_listen_cb;
   hs_server_init(serv);
   hs_generate_date_time(serv->date);
@@ -1241,6 +1341,24 @@ int http_server_loop(http_server_t* server) {
   return server->loop;
 }
 
+void hs_pool_free(hs_pool_t* pool) {
+  void* obj;
+  while ((obj = hs_pool_get(pool))) free(obj);
+}
+
+void http_server_free(http_server_t* server) {
+  close(server->socket);
+#ifndef KQUEUE
+  close(server->timerfd);
+#endif
+  close(server->loop);
+  hs_pool_free(&server->session_pool);
+  hs_pool_free(&server->buf_pool);
+  hs_pool_free(&server->response_pool);
+  hs_pool_free(&server->header_pool);
+  free(server);
+}
+
 // *** http request ***
 
 http_string_t http_get_token_string(http_request_t* request, int token_type) {
@@ -1398,9 +1516,28 @@ http_response_t* http_response_init() {
   return response;
 }
 
+http_response_t* http_request_response_init(http_request_t* request) {
+  http_server_t* server = request->server;
+  http_response_t* response = (http_response_t*)hs_pool_get(&server->response_pool);
+  if (!response) {
+    response = (http_response_t*)malloc(sizeof(http_response_t));
+    assert(response != NULL);
+  }
+  *response = (http_response_t){ };
+  response->status = 200;
+  response->server = server;
+  return response;
+}
+
 void http_response_header(http_response_t* response, char const * key, char const * value) {
-  http_header_t* header = (http_header_t*)malloc(sizeof(http_header_t));
-  assert(header != NULL);
+  http_header_t* header = NULL;
+  if (response->server) {
+    header = (http_header_t*)hs_pool_get(&response->server->header_pool);
+  }
+  if (!header) {
+    header = (http_header_t*)malloc(sizeof(http_header_t));
+    assert(header != NULL);
+  }
   header->key = key;
   header->value = value;
   http_header_t* prev = response->headers;
@@ -1424,13 +1561,13 @@ typedef struct {
   int64_t* memused;
 } grwprintf_t;
 
-void grwprintf_init(grwprintf_t* ctx, int capacity, int64_t* memused) {
-  ctx->memused = memused;
+// The buffer comes from the server pool; it becomes the session's write
+// buffer and goes back to the pool once written.
+void grwprintf_init(grwprintf_t* ctx, http_server_t* server) {
+  ctx->memused = &server->memused;
   ctx->size = 0;
-  ctx->buf = (char*)malloc(capacity);
-  *ctx->memused += capacity;
-  assert(ctx->buf != NULL);
-  ctx->capacity = capacity;
+  ctx->buf = hs_buf_get(server);
+  ctx->capacity = HTTP_POOL_BUF_SIZE;
 }
 
 void grwmemcpy(grwprintf_t* ctx, char const * src, int size) {
@@ -1500,14 +1637,15 @@ void http_respond_headers(
 }
 
 void http_end_response(http_request_t* request, http_response_t* response, grwprintf_t* printctx) {
+  http_server_t* server = response->server;
   http_header_t* header = response->headers;
   while (header) {
     http_header_t* tmp = header;
     header = tmp->next;
-    free(tmp);
+    if (!server || !hs_pool_put(&server->header_pool, tmp)) free(tmp);
   }
   hs_free_buffer(request);
-  free(response);
+  if (!server || !hs_pool_put(&server->response_pool, response)) free(response);
   request->stream.buf = printctx->buf;
   request->stream.total_bytes = 0;
   request->stream.length = printctx->size;
@@ -1518,7 +1656,7 @@ void http_end_response(http_request_t* request, http_response_t* response, grwpr
 
 void http_respond(http_request_t* request, http_response_t* response) {
   grwprintf_t printctx;
-  grwprintf_init(&printctx, HTTP_RESPONSE_BUF_SIZE, &request->server->memused);
+  grwprintf_init(&printctx, request->server);
   http_respond_headers(request, response, &printctx);
   if (response->body) {
     grwmemcpy(&printctx, response->body, response->content_length);
@@ -1532,7 +1670,7 @@ void http_respond_chunk(
   void (*cb)(http_request_t*)
 ) {
   grwprintf_t printctx;
-  grwprintf_init(&printctx, HTTP_RESPONSE_BUF_SIZE, &request->server->memused);
+  grwprintf_init(&printctx, request->server);
   if (!HTTP_FLAG_CHECK(request->flags, HTTP_CHUNKED_RESPONSE)) {
     HTTP_FLAG_SET(request->flags, HTTP_CHUNKED_RESPONSE);
     http_response_header(response, "Transfer-Encoding", "chunked");
@@ -1547,7 +1685,7 @@ void http_respond_chunk(
 
 void http_respond_chunk_end(http_request_t* request, http_response_t* response) {
   grwprintf_t printctx;
-  grwprintf_init(&printctx, HTTP_RESPONSE_BUF_SIZE, &request->server->memused);
+  grwprintf_init(&printctx, request->server);
   grwprintf(&printctx, "0\r\n");
   http_buffer_headers(request, response, &printctx);
   grwprintf(&printctx, "\r\n");
@@ -12,7 +12,9 @@
 #include <unordered_set>
 #include <vector>
 
+#include "Barrier.h"
 #include "BenchmarkUtil.h"
+#include "LivenessDetector.h"
 #include "PartitionedFIFOScheduler.h"
 #include "PartitionedLocalFIFOScheduler.h"
 #include "PartitionedFIFOTaskScheduler.h"
@@ -21,6 +23,9 @@
 #include "RandomGenerator.h"
 #include "SinglePartitionedFIFOTaskScheduler.h"
 #include "SparkScheduler.h"
+#include "TaskJanitor.h"
+#include "ThreadPlacement.h"
+#include "VoltdbResultDecoder.h"
 #include "VoltdbSchedulerUtil.h"
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ProcedureCallback.hpp"
@@ -68,6 +73,12 @@ static std::string reqDist = kNoDist;  // by default, send as fast as possible.
 
 static bool mainFinished = false;  // Control whether to stop the experiment.
 
+// Warm-up calls per scheduler thread before the measurement starts.
+static int warmupRounds = 10;
+
+// Scheduler threads and runBenchmark wait here once connected and warmed up.
+static Barrier* readyBarrier = nullptr;
+
 // Record latencies in a single big array.
 static double* schedLatencies;
 // The current index of the schedLatencies array.
@@ -95,6 +106,24 @@ static std::string scheduleAlgo = kFifoAlgo;
 // Max outstanding requests per thread.
 static int maxOutstanding = 1;
 
+// Retention of completed tasks for the task janitor; negative disables it.
+static int64_t janitorRetentionMsec = -1;
+
+// Heartbeat timeout after which the liveness detector declares a worker dead
+// and requeues its tasks; 0 disables it.
+static int64_t livenessTimeoutMsec = 0;
+
+// If true, the liveness detector also requeues tasks whose lease expired.
+static bool expireLeases = false;
+
+// If false, queueing a task skips the IdleWorker lookup, for runs where no
+// worker parks waiting for a wakeup push.
+static bool pushWakeup = true;
+
+// If true, the schedulers split the server hosts between them instead of
+// each connecting to all of them.
+static bool splitHosts = false;
+
 // If true, truncate tables after execution.
 static bool cleanDB = false;
 
@@ -137,9 +166,7 @@ public:
     // TODO: figure out a better way to measure async client side latency.
     double latency = (double)response.clusterRoundTripTime() * 1000.0;
     schedLatencies[aryIndex] = latency;
-    std::vector<voltdb::Table> results = response.results();
-    voltdb::Row row = results[0].iterator().next();
-    DbosId selectedWorker = row.getInt64(0);
+    DbosId selectedWorker = VoltdbResultDecoder::getScalarInt64(response);
     assert(selectedWorker >= 0);
 
     outCnt_--;
@@ -179,10 +206,14 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
   } else {
     std::cerr << "Unsupported scheduler algorithm: " << algo << "\n";
   }
+  if (scheduler != nullptr) { scheduler->setPushWakeup(pushWakeup); }
 
   return scheduler;
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Scheduler thread.
  * For now, it will simply select a worker and decrease it's capacity.
@@ -190,14 +221,28 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
  */
 static void SchedulerThread(const int schedulerId,
                             const std::string& serverAddr) {
+  placement.pin(schedulerId, "scheduler");
   // Create a local VoltDB client.
   voltdb::Client voltdbClient =
       VoltdbSchedulerUtil::createVoltdbClient(kTestUser, kTestPwd);
 
+  // Schedulers connect in parallel, each to all hosts. With -S each one
+  // connects to its share of the hosts only, which shortens the setup but
+  // routes every procedure of a scheduler through fewer hosts.
+  std::string hosts = serverAddr;
+  if (splitHosts) {
+    hosts = VoltdbSchedulerUtil::hostsForClient(serverAddr, schedulerId,
+                                                numSchedulers);
+  }
   VoltdbSchedulerUtil* scheduler =
-      constructScheduler(&voltdbClient, serverAddr, scheduleAlgo);
+      constructScheduler(&voltdbClient, hosts, scheduleAlgo);
   assert(scheduler != nullptr);
-  std::cout << "Scheduler: " << schedulerId << " started\n";
+  if (!scheduler->warmup(warmupRounds)) {
+    std::cerr << "[Warning]: scheduler " << schedulerId
+              << " failed to warm up\n";
+  }
+  std::cout << "Scheduler: " << schedulerId << " ready\n";
+  readyBarrier->wait();
   boost::shared_ptr<SchedulerCallback> callback(
       new SchedulerCallback(maxOutstanding));
   callback->outCnt_ = 0;
@@ -290,18 +335,40 @@ static bool runBenchmark(const std::string& serverAddr,
   std::vector<std::thread*> schedulerThreads;  // Parallel schedulers.
 
   // Initialize measurement arrays.
-  uint64_t currTime = BenchmarkUtil::getCurrTimeUsec();
-  timeStampsUsec.push_back(currTime);
   schedLatencies = new double[kMaxEntries];
   memset(schedLatencies, 0, kMaxEntries * sizeof(double));
   schedLatsArrayIndex.store(0);
   schedIndices.push_back(0);
 
-  // Start scheduler threads.
+  // Start scheduler threads. They connect and warm up in parallel; the clock
+  // starts only after all of them are ready.
+  readyBarrier = new Barrier(numSchedulers + 1);
+  uint64_t currTime = BenchmarkUtil::getCurrTimeUsec();
   for (int i = 0; i < numSchedulers; ++i) {
     schedulerThreads.push_back(
         new std::thread(&SchedulerThread, i, serverAddr));
   }
+  readyBarrier->wait();
+
+  // Purge completed tasks in the background while the benchmark runs.
+  TaskJanitor* janitor = nullptr;
+  if (janitorRetentionMsec >= 0) {
+    janitor = new TaskJanitor(serverAddr, kTestUser, kTestPwd, partitions,
+                              janitorRetentionMsec);
+    janitor->start();
+  }
+  // Requeue the tasks of workers that stop beating or renewing leases.
+  LivenessDetector* detector = nullptr;
+  if (livenessTimeoutMsec > 0 || expireLeases) {
+    detector = new LivenessDetector(serverAddr, kTestUser, kTestPwd,
+                                    partitions, livenessTimeoutMsec,
+                                    expireLeases);
+    detector->start();
+  }
+  uint64_t readyTime = BenchmarkUtil::getCurrTimeUsec();
+  std::cerr << "All schedulers ready after " << (readyTime - currTime) / 1000
+            << " msec\n";
+  timeStampsUsec.push_back(readyTime);
 
   std::string cmd;
   if (outputCpuUsage) {  // Output CPU usage stats from `top` to a .txt file
@@ -328,6 +395,8 @@ static bool runBenchmark(const std::string& serverAddr,
     schedulerThreads[i]->join();
     delete schedulerThreads[i];
   }
+  if (janitor != nullptr) { delete janitor; }
+  if (detector != nullptr) { delete detector; }
 
   // Processing the results.
   std::cerr << "Post processing results...\n";
@@ -336,10 +405,15 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // Clean up.
   delete[] schedLatencies;
   schedLatencies = nullptr;
+  delete readyBarrier;
+  readyBarrier = nullptr;
   timeStampsUsec.clear();
   return true;
 }
@@ -390,6 +464,17 @@ static void Usage(char** argv, const std::string& msg = "") {
             << " msec\n";
   std::cerr << "\t-t <total execution time>: default " << totalExecTimeMsec
             << " msec\n";
+  std::cerr << "\t-w <warm-up calls per scheduler>: default " << warmupRounds
+            << "\n";
+  std::cerr << "\t-J <retention of completed tasks (msec)>: run the task "
+            << "janitor; default disabled\n";
+  std::cerr << "\t-L <worker heartbeat timeout (msec)>: requeue the tasks of "
+            << "dead workers; default disabled\n";
+  std::cerr << "\t-e: requeue running tasks whose lease expired\n";
+  std::cerr << "\t-K: workers do not park for wakeup pushes; skip the "
+            << "idle-worker lookup\n";
+  std::cerr << "\t-S: split the servers between schedulers instead of "
+            << "connecting each scheduler to all of them\n";
   std::cerr << "\t-N <number of parallel schedulers (threads)>: default "
             << numSchedulers << "\n";
   std::cerr << "\t-W <number of workers (#rows in table)>: default "
@@ -414,17 +499,23 @@ static void Usage(char** argv, const std::string& msg = "") {
   for (auto&& it : kAlgorithms) { std::cerr << it << " "; }
   std::cerr << ")> default " << scheduleAlgo << "\n";
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("synthetic_scheduler_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hxXco:s:i:t:N:W:C:P:A:T:p:R:D:m:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hKSxXceo:s:i:t:w:J:L:N:W:C:P:A:T:p:R:D:m:",
+                            kLongOptions, nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -438,6 +529,18 @@ int main(int argc, char** argv) {
       case 't':
         totalExecTimeMsec = atoi(optarg);
         break;
+      case 'w':
+        warmupRounds = atoi(optarg);
+        break;
+      case 'J':
+        janitorRetentionMsec = atoll(optarg);
+        break;
+      case 'L':
+        livenessTimeoutMsec = atoll(optarg);
+        break;
+      case 'e':
+        expireLeases = true;
+        break;
       case 'N':
         numSchedulers = atoi(optarg);
         break;
@@ -465,6 +568,12 @@ int main(int argc, char** argv) {
       case 'D':
         reqDist = optarg;
         break;
+      case 'K':
+        pushWakeup = false;
+        break;
+      case 'S':
+        splitHosts = true;
+        break;
       case 'x':
         cleanDB = true;
         break;
@@ -477,6 +586,11 @@ int main(int argc, char** argv) {
       case 'c':
         outputCpuUsage = true;
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -499,9 +613,20 @@ int main(int argc, char** argv) {
   std::cerr << "Worker capacity: " << workerCapacity << std::endl;
   std::cerr << "Partitions: " << partitions << std::endl;
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
   std::cerr << "Total execution time: " << totalExecTimeMsec << " msec\n";
+  std::cerr << "Warm-up calls per scheduler: " << warmupRounds << "\n";
+  if (janitorRetentionMsec >= 0) {
+    std::cerr << "Completed task retention: " << janitorRetentionMsec
+              << " msec\n";
+  }
+  if (livenessTimeoutMsec > 0) {
+    std::cerr << "Worker heartbeat timeout: " << livenessTimeoutMsec
+              << " msec\n";
+  }
+  if (expireLeases) { std::cerr << "Expire task leases" << std::endl; }
   auto distIt = kDists.find(reqDist);
   if (distIt == kDists.end()) {
     std::cerr << "Unsupported distribution type: " << reqDist << "\n";
@@ -18,6 +18,7 @@
 #include "PushFIFOScheduler.h"
 #include "SinglePartitionedFIFOTaskScheduler.h"
 #include "SparkScheduler.h"
+#include "ThreadPlacement.h"
 #include "VoltdbSchedulerUtil.h"
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ProcedureCallback.hpp"
@@ -166,8 +167,9 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
         voltdbClient, serverAddr, partitions, numTasks, workerCapacity,
         numWorkers, probMultiTx);
   } else if (algo == kSparkAlgo) {
-    scheduler = new SparkScheduler(voltdbClient, serverAddr, partitions,
-                                   workerCapacity, numWorkers);
+    scheduler = new SparkScheduler(voltdbClient, serverAddr, kTestUser,
+                                   kTestPwd, partitions, workerCapacity,
+                                   numWorkers);
   } else if (algo == kScanTaskAlgo) {
     scheduler = new PartitionedScanTask(voltdbClient, serverAddr, partitions,
                                         numTasks, numWorkers, probMultiTx);
@@ -181,11 +183,15 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
   return scheduler;
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Sender thread.
  * For now, it will simply insert messages to the DB.
  */
 static void SenderThread(const int schedulerId, const std::string& serverAddr) {
+  placement.pin(schedulerId, "sender");
   // Create a local VoltDB client.
   voltdb::Client voltdbClient =
       VoltdbSchedulerUtil::createVoltdbClient(kTestUser, kTestPwd);
@@ -282,6 +288,9 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // Clean up.
   delete[] msgLatencies;
@@ -346,17 +355,23 @@ static void Usage(char** argv, const std::string& msg = "") {
             << "\n";
   // Print all options here.
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("message_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hxXbo:s:i:t:N:P:d:m:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hxXbo:s:i:t:N:P:d:m:", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -391,6 +406,11 @@ int main(int argc, char** argv) {
       case 'b':
         broadcast = true;
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -401,6 +421,7 @@ int main(int argc, char** argv) {
   std::cerr << "Parallel sender threads: " << numSenders << std::endl;
   std::cerr << "Partitions: " << partitions << std::endl;
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
   std::cerr << "Total execution time: " << totalExecTimeMsec << " msec\n";
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "BenchmarkUtil.h"
+#include "ThreadPlacement.h"
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ClientConfig.h"
 #include "voltdb-client-cpp/include/Parameter.hpp"
@@ -146,11 +147,15 @@ int dbos_recv(voltdb::Client* client, const int receiverID) {
   return results.rowCount();
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Sender thread.
  *
  */
 static void SenderThread(const int threadId, const std::string& serverAddr) {
+  placement.pin(threadId, "sender");
   // Create a local VoltDB client.
   voltdb::ClientConfig config(kTestUser, kTestPwd, voltdb::HASH_SHA1);
   voltdb::Client client = voltdb::Client::create(config);
@@ -238,6 +243,9 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // Clean up.
   delete[] msgLatencies;
@@ -277,17 +285,23 @@ static void Usage(char** argv, const std::string& msg = "") {
   std::cerr << "\t-M <number of parallel messages sent by each sender>: "
             << "default " << numMessages << "\n";
   std::cerr << "\t-m <message size>: default " << msg_size << std::endl;
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("dbos_ipc_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hxbo:s:i:t:N:M:m:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hxbo:s:i:t:N:M:m:", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -316,6 +330,11 @@ int main(int argc, char** argv) {
       case 'b':
         broadcast = true;
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -327,6 +346,7 @@ int main(int argc, char** argv) {
   std::cerr << "Parallel messages: " << numMessages << std::endl;
   std::cerr << "Message size: " << msg_size << " bytes" << std::endl;
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
   std::cerr << "Total execution time: " << totalExecTimeMsec << " msec\n";
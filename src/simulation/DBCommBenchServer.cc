@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "BenchmarkUtil.h"
+#include "ThreadPlacement.h"
 #include "voltdb-client-cpp/include/Client.h"
 #include "voltdb-client-cpp/include/ClientConfig.h"
 #include "voltdb-client-cpp/include/Parameter.hpp"
@@ -120,11 +121,15 @@ void dbos_send(voltdb::Client* client,
   client->run();
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Sender thread.
  *
  */
 static void ReceiverThread(const int threadId, const std::string& serverAddr) {
+  placement.pin(threadId - 100, "receiver");
   // Id of the client.
   int clientId = -1;
 
@@ -171,16 +176,22 @@ static void Usage(char** argv, const std::string& msg = "") {
   std::cerr << "\t-M <number of parallel messages expected by each receiver>: "
             << "default " << numMessages << "\n";
   std::cerr << "\t-m <message size>: default " << msg_size << std::endl;
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "h:s:N:M:m:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "h:s:N:M:m:", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 's':
         serverAddr = optarg;
@@ -194,6 +205,11 @@ int main(int argc, char** argv) {
       case 'm':
         msg_size = atoi(optarg);
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -205,6 +221,7 @@ int main(int argc, char** argv) {
   std::cerr << "Parallel messages: " << numMessages << std::endl;
   std::cerr << "Message size: " << msg_size << " bytes" << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
 
   std::vector<std::thread*> receiverThreads;  // Parallel receivers.
 
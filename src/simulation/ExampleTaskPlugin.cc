@@ -0,0 +1,44 @@
+// Example task plugin for SyntheticWorker, e.g.
+//   SyntheticWorker -g ./libExampleTaskPlugin.so -T checksum -Y 4096
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "TaskPlugin.h"
+
+// The result is stored so the work is not optimized away.
+static volatile uint64_t resultSink;
+
+// FNV-1a hash of the payload: one pass over the bytes, like validating a
+// request. The 8-byte hash is the result.
+static int checksum(const DbosTaskArgs* args) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < args->payloadSize; ++i) {
+    hash ^= (unsigned char)args->payload[i];
+    hash *= 1099511628211ULL;
+  }
+  args->setResult(args->resultContext, (const char*)&hash, sizeof(hash));
+  return 0;
+}
+
+// Sort a private copy of the payload as 32-bit integers, like a task that
+// decodes its arguments and computes on them.
+static int sortPayload(const DbosTaskArgs* args) {
+  std::vector<uint32_t> values(args->payloadSize / sizeof(uint32_t));
+  if (values.empty()) { return 0; }
+  memcpy(values.data(), args->payload, values.size() * sizeof(uint32_t));
+  std::sort(values.begin(), values.end());
+  resultSink = values[values.size() / 2];
+  return 0;
+}
+
+extern "C" int dbos_task_plugin_init(const DbosTaskRegistrar* registrar) {
+  if (registrar->abiVersion != DBOS_TASK_PLUGIN_ABI_VERSION) { return -1; }
+  if (registrar->registerTask(registrar->registry, "checksum", checksum) != 0 ||
+      registrar->registerTask(registrar->registry, "sort", sortPayload) != 0) {
+    return -1;
+  }
+  return 0;
+}
@@ -8,6 +8,7 @@
 #include <grpcpp/grpcpp.h>
 
 #include "BenchmarkUtil.h"
+#include "ThreadPlacement.h"
 #include "ipc_bench.grpc.pb.h"
 
 using grpc::Server;
@@ -95,9 +96,13 @@ static std::unique_ptr<ipcbench::IpcBench::Stub> addrToStub(
   return stub;
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 // Broadcaster thread.
 static void BroadcasterThread(const int serverPort,
                               const std::string& serverAddr) {
+  placement.pin(serverPort - basePort, "sender");
   // Broadcast benchmark, with gRPC async client.
   // Send parallel messages to different N receivers.
   // Then wait responses of all N messages.
@@ -176,6 +181,7 @@ static void BroadcasterThread(const int serverPort,
 
 // Ping-pong sender thread.
 static void SenderThread(const int serverPort, const std::string& serverAddr) {
+  placement.pin(serverPort - basePort, "sender");
   // Ping-pong benchmark, with gRPC async client.
   // Send M outstanding message to a single receiver.
   // Then wait responses of all M messages.
@@ -251,6 +257,7 @@ static void SenderThread(const int serverPort, const std::string& serverAddr) {
 // Streaming Ping-pong sender thread.
 static void StreamSenderThread(const int serverPort,
                                const std::string& serverAddr) {
+  placement.pin(serverPort - basePort, "sender");
   // Stream (bi-direction) ping-pong benchmark, with gRPC sync client.
   // Send M outstanding message to a single receiver.
   // Then wait responses of all M messages.
@@ -386,6 +393,9 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // Clean up.
   delete[] msgLatencies;
@@ -417,17 +427,23 @@ static void Usage(char** argv, const std::string& msg = "") {
       << numReceivers << "\n";
   std::cerr << "\t-S: run streaming ping-pong benchmark\n";
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("grpc_bench_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hbo:s:p:i:t:N:M:m:R:S")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hbo:s:p:i:t:N:M:m:R:S", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -462,6 +478,11 @@ int main(int argc, char** argv) {
       case 'S':
         streamRpc = true;
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -473,6 +494,7 @@ int main(int argc, char** argv) {
   std::cerr << "Parallel outstanding messages: " << numMessages << std::endl;
   std::cerr << "Message size: " << msg_size << " bytes" << std::endl;
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "Server address: " << serverAddr << std::endl;
   std::cerr << "Base port: " << basePort << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
@@ -8,6 +8,7 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include "ThreadPlacement.h"
 #include "ipc_bench.grpc.pb.h"
 
 using grpc::Server;
@@ -113,12 +114,17 @@ static void Usage(char** argv, const std::string& msg = "") {
             << numReceivers << "\n";
   // Print all options here.
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 // Receiver thread.
 static void ReceiverThread(const int serverPort) {
+  placement.pin(serverPort - basePort, "receiver");
   // Start a gRPC server.
   std::string addr = "0.0.0.0:" + std::to_string(serverPort);
   ipcbench::IpcBenchImpl service;
@@ -138,10 +144,15 @@ static void ReceiverThread(const int serverPort) {
   recvServer->Wait();
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hp:N:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hp:N:", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 'p':
         basePort = atoi(optarg);
@@ -149,6 +160,11 @@ int main(int argc, char** argv) {
       case 'N':
         numReceivers = atoi(optarg);
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -158,6 +174,7 @@ int main(int argc, char** argv) {
 
   std::cerr << "Parallel receiver threads: " << numReceivers << std::endl;
   std::cerr << "Base port: " << basePort << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
 
   std::vector<std::thread*> receiverThreads;  // Parallel receivers.
 
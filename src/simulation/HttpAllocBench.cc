@@ -0,0 +1,229 @@
+// Microbenchmark for heap allocations of the embedded HTTP server.
+// Keep-alive clients send task pushes like the ones MockHTTPWorker serves, and
+// the server thread counts every malloc/calloc/realloc it makes per request.
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtil.h"
+#include "ThreadPlacement.h"
+
+#define HTTPSERVER_IMPL
+#include "httpserver.h"
+
+// glibc's allocator entry points, used by the counting wrappers below.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+}
+
+// Only allocations of the server thread are counted.
+static thread_local bool countAllocs = false;
+static std::atomic<uint64_t> numAllocs(0);
+
+extern "C" {
+void* malloc(size_t size) {
+  if (countAllocs) { numAllocs.fetch_add(1, std::memory_order_relaxed); }
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+  if (countAllocs) { numAllocs.fetch_add(1, std::memory_order_relaxed); }
+  return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  if (countAllocs) { numAllocs.fetch_add(1, std::memory_order_relaxed); }
+  return __libc_realloc(ptr, size);
+}
+}
+
+// Number of client connections.
+static int numConnections = 4;
+
+// Number of requests sent on each connection.
+static int numRequests = 100000;
+
+// Requests served before allocations are counted as steady state.
+static int numWarmupRequests = 1000;
+
+// Server port.
+static int serverPort = 9190;
+
+// Use http_response_init instead of the pooled responses.
+static bool unpooledResponses = false;
+
+// Placement of the server (slot 0) and client threads on CPUs (--pin).
+static ThreadPlacement placement;
+
+static std::atomic<bool> stopServer(false);
+static uint64_t handledRequests = 0;  // only touched by the server thread
+static uint64_t warmupAllocs = 0;     // allocations after the warm-up
+
+#define RESPONSE "Hello, World!"
+static void handleRequest(struct http_request_s* request) {
+  struct http_string_s taskIdRaw = http_request_header(request, "taskID");
+  (void)taskIdRaw;
+  struct http_response_s* response = unpooledResponses
+                                         ? http_response_init()
+                                         : http_request_response_init(request);
+  http_response_status(response, 200);
+  http_response_header(response, "Content-Type", "text/plain");
+  http_response_body(response, RESPONSE, sizeof(RESPONSE) - 1);
+  http_respond(request, response);
+  if (++handledRequests == (uint64_t)numWarmupRequests) {
+    warmupAllocs = numAllocs.load();
+  }
+}
+
+static void ServerThread() {
+  placement.pin(0, "server");
+  countAllocs = true;
+  struct http_server_s* server = http_server_init(serverPort, handleRequest);
+  http_server_listen_poll(server);
+  while (!stopServer.load()) { http_server_poll(server); }
+  countAllocs = false;
+}
+
+// Send numRequests keep-alive requests and wait for each response.
+static void ClientThread(int clientId) {
+  placement.pin(1 + clientId, "client");
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  int flag = 1;
+  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(serverPort);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  while (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    usleep(1000);
+  }
+
+  char buffer[4096];
+  for (int i = 0; i < numRequests; ++i) {
+    std::string req = "GET / HTTP/1.1\r\nHost: localhost\r\ntaskID: " +
+                      std::to_string(clientId * numRequests + i) + "\r\n\r\n";
+    if (write(sock, req.data(), req.size()) != (ssize_t)req.size()) {
+      std::cerr << "Client " << clientId << " failed to send" << std::endl;
+      break;
+    }
+    // Every response ends with the body.
+    size_t received = 0;
+    while (received < sizeof(RESPONSE) - 1 ||
+           memcmp(buffer + received - (sizeof(RESPONSE) - 1), RESPONSE,
+                  sizeof(RESPONSE) - 1) != 0) {
+      ssize_t bytes = read(sock, buffer + received, sizeof(buffer) - received);
+      if (bytes <= 0) {
+        std::cerr << "Client " << clientId << " lost the connection"
+                  << std::endl;
+        close(sock);
+        return;
+      }
+      received += bytes;
+    }
+  }
+  close(sock);
+}
+
+static void Usage(char** argv, const std::string& msg = "") {
+  if (!msg.empty()) { std::cerr << "ERROR: " << msg << std::endl; }
+  std::cerr << "Usage: " << argv[0] << " [options]" << std::endl;
+  std::cerr << "\t-c <number of connections>: default " << numConnections
+            << std::endl;
+  std::cerr << "\t-n <requests per connection>: default " << numRequests
+            << std::endl;
+  std::cerr << "\t-w <warm-up requests>: default " << numWarmupRequests
+            << std::endl;
+  std::cerr << "\t-p <server port>: default " << serverPort << std::endl;
+  std::cerr << "\t-u: allocate responses with http_response_init"
+            << std::endl;
+  ThreadPlacement::printUsage(std::cerr);
+  exit(1);
+}
+
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
+int main(int argc, char** argv) {
+  int opt;
+  while ((opt = getopt_long(argc, argv, "hc:n:w:p:u", kLongOptions,
+                            nullptr)) != -1) {
+    switch (opt) {
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
+      case 'h':
+        Usage(argv);
+        break;
+      case 'c':
+        numConnections = atoi(optarg);
+        break;
+      case 'n':
+        numRequests = atoi(optarg);
+        break;
+      case 'w':
+        numWarmupRequests = atoi(optarg);
+        break;
+      case 'p':
+        serverPort = atoi(optarg);
+        break;
+      case 'u':
+        unpooledResponses = true;
+        break;
+      default:
+        Usage(argv, "Unrecognized option");
+    }
+  }
+  if (numConnections <= 0 || numRequests <= 0) {
+    Usage(argv, "Connections and requests must be positive");
+  }
+  if ((uint64_t)numWarmupRequests >= (uint64_t)numConnections * numRequests) {
+    Usage(argv, "Warm-up must be shorter than the run");
+  }
+
+  std::thread server(ServerThread);
+  uint64_t startUsec = BenchmarkUtil::getCurrTimeUsec();
+  std::vector<std::thread> clients;
+  for (int i = 0; i < numConnections; ++i) {
+    clients.emplace_back(ClientThread, i);
+  }
+  for (auto& client : clients) { client.join(); }
+  uint64_t elapsedUsec = BenchmarkUtil::getCurrTimeUsec() - startUsec;
+  stopServer.store(true);
+  server.join();
+
+  uint64_t totalAllocs = numAllocs.load();
+  uint64_t steadyRequests = handledRequests - numWarmupRequests;
+  std::cout << "Requests: " << handledRequests << " over " << numConnections
+            << " connections, "
+            << (double)handledRequests * 1000000.0 / elapsedUsec << " req/s"
+            << std::endl;
+  std::cout << "Responses: " << (unpooledResponses ? "unpooled" : "pooled")
+            << std::endl;
+  std::cout << "Server allocations: " << totalAllocs << " total, "
+            << (double)totalAllocs / handledRequests << " per request"
+            << std::endl;
+  std::cout << "After " << numWarmupRequests << " warm-up requests: "
+            << totalAllocs - warmupAllocs << " allocations, "
+            << (double)(totalAllocs - warmupAllocs) / steadyRequests
+            << " per request" << std::endl;
+  if (placement.enabled()) {
+    std::cout << "Thread placement (" << placement.spec() << "):\n";
+    placement.printResults(std::cout);
+  }
+  return 0;
+}
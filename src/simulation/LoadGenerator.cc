@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "BenchmarkUtil.h"
+#include "HeartbeatAggregator.h"
 #include "PartitionedFIFOScheduler.h"
 #include "PartitionedFIFOTaskScheduler.h"
 #include "PartitionedScanTask.h"
@@ -19,6 +20,8 @@
 #include "SchedulerServer.h"
 #include "SinglePartitionedFIFOTaskScheduler.h"
 #include "SparkScheduler.h"
+#include "TaskProtobuf.h"
+#include "ThreadPlacement.h"
 #include "VoltdbSchedulerUtil.h"
 #include "voltdb-client-cpp/include/Client.h"
 
@@ -55,6 +58,10 @@ static int totalExecTimeMsec = 10000;  // 10sec in ms.
 // Wait interval between requests.
 static int arrivalDelay = 0;
 
+// Random payload sent with every task, empty = none.
+static size_t payloadBytes = 0;
+static std::string payload;
+
 static bool mainFinished = false;  // Control whether to stop the experiment.
 
 // Record latencies in a single big array.
@@ -87,6 +94,15 @@ static std::string scheduleAlgo = kFifoAlgo;
 // If true, truncate tables after execution.
 static bool cleanDB = false;
 
+// How the spark workers serve tasks; by default with the sync gRPC server.
+static MockGRPCWorker::ServerOptions workerOptions;
+
+// If true, spark schedulers send tasks over one Dispatch stream per worker.
+static bool streamDispatch = false;
+
+// Heartbeat interval of the spark workers; 0 disables heartbeats.
+static int heartbeatIntervalMsec = 0;
+
 /*
  * Return a constructed scheduler instance based on algorithm.
  */
@@ -106,8 +122,9 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
         voltdbClient, serverAddr, partitions, numTasks, workerCapacity,
         numWorkers, probMultiTx);
   } else if (algo == kSparkAlgo) {
-    scheduler = new SparkScheduler(voltdbClient, serverAddr, partitions,
-                                   workerCapacity, numWorkers);
+    scheduler = new SparkScheduler(voltdbClient, serverAddr, kTestUser,
+                                   kTestPwd, partitions, workerCapacity,
+                                   numWorkers, workerOptions, streamDispatch);
   } else if (algo == kScanTaskAlgo) {
     scheduler = new PartitionedScanTask(voltdbClient, serverAddr, partitions,
                                         numTasks, numWorkers, probMultiTx);
@@ -121,12 +138,17 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
   return scheduler;
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Scheduler thread.
  * For now, it will simply select a worker and decrease it's capacity.
  * We will need to add worker (consumer) to mark tasks finished.
  */
-static void ClientThread(std::vector<std::string> schedulerAddresses) {
+static void ClientThread(const int clientId,
+                         std::vector<std::string> schedulerAddresses) {
+  placement.pin(clientId, "client");
   std::vector<std::shared_ptr<Channel>> channels;
   for (std::string addr : schedulerAddresses) {
     std::shared_ptr<Channel> channel =
@@ -147,6 +169,8 @@ static void ClientThread(std::vector<std::string> schedulerAddresses) {
     Task task;
     task.targetData = rand() % numWorkers;
     task.execTime = 1000;
+    task.payload = payload.data();
+    task.payloadSize = payload.size();
     dbos_scheduler::SubmitTaskRequest st_request = taskToProtobuf(&task);
     dbos_scheduler::SubmitTaskResponse st_reply;
 
@@ -211,7 +235,8 @@ static bool runBenchmark(const std::string& serverAddr,
 
   // Start scheduler threads.
   for (int i = 0; i < numClientThreads; ++i) {
-    clientThreads.push_back(new std::thread(&ClientThread, schedulerAddresses));
+    clientThreads.push_back(
+        new std::thread(&ClientThread, i, schedulerAddresses));
   }
 
   currTime = BenchmarkUtil::getCurrTimeUsec();
@@ -240,6 +265,9 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   delete[] schedLatencies;
   schedLatencies = nullptr;
@@ -298,8 +326,20 @@ static void Usage(char** argv, const std::string& msg = "") {
             << numWorkers << "\n";
   std::cerr << "\t-C <worker capacity>: default " << workerCapacity << "\n";
   std::cerr << "\t-T <number of tasks>: default " << numTasks << "\n";
+  std::cerr << "\t-Y <task payload size>: default " << payloadBytes
+            << " bytes\n";
   std::cerr << "\t-P <partitions>: default " << partitions << "\n";
   std::cerr << "\t-d <arrival delay>: default " << arrivalDelay << "\n";
+  std::cerr << "\t-G <completion queue threads of the async worker server, "
+               "0 for the sync server>: default "
+            << workerOptions.numCqThreads << "\n";
+  std::cerr << "\t-E <executor threads of the async worker server, 0 to "
+               "complete tasks from a timer wheel>: default "
+            << workerOptions.numExecutors << "\n";
+  std::cerr << "\t-R: dispatch tasks over one stream per worker instead of "
+               "one call per task\n";
+  std::cerr << "\t-H <worker heartbeat interval, 0 = none>: default "
+            << heartbeatIntervalMsec << " msec\n";
   std::cerr
       << "\t-p <probability of multi-partition transaction> (0-1.0): default "
       << probMultiTx << "\n";
@@ -308,17 +348,23 @@ static void Usage(char** argv, const std::string& msg = "") {
   for (auto&& it : kAlgorithms) { std::cerr << it << " "; }
   std::cerr << ")> default " << scheduleAlgo << "\n";
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("synthetic_scheduler_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hxo:s:i:t:N:S:W:C:P:A:T:p:d:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hxo:s:i:t:N:S:W:C:P:A:T:Y:p:G:E:RH:d:",
+                            kLongOptions, nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -353,14 +399,34 @@ int main(int argc, char** argv) {
       case 'T':
         numTasks = atoi(optarg);
         break;
+      case 'Y':
+        payloadBytes = (size_t)atol(optarg);
+        break;
       case 'p':
         probMultiTx = atof(optarg);
         break;
+      case 'G':
+        workerOptions.numCqThreads = atoi(optarg);
+        break;
+      case 'E':
+        workerOptions.numExecutors = atoi(optarg);
+        break;
+      case 'R':
+        streamDispatch = true;
+        break;
+      case 'H':
+        heartbeatIntervalMsec = atoi(optarg);
+        break;
       case 'd':
         arrivalDelay = atoi(optarg);
       case 'x':
         cleanDB = true;
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -382,11 +448,39 @@ int main(int argc, char** argv) {
             << "; schedulers: " << numSchedulers << std::endl;
   std::cerr << "Worker capacity: " << workerCapacity << std::endl;
   std::cerr << "Partitions: " << partitions << std::endl;
+  if (payloadBytes > 0) {
+    std::cerr << "Task payload: " << payloadBytes << " bytes" << std::endl;
+    payload.resize(payloadBytes);
+    for (char& c : payload) { c = (char)rand(); }
+  }
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
   std::cerr << "Total execution time: " << totalExecTimeMsec << " msec\n";
   std::cerr << "Arrival delay: " << arrivalDelay << " msec\n";
+  if (streamDispatch) { std::cerr << "Dispatch over streams" << std::endl; }
+  if (heartbeatIntervalMsec > 0) {
+    std::cerr << "Worker heartbeat interval: " << heartbeatIntervalMsec
+              << " msec\n";
+  }
+  if (workerOptions.numCqThreads > 0) {
+    std::cerr << "Async worker server: " << workerOptions.numCqThreads
+              << " completion queue threads; "
+              << (workerOptions.numExecutors > 0
+                      ? std::to_string(workerOptions.numExecutors) +
+                            " executor threads"
+                      : std::string("timer wheel"))
+              << std::endl;
+  }
+
+  // The spark workers of this process share one heartbeat aggregator.
+  HeartbeatAggregator* heartbeat = nullptr;
+  if (heartbeatIntervalMsec > 0) {
+    heartbeat = new HeartbeatAggregator(serverAddr, heartbeatIntervalMsec);
+    heartbeat->start();
+    workerOptions.heartbeat = heartbeat;
+  }
 
   // 1) Initialize database state.
   bool res = setup(serverAddr);
@@ -410,6 +504,10 @@ int main(int argc, char** argv) {
       exit(1);
     }
   }
+  if (heartbeat != nullptr) {
+    delete heartbeat;
+    workerOptions.heartbeat = nullptr;
+  }
 
   return 0;
 }
@@ -11,6 +11,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "Barrier.h"
 #include "BenchmarkUtil.h"
 #include "PartitionedFIFOScheduler.h"
 #include "PartitionedLocalFIFOScheduler.h"
@@ -20,6 +21,8 @@
 #include "RandomGenerator.h"
 #include "SinglePartitionedFIFOTaskScheduler.h"
 #include "SparkScheduler.h"
+#include "TaskJanitor.h"
+#include "ThreadPlacement.h"
 #include "VoltdbSchedulerUtil.h"
 #include "voltdb-client-cpp/include/Client.h"
 
@@ -63,6 +66,12 @@ static std::string reqDist = kNoDist;  // by default, send as fast as possible.
 
 static bool mainFinished = false;  // Control whether to stop the experiment.
 
+// Warm-up calls per scheduler thread before the measurement starts.
+static int warmupRounds = 10;
+
+// Scheduler threads and runBenchmark wait here once connected and warmed up.
+static Barrier* readyBarrier = nullptr;
+
 // Record latencies in a single big array.
 static double* schedLatencies;
 // The current index of the schedLatencies array.
@@ -91,6 +100,21 @@ static const std::unordered_set<std::string> kAlgorithms = {
     kSparkAlgo, kScanTaskAlgo, kPushFifoAlgo};
 static std::string scheduleAlgo = kFifoAlgo;
 
+// Retention of completed tasks for the task janitor; negative disables it.
+static int64_t janitorRetentionMsec = -1;
+
+// Random payload sent with every task, empty = none.
+static size_t payloadBytes = 0;
+static std::string payload;
+
+// If false, queueing a task skips the IdleWorker lookup, for runs where no
+// worker parks waiting for a wakeup push.
+static bool pushWakeup = true;
+
+// If true, the schedulers split the server hosts between them instead of
+// each connecting to all of them.
+static bool splitHosts = false;
+
 // If true, truncate tables after execution.
 static bool cleanDB = false;
 
@@ -116,8 +140,9 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
         voltdbClient, serverAddr, partitions, numTasks, workerCapacity,
         numWorkers, probMultiTx);
   } else if (algo == kSparkAlgo) {
-    scheduler = new SparkScheduler(voltdbClient, serverAddr, partitions,
-                                   workerCapacity, numWorkers);
+    scheduler = new SparkScheduler(voltdbClient, serverAddr, kTestUser,
+                                   kTestPwd, partitions, workerCapacity,
+                                   numWorkers);
   } else if (algo == kScanTaskAlgo) {
     scheduler = new PartitionedScanTask(voltdbClient, serverAddr, partitions,
                                         numTasks, numWorkers, probMultiTx);
@@ -127,10 +152,14 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
   } else {
     std::cerr << "Unsupported scheduler algorithm: " << algo << "\n";
   }
+  if (scheduler != nullptr) { scheduler->setPushWakeup(pushWakeup); }
 
   return scheduler;
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Scheduler thread.
  * For now, it will simply select a worker and decrease it's capacity.
@@ -138,14 +167,28 @@ static VoltdbSchedulerUtil* constructScheduler(voltdb::Client* voltdbClient,
  */
 static void SchedulerThread(const int schedulerId,
                             const std::string& serverAddr) {
+  placement.pin(schedulerId, "scheduler");
   // Create a local VoltDB client.
   voltdb::Client voltdbClient =
       VoltdbSchedulerUtil::createVoltdbClient(kTestUser, kTestPwd);
 
+  // Schedulers connect in parallel, each to all hosts. With -S each one
+  // connects to its share of the hosts only, which shortens the setup but
+  // routes every procedure of a scheduler through fewer hosts.
+  std::string hosts = serverAddr;
+  if (splitHosts) {
+    hosts = VoltdbSchedulerUtil::hostsForClient(serverAddr, schedulerId,
+                                                numSchedulers);
+  }
   VoltdbSchedulerUtil* scheduler =
-      constructScheduler(&voltdbClient, serverAddr, scheduleAlgo);
+      constructScheduler(&voltdbClient, hosts, scheduleAlgo);
   assert(scheduler != nullptr);
-  std::cout << "Scheduler: " << schedulerId << " started\n";
+  if (!scheduler->warmup(warmupRounds)) {
+    std::cerr << "[Warning]: scheduler " << schedulerId
+              << " failed to warm up\n";
+  }
+  std::cout << "Scheduler: " << schedulerId << " ready\n";
+  readyBarrier->wait();
 
   // Inter-arrival latency generator.
   Generator* iaGen = nullptr;
@@ -197,6 +240,8 @@ static void SchedulerThread(const int schedulerId,
     Task* task = new Task;
     task->targetData = rand() % numWorkers;
     task->execTime = 1000;
+    task->payload = payload.data();
+    task->payloadSize = payload.size();
     auto status = scheduler->schedule(task);
     assert(status);
     delete task;
@@ -234,18 +279,32 @@ static bool runBenchmark(const std::string& serverAddr,
   std::vector<std::thread*> schedulerThreads;  // Parallel schedulers.
 
   // Initialize measurement arrays.
-  uint64_t currTime = BenchmarkUtil::getCurrTimeUsec();
-  timeStampsUsec.push_back(currTime);
   schedLatencies = new double[kMaxEntries];
   memset(schedLatencies, 0, kMaxEntries * sizeof(double));
   schedLatsArrayIndex.store(0);
   schedIndices.push_back(0);
 
-  // Start scheduler threads.
+  // Start scheduler threads. They connect and warm up in parallel; the clock
+  // starts only after all of them are ready.
+  readyBarrier = new Barrier(numSchedulers + 1);
+  uint64_t currTime = BenchmarkUtil::getCurrTimeUsec();
   for (int i = 0; i < numSchedulers; ++i) {
     schedulerThreads.push_back(
         new std::thread(&SchedulerThread, i, serverAddr));
   }
+  readyBarrier->wait();
+
+  // Purge completed tasks in the background while the benchmark runs.
+  TaskJanitor* janitor = nullptr;
+  if (janitorRetentionMsec >= 0) {
+    janitor = new TaskJanitor(serverAddr, kTestUser, kTestPwd, partitions,
+                              janitorRetentionMsec);
+    janitor->start();
+  }
+  uint64_t readyTime = BenchmarkUtil::getCurrTimeUsec();
+  std::cerr << "All schedulers ready after " << (readyTime - currTime) / 1000
+            << " msec\n";
+  timeStampsUsec.push_back(readyTime);
 
   currTime = BenchmarkUtil::getCurrTimeUsec();
   uint64_t endTime = currTime + (totalExecTimeMsec * 1000);
@@ -262,6 +321,7 @@ static bool runBenchmark(const std::string& serverAddr,
     schedulerThreads[i]->join();
     delete schedulerThreads[i];
   }
+  if (janitor != nullptr) { delete janitor; }
 
   // Processing the results.
   std::cerr << "Post processing results...\n";
@@ -270,10 +330,15 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // Clean up.
   delete[] schedLatencies;
   schedLatencies = nullptr;
+  delete readyBarrier;
+  readyBarrier = nullptr;
   timeStampsUsec.clear();
   return true;
 }
@@ -322,12 +387,22 @@ static void Usage(char** argv, const std::string& msg = "") {
             << " msec\n";
   std::cerr << "\t-t <total execution time>: default " << totalExecTimeMsec
             << " msec\n";
+  std::cerr << "\t-w <warm-up calls per scheduler>: default " << warmupRounds
+            << "\n";
+  std::cerr << "\t-J <retention of completed tasks (msec)>: run the task "
+            << "janitor; default disabled\n";
+  std::cerr << "\t-K: workers do not park for wakeup pushes; skip the "
+            << "idle-worker lookup\n";
+  std::cerr << "\t-S: split the servers between schedulers instead of "
+            << "connecting each scheduler to all of them\n";
   std::cerr << "\t-N <number of parallel schedulers (threads)>: default "
             << numSchedulers << "\n";
   std::cerr << "\t-W <number of workers (#rows in table)>: default "
             << numWorkers << "\n";
   std::cerr << "\t-C <worker capacity>: default " << workerCapacity << "\n";
   std::cerr << "\t-T <number of tasks>: default " << numTasks << "\n";
+  std::cerr << "\t-Y <task payload size>: default " << payloadBytes
+            << " bytes\n";
   std::cerr << "\t-P <partitions>: default " << partitions << "\n";
   std::cerr << "\t-R <request rate>: default " << reqPerSec << "\n";
   std::cerr << "\t-D <request distribution>: default " << reqDist
@@ -342,17 +417,23 @@ static void Usage(char** argv, const std::string& msg = "") {
   for (auto&& it : kAlgorithms) { std::cerr << it << " "; }
   std::cerr << ")> default " << scheduleAlgo << "\n";
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("synthetic_scheduler_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hxo:s:i:t:N:W:C:P:A:T:p:R:D:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hKSxo:s:i:t:w:J:N:W:C:P:A:T:Y:p:R:D:",
+                            kLongOptions, nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -366,6 +447,12 @@ int main(int argc, char** argv) {
       case 't':
         totalExecTimeMsec = atoi(optarg);
         break;
+      case 'w':
+        warmupRounds = atoi(optarg);
+        break;
+      case 'J':
+        janitorRetentionMsec = atoll(optarg);
+        break;
       case 'N':
         numSchedulers = atoi(optarg);
         break;
@@ -384,6 +471,9 @@ int main(int argc, char** argv) {
       case 'T':
         numTasks = atoi(optarg);
         break;
+      case 'Y':
+        payloadBytes = (size_t)atol(optarg);
+        break;
       case 'p':
         probMultiTx = atof(optarg);
         break;
@@ -393,9 +483,20 @@ int main(int argc, char** argv) {
       case 'D':
         reqDist = optarg;
         break;
+      case 'K':
+        pushWakeup = false;
+        break;
+      case 'S':
+        splitHosts = true;
+        break;
       case 'x':
         cleanDB = true;
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -417,10 +518,21 @@ int main(int argc, char** argv) {
             << std::endl;
   std::cerr << "Worker capacity: " << workerCapacity << std::endl;
   std::cerr << "Partitions: " << partitions << std::endl;
+  if (payloadBytes > 0) {
+    std::cerr << "Task payload: " << payloadBytes << " bytes" << std::endl;
+    payload.resize(payloadBytes);
+    for (char& c : payload) { c = (char)rand(); }
+  }
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
   std::cerr << "Total execution time: " << totalExecTimeMsec << " msec\n";
+  std::cerr << "Warm-up calls per scheduler: " << warmupRounds << "\n";
+  if (janitorRetentionMsec >= 0) {
+    std::cerr << "Completed task retention: " << janitorRetentionMsec
+              << " msec\n";
+  }
 
   auto distIt = kDists.find(reqDist);
   if (distIt == kDists.end()) {
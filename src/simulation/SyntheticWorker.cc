@@ -2,15 +2,24 @@
 // assigned tasks.
 
 #include <getopt.h>
+#include <algorithm>
 #include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "BenchmarkUtil.h"
+#include "HeartbeatAggregator.h"
 #include "MockHTTPWorker.h"
 #include "MockPollWorker.h"
+#include "TaskRegistry.h"
+#include "ThreadPlacement.h"
 #include "WorkerManager.h"
 #include "voltdb-client-cpp/include/Client.h"
 
@@ -20,6 +29,9 @@ static int numWorkers = 1;
 // Number of executors per worker
 static int numExecutors = 1;
 
+// Number of threads serving the port of a mock-http worker
+static int numServingThreads = 1;
+
 // Number of worker/task partitions, not VoltDB partitions.
 static int partitions = 8;
 
@@ -47,9 +59,85 @@ static const std::unordered_set<std::string> kWorkerTypes = {kMockPoll,
                                                              kMockHTTP};
 static std::string workerType = kMockPoll;
 
+// Queue between the dispatcher and executors of a mock-poll worker.
+static const std::string kMutexQueue = "mutex";
+static const std::string kLockFreeQueue = "lockfree";
+static const std::string kStealingQueue = "stealing";
+static const std::string kFiberQueue = "fibers";
+static const std::unordered_map<std::string, MockPollWorker::QueueType>
+    kQueueTypes = {{kMutexQueue, MockPollWorker::kMutexQueue},
+                   {kLockFreeQueue, MockPollWorker::kLockFreeQueue},
+                   {kStealingQueue, MockPollWorker::kWorkStealing},
+                   {kFiberQueue, MockPollWorker::kFibers}};
+static std::string queueType = kMutexQueue;
+
+// Cores to pin executors to, handed out in order across workers. Empty means
+// no pinning.
+static std::vector<int> executorCores;
+
+// Report completions in batches of up to this many tasks; 0 reports each
+// task with its own WorkerUpdateTask call (mock-poll), or flushes as soon as
+// possible off the event loop (mock-http).
+static int completionBatch = 0;
+
+// Flush a partial completion batch after this long.
+static int completionDelayUsec = 1000;
+
+// How a mock-poll worker talks to the DB: "split" fetches tasks with
+// WorkerSelectTask and reports completions separately, "exchange" reports
+// completions and fetches tasks with one WorkerExchange call.
+static const std::string kSplitMode = "split";
+static const std::string kExchangeMode = "exchange";
+static const std::unordered_set<std::string> kPollModes = {kSplitMode,
+                                                           kExchangeMode};
+static std::string pollMode = kSplitMode;
+
+// Adaptive polling of mock-poll workers; see MockPollWorker::PollOptions.
+static MockPollWorker::PollOptions pollOptions;
+
+// Heartbeat interval of mock-poll workers; 0 disables heartbeats. All
+// workers of the process share one HeartbeatAggregator.
+static int heartbeatIntervalMsec = 0;
+
+// Synthetic task workload run by the executors.
+static const std::string kNoneWorkload = "none";
+static const std::string kSpinWorkload = "spin";
+static const std::string kSleepWorkload = "sleep";
+static const std::string kMemoryWorkload = "memory";
+static const std::string kMixedWorkload = "mixed";
+static const std::unordered_map<std::string, WorkloadConfig::Type>
+    kWorkloadTypes = {{kNoneWorkload, WorkloadConfig::kNone},
+                      {kSpinWorkload, WorkloadConfig::kSpin},
+                      {kSleepWorkload, WorkloadConfig::kSleep},
+                      {kMemoryWorkload, WorkloadConfig::kMemory},
+                      {kMixedWorkload, WorkloadConfig::kMixed}};
+static std::string workloadType = kNoneWorkload;
+static WorkloadConfig workload;
+
+// Comma-separated task plugins; -T can then name one of their task functions.
+static std::string taskPlugins;
+
+// Bytes of payload handed to every task, 0 = none.
+static size_t payloadBytes = 0;
+
+// Power multiplier for the dispatch latency array.
+// We can record at most 2^24 = 16777216 latencies
+static const int kArrayExp = 24;
+static const size_t kMaxEntries = (1L << kArrayExp);
+
 // Record performance
 static std::vector<double> dispatchThroughput;
 static std::vector<double> finishThroughput;
+// Time each mock-poll worker took to drain, by worker id.
+static std::vector<double> drainUsec;
+
+// Placement of the benchmark threads on CPUs (--pin). Overrides -C.
+static ThreadPlacement placement;
+
+// Executor threads per worker; the fibers queue runs all tasks on one.
+static int executorThreads() {
+  return queueType == kFiberQueue ? 1 : numExecutors;
+}
 
 /*
  * Return a constructed worker instance based on type.
@@ -59,13 +147,32 @@ static WorkerManager* constructWorker(voltdb::Client* voltdbClient,
                                       const std::string& serverAddr,
                                       const std::string& type) {
   WorkerManager* worker = nullptr;
+  std::vector<int> cores;
+  if (placement.enabled()) {
+    // Executors take the slots after their worker's dispatcher.
+    for (int i = 0; i < executorThreads(); ++i) {
+      cores.push_back(placement.assign(
+          workerId * (executorThreads() + 1) + 1 + i, "executor"));
+    }
+  } else {
+    for (int i = 0; i < executorThreads() && !executorCores.empty(); ++i) {
+      cores.push_back(executorCores[(workerId * executorThreads() + i) %
+                                    executorCores.size()]);
+    }
+  }
   if (type == kMockPoll) {
     int pkey = workerId % partitions;
-    worker =
-        new MockPollWorker(workerId, pkey, serverAddr, numExecutors, topkTasks);
+    worker = new MockPollWorker(workerId, pkey, serverAddr, numExecutors,
+                                topkTasks, kQueueTypes.at(queueType),
+                                completionBatch, completionDelayUsec,
+                                pollMode == kExchangeMode, pollOptions,
+                                workload, cores);
   } else if (type == kMockHTTP) {
     int pkey = workerId % partitions;
-    worker = new MockHTTPWorker(voltdbClient, workerId, pkey, serverAddr);
+    worker = new MockHTTPWorker(voltdbClient, workerId, pkey, serverAddr,
+                                completionBatch, completionDelayUsec,
+                                workload, numExecutors, numServingThreads,
+                                cores);
   } else {
     std::cerr << "Unsupported worker type: " << type << "\n";
   }
@@ -77,6 +184,8 @@ static WorkerManager* constructWorker(voltdb::Client* voltdbClient,
  * Worker thread.
  */
 static void WorkerThread(const int workerId, const std::string& serverAddr) {
+  // The dispatcher and the other threads of the worker inherit this CPU.
+  placement.pin(workerId * (executorThreads() + 1), "dispatcher");
   // Create a local VoltDB client.
   voltdb::Client voltdbClient = WorkerManager::createVoltdbClient(serverAddr);
 
@@ -94,6 +203,8 @@ static void WorkerThread(const int workerId, const std::string& serverAddr) {
 
   // Clean up
   worker->endServing();
+  MockPollWorker* pollWorker = dynamic_cast<MockPollWorker*>(worker);
+  if (pollWorker != nullptr) { drainUsec[workerId] = pollWorker->drainUsec(); }
   delete worker;
   return;
 }
@@ -106,9 +217,23 @@ static bool runBenchmark(const std::string& serverAddr,
   mainFinished = false;
   WorkerManager::totalTasks_.store(0);
   WorkerManager::totalFinishedTasks_.store(0);
+  WorkerManager::dispatchLatencies_ = new double[kMaxEntries];
+  WorkerManager::maxDispatchLatencies_ = kMaxEntries;
+  WorkerManager::dispatchLatsIndex_.store(0);
+  WorkerManager::serviceTimes_ = new double[kMaxEntries];
+  WorkerManager::maxServiceTimes_ = kMaxEntries;
+  WorkerManager::serviceTimesIndex_.store(0);
   std::vector<std::thread*> workerThreads;  // Parallel workers.
 
+  HeartbeatAggregator* heartbeat = nullptr;
+  if (heartbeatIntervalMsec > 0) {
+    heartbeat = new HeartbeatAggregator(serverAddr, heartbeatIntervalMsec);
+    heartbeat->start();
+    pollOptions.heartbeat = heartbeat;
+  }
+
   // Start worker threads.
+  drainUsec.assign(numWorkers, 0);
   for (int i = 0; i < numWorkers; ++i) {
     workerThreads.push_back(new std::thread(&WorkerThread, i, serverAddr));
   }
@@ -138,13 +263,29 @@ static bool runBenchmark(const std::string& serverAddr,
     lastFinished = currFinished;
   } while (currTime < endTime);
 
-  // Notifying workers to stop.
-  mainFinished = true;
+  // Notifying workers to stop; each drains its tasks and completions.
+  uint64_t drainStart = BenchmarkUtil::getCurrTimeUsec();
+  {
+    // Under the lock, so a worker cannot miss the notification.
+    std::lock_guard<std::mutex> lock(mainLock);
+    mainFinished = true;
+  }
   mainCv.notify_all();
   for (int i = 0; i < numWorkers; ++i) {
     workerThreads[i]->join();
     delete workerThreads[i];
   }
+  std::cerr << "Workers drained in "
+            << (BenchmarkUtil::getCurrTimeUsec() - drainStart) / 1000.0
+            << " msec\n";
+  if (heartbeat != nullptr) {
+    delete heartbeat;
+    pollOptions.heartbeat = nullptr;
+  }
+
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // TODO: Processing the results.
   std::cerr << "Dispatch-Throughput,Finished-Throughput\n";
@@ -153,7 +294,56 @@ static bool runBenchmark(const std::string& serverAddr,
               << std::endl;
   }
 
+  // Time from the dispatcher queuing a task until an executor starts it.
+  size_t count = std::min(WorkerManager::dispatchLatsIndex_.load(),
+                          (uint64_t)kMaxEntries);
+  if (count > 0) {
+    BenchmarkUtil::Statistics stats = BenchmarkUtil::computeStats(
+        WorkerManager::dispatchLatencies_, count);
+    double throughput = count * 1.0 / (totalExecTimeMsec / 1000.0);
+    BenchmarkUtil::printStats(
+        stats, "Dispatch-to-start latency (" + queueType + " queue)",
+        throughput);
+  }
+
+  // Time executors spent in the tasks, to compare with the overheads above.
+  count = std::min(WorkerManager::serviceTimesIndex_.load(),
+                   (uint64_t)kMaxEntries);
+  if (count > 0) {
+    BenchmarkUtil::Statistics stats =
+        BenchmarkUtil::computeStats(WorkerManager::serviceTimes_, count);
+    double throughput = count * 1.0 / (totalExecTimeMsec / 1000.0);
+    BenchmarkUtil::printStats(
+        stats, "Service time (" + workloadType + " workload)", throughput);
+  }
+
+  // Time the mock-poll workers took to stop fetching, finish their tasks and
+  // store the last completions.
+  if (workerType == kMockPoll && numWorkers > 0) {
+    std::ofstream drainFile(outputFile + ".drain.csv");
+    if (drainFile.is_open()) {
+      drainFile << "WorkerID,Drain-Usec\n";
+      for (int i = 0; i < numWorkers; ++i) {
+        drainFile << i << "," << (uint64_t)drainUsec[i] << "\n";
+      }
+      std::cerr << "Stored drain times to: " << outputFile << ".drain.csv\n";
+    } else {
+      std::cerr << "[Warning]: failed to write drain times to " << outputFile
+                << ".drain.csv\n";
+    }
+    // Sorts drainUsec.
+    BenchmarkUtil::Statistics stats =
+        BenchmarkUtil::computeStats(drainUsec.data(), drainUsec.size());
+    BenchmarkUtil::printStats(stats, "Drain time (per worker)", 0);
+  }
+
   // Clean up.
+  delete[] WorkerManager::serviceTimes_;
+  WorkerManager::serviceTimes_ = nullptr;
+  WorkerManager::maxServiceTimes_ = 0;
+  delete[] WorkerManager::dispatchLatencies_;
+  WorkerManager::dispatchLatencies_ = nullptr;
+  WorkerManager::maxDispatchLatencies_ = 0;
   return true;
 }
 
@@ -170,10 +360,57 @@ static void Usage(char** argv, const std::string& msg = "") {
             << " msec\n";
   std::cerr << "\t-W <number of workers (#rows in table)>: default "
             << numWorkers << "\n";
-  std::cerr << "\t-E <number of executors per worker>: default " << numExecutors
-            << "\n";
+  std::cerr << "\t-E <number of executors (fibers queue: tasks in flight) "
+            << "per worker>: default " << numExecutors << "\n";
+  std::cerr << "\t-N <mock-http serving threads per worker>: default "
+            << numServingThreads << "\n";
   std::cerr << "\t-K <select top-K tasks in a batch>: default " << topkTasks
             << "\n";
+  std::cerr << "\t-Q <mock-poll executor queue (options: ";
+  for (auto&& it : kQueueTypes) { std::cerr << it.first << " "; }
+  std::cerr << ")> default " << queueType << "\n";
+  std::cerr << "\t-C <comma-separated cores to pin executors to>: default "
+            << "none\n";
+  std::cerr << "\t-B <completion batch size, 0 = per task/as they come>: "
+            << "default "
+            << completionBatch << "\n";
+  std::cerr << "\t-L <completion flush delay>: default " << completionDelayUsec
+            << " usec\n";
+  std::cerr << "\t-M <mock-poll DB round trips (options: ";
+  for (auto&& it : kPollModes) { std::cerr << it << " "; }
+  std::cerr << ")> default " << pollMode << "\n";
+  std::cerr << "\t-b <first backoff after an empty poll>: default "
+            << pollOptions.minBackoffUsec << " usec\n";
+  std::cerr << "\t-X <max backoff after empty polls, 0 = busy polling>: "
+            << "default " << pollOptions.maxBackoffUsec << " usec\n";
+  std::cerr << "\t-k <max adaptive top-K, 0 = fixed>: default "
+            << pollOptions.maxTopk << "\n";
+  std::cerr << "\t-U <wakeup push base port (+worker id), 0 = no push>: "
+            << "default " << pollOptions.wakeupPort << "\n";
+  std::cerr << "\t-H <mock-poll heartbeat interval, 0 = none>: default "
+            << heartbeatIntervalMsec << " msec\n";
+  std::cerr << "\t-V <mock-poll task lease, 0 = none>: default "
+            << pollOptions.leaseMsec << " msec\n";
+  std::cerr << "\t-F <mock-poll prefetch horizon, 0 = fetch back to back>: "
+            << "default " << pollOptions.prefetchUsec << " usec\n";
+  std::cerr << "\t-a: measure mock-poll task usage (queueing, wall and CPU "
+            << "time, context switches)\n";
+  std::cerr << "\t-u <tasks per TaskUsage batch written to the DB, 0 = none; "
+            << "implies -a>: default " << pollOptions.usageBatch << "\n";
+
+  std::cerr << "\t-T <task workload (options: ";
+  for (auto&& it : kWorkloadTypes) { std::cerr << it.first << " "; }
+  std::cerr << "or a task of a plugin)> default " << workloadType << "\n";
+  std::cerr << "\t-g <comma-separated task plugins (.so)>: default none\n";
+  std::cerr << "\t-Y <task payload size>: default " << payloadBytes
+            << " bytes\n";
+  std::cerr << "\t-D <task execution time (mean for mixed)>: default "
+            << workload.execTimeUsec << " usec\n";
+  std::cerr << "\t-R <mixed workload weights spin:sleep:memory>: default "
+            << workload.spinWeight << ":" << workload.sleepWeight << ":"
+            << workload.memoryWeight << "\n";
+  std::cerr << "\t-Z <memory workload buffer per executor>: default "
+            << (workload.memoryBytes >> 20) << " MB\n";
 
   std::cerr << "\t-P <partitions>: default " << partitions << "\n";
   // Print all options here.
@@ -181,17 +418,23 @@ static void Usage(char** argv, const std::string& msg = "") {
   for (auto&& it : kWorkerTypes) { std::cerr << it << " "; }
   std::cerr << ")> default " << workerType << "\n";
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("localhost");
   std::string outputFile("synthetic_worker_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "ho:s:i:t:W:P:A:E:K:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hao:s:i:t:W:P:A:E:N:K:Q:B:L:M:b:X:k:U:H:V:F:u:T:g:Y:D:R:Z:C:",
+                            kLongOptions, nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -217,9 +460,86 @@ int main(int argc, char** argv) {
       case 'E':
         numExecutors = atoi(optarg);
         break;
+      case 'N':
+        numServingThreads = atoi(optarg);
+        break;
       case 'K':
         topkTasks = atoi(optarg);
         break;
+      case 'Q':
+        queueType = optarg;
+        break;
+      case 'B':
+        completionBatch = atoi(optarg);
+        break;
+      case 'L':
+        completionDelayUsec = atoi(optarg);
+        break;
+      case 'M':
+        pollMode = optarg;
+        break;
+      case 'b':
+        pollOptions.minBackoffUsec = atoi(optarg);
+        break;
+      case 'X':
+        pollOptions.maxBackoffUsec = atoi(optarg);
+        break;
+      case 'k':
+        pollOptions.maxTopk = atoi(optarg);
+        break;
+      case 'U':
+        pollOptions.wakeupPort = atoi(optarg);
+        break;
+      case 'H':
+        heartbeatIntervalMsec = atoi(optarg);
+        break;
+      case 'V':
+        pollOptions.leaseMsec = atoi(optarg);
+        break;
+      case 'F':
+        pollOptions.prefetchUsec = atoi(optarg);
+        break;
+      case 'a':
+        pollOptions.accountTasks = true;
+        break;
+      case 'u':
+        pollOptions.usageBatch = atoi(optarg);
+        pollOptions.accountTasks = true;
+        break;
+      case 'T':
+        workloadType = optarg;
+        break;
+      case 'g':
+        taskPlugins = optarg;
+        break;
+      case 'Y':
+        payloadBytes = (size_t)atol(optarg);
+        break;
+      case 'D':
+        workload.execTimeUsec = atoi(optarg);
+        break;
+      case 'R':
+        if (sscanf(optarg, "%lf:%lf:%lf", &workload.spinWeight,
+                   &workload.sleepWeight, &workload.memoryWeight) != 3) {
+          Usage(argv, "invalid mixed workload weights");
+        }
+        break;
+      case 'C': {
+        std::istringstream coreStream(optarg);
+        std::string core;
+        while (std::getline(coreStream, core, ',')) {
+          executorCores.push_back(atoi(core.c_str()));
+        }
+        break;
+      }
+      case 'Z':
+        workload.memoryBytes = (size_t)atoi(optarg) << 20;
+        break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -233,12 +553,94 @@ int main(int argc, char** argv) {
     std::cerr << "Unsupported worker type: " << workerType << std::endl;
     Usage(argv);
   }
+  if (kQueueTypes.find(queueType) == kQueueTypes.end()) {
+    std::cerr << "Unsupported queue type: " << queueType << std::endl;
+    Usage(argv);
+  }
+  if (kPollModes.find(pollMode) == kPollModes.end()) {
+    std::cerr << "Unsupported poll mode: " << pollMode << std::endl;
+    Usage(argv);
+  }
+  std::shared_ptr<TaskRegistry> registry = std::make_shared<TaskRegistry>();
+  if (!registry->loadAll(taskPlugins)) { Usage(argv, "Invalid task plugin"); }
+  auto workloadIt = kWorkloadTypes.find(workloadType);
+  if (workloadIt != kWorkloadTypes.end()) {
+    workload.type = workloadIt->second;
+  } else if (registry->type(workloadType) > 0) {
+    workload.type = WorkloadConfig::kPlugin;
+    workload.taskType = registry->type(workloadType);
+  } else {
+    std::cerr << "Unsupported workload: " << workloadType << std::endl;
+    Usage(argv);
+  }
+  workload.registry = registry;
+  if (payloadBytes > 0) {
+    // Random bytes, so plugins that sort or compress do real work.
+    std::string payload(payloadBytes, 0);
+    for (char& c : payload) { c = (char)rand(); }
+    workload.payload = std::make_shared<const std::string>(std::move(payload));
+  }
   std::cerr << "Worker type: " << workerType << std::endl;
+  std::cerr << "Executor queue: " << queueType << std::endl;
+  if (!executorCores.empty()) {
+    std::cerr << "Executor cores:";
+    for (int core : executorCores) { std::cerr << " " << core; }
+    std::cerr << std::endl;
+  }
+  if (workerType == kMockPoll) {
+    std::cerr << "Poll mode: " << pollMode << std::endl;
+    if (pollOptions.maxBackoffUsec > 0) {
+      std::cerr << "Poll backoff: " << pollOptions.minBackoffUsec << " to "
+                << pollOptions.maxBackoffUsec << " usec" << std::endl;
+    }
+    if (pollOptions.maxTopk > topkTasks) {
+      std::cerr << "Adaptive top-k up to " << pollOptions.maxTopk << std::endl;
+    }
+    if (pollOptions.wakeupPort > 0) {
+      std::cerr << "Wakeup push from port " << pollOptions.wakeupPort
+                << std::endl;
+    }
+    if (heartbeatIntervalMsec > 0) {
+      std::cerr << "Heartbeat interval: " << heartbeatIntervalMsec << " msec"
+                << std::endl;
+    }
+    if (pollOptions.leaseMsec > 0) {
+      std::cerr << "Task lease: " << pollOptions.leaseMsec << " msec"
+                << std::endl;
+    }
+    if (pollOptions.prefetchUsec > 0) {
+      std::cerr << "Prefetch horizon: " << pollOptions.prefetchUsec << " usec"
+                << std::endl;
+    }
+    if (pollOptions.accountTasks) {
+      std::cerr << "Task usage accounting"
+                << (pollOptions.usageBatch > 0
+                        ? ", stored in batches of " +
+                              std::to_string(pollOptions.usageBatch)
+                        : std::string())
+                << std::endl;
+    }
+  }
+  if (completionBatch > 0 && pollMode != kExchangeMode) {
+    std::cerr << "Completion batch: " << completionBatch << " tasks or "
+              << completionDelayUsec << " usec" << std::endl;
+  }
+  std::cerr << "Task workload: " << workloadType << ", "
+            << workload.execTimeUsec << " usec" << std::endl;
+  if (registry->size() > 0) {
+    std::cerr << "Plugin tasks: ";
+    registry->printTasks(std::cerr);
+    std::cerr << std::endl;
+  }
+  if (payloadBytes > 0) {
+    std::cerr << "Task payload: " << payloadBytes << " bytes" << std::endl;
+  }
   std::cerr << "Parallel workers: " << numWorkers << std::endl;
   std::cerr << "Executors per worker: " << numExecutors << std::endl;
   std::cerr << "Task top-k (batch) size: " << topkTasks << std::endl;
   std::cerr << "Partitions: " << partitions << std::endl;
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "VoltDB server address: " << serverAddr << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
   std::cerr << "Total execution time: " << totalExecTimeMsec << " msec\n";
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "BenchmarkUtil.h"
+#include "ThreadPlacement.h"
 
 // Number of senders.
 static int numSenders = 1;
@@ -111,8 +112,12 @@ int setup_connections(std::vector<int>& socks, const int serverPort,
   return epoll_fd;
 }
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 static void BroadcasterThread(const int serverPort,
                               const std::string& serverAddr) {
+  placement.pin(serverPort - basePort, "sender");
   std::vector<int> socks;
   struct epoll_event event, events[numReceivers];
 
@@ -174,6 +179,7 @@ static void BroadcasterThread(const int serverPort,
  * Sender thread.
  */
 static void SenderThread(const int serverPort, const std::string& serverAddr) {
+  placement.pin(serverPort - basePort, "sender");
   int ret, sock = 0;
   struct sockaddr_in serv_addr;
   char buffer[msg_size] = {0};
@@ -302,6 +308,9 @@ static bool runBenchmark(const std::string& serverAddr,
   if (!res) {
     std::cerr << "[Warning]: failed to write results to " << outputFile << "\n";
   }
+  if (placement.enabled()) {
+    placement.writeResults(outputFile + ".placement.csv");
+  }
 
   // Clean up.
   delete[] msgLatencies;
@@ -333,17 +342,23 @@ static void Usage(char** argv, const std::string& msg = "") {
       << numReceivers << "\n";
   // Print all options here.
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   std::string serverAddr("127.0.0.1");
   std::string outputFile("message_results.csv");
 
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hbo:s:p:i:t:N:M:m:R:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hbo:s:p:i:t:N:M:m:R:", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 'o':
         outputFile = optarg;
@@ -375,6 +390,11 @@ int main(int argc, char** argv) {
       case 'R':
         numReceivers = atoi(optarg);
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -386,6 +406,7 @@ int main(int argc, char** argv) {
   std::cerr << "Parallel outstanding messages: " << numMessages << std::endl;
   std::cerr << "Message size: " << msg_size << " bytes" << std::endl;
   std::cerr << "Output log file: " << outputFile << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
   std::cerr << "Server address: " << serverAddr << std::endl;
   std::cerr << "Base port: " << basePort << std::endl;
   std::cerr << "Measurement interval: " << measureIntervalMsec << " msec\n";
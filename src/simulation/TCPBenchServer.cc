@@ -14,6 +14,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "ThreadPlacement.h"
+
 // Number of receivers.
 static int numReceivers = 1;
 
@@ -29,10 +31,14 @@ static int msg_size = 2048;
 // Barrier used for thread synchronization.
 pthread_barrier_t barrier;
 
+// Placement of the benchmark threads on CPUs (--pin).
+static ThreadPlacement placement;
+
 /*
  * Receiver thread.
  */
 static void ReceiverThread(const int serverPort) {
+  placement.pin(serverPort - basePort, "receiver");
   int ret, server_fd = 0;
   int opt = 1;
   struct sockaddr_in addr;
@@ -121,14 +127,20 @@ static void Usage(char** argv, const std::string& msg = "") {
             << "\n";
   // Print all options here.
 
+  ThreadPlacement::printUsage(std::cerr);
   std::cerr << std::endl;
   exit(1);
 }
 
+static const struct option kLongOptions[] = {
+    {"pin", required_argument, nullptr, ThreadPlacement::kPinOption},
+    {nullptr, 0, nullptr, 0}};
+
 int main(int argc, char** argv) {
   // Parse input arguments and prepare for the experiment.
   int opt;
-  while ((opt = getopt(argc, argv, "hm:p:N:M:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "hm:p:N:M:", kLongOptions,
+                            nullptr)) != -1) {
     switch (opt) {
       case 'm':
         msg_size = atoi(optarg);
@@ -142,6 +154,11 @@ int main(int argc, char** argv) {
       case 'M':
         numMessages = atoi(optarg);
         break;
+      case ThreadPlacement::kPinOption:
+        if (!placement.parse(optarg)) {
+          Usage(argv, "Invalid --pin policy");
+        }
+        break;
       case 'h':
       default:
         Usage(argv);
@@ -153,6 +170,7 @@ int main(int argc, char** argv) {
   std::cerr << "Parallel outstanding messages: " << numMessages << std::endl;
   std::cerr << "Message size: " << msg_size << " bytes" << std::endl;
   std::cerr << "Base port: " << basePort << std::endl;
+  std::cerr << "Thread placement: " << placement.spec() << std::endl;
 
   std::vector<std::thread*> receiverThreads;  // Parallel receivers.
 
@@ -0,0 +1,138 @@
+// Test functionality of BatchFlusher.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BatchFlusher.h"
+
+// Records the batches it is handed, and fails the first <failures> flushes.
+class RecordingFlusher : public BatchFlusher<int> {
+public:
+  RecordingFlusher(size_t maxBatch, uint64_t maxDelayUsec, int failures)
+      : BatchFlusher<int>(maxBatch, maxDelayUsec, false),
+        failures_(failures),
+        setups_(0),
+        calls_(0) {}
+
+  ~RecordingFlusher() { stop(); }
+
+  // Flushed items, in flush order.
+  std::vector<int> flushed() {
+    std::lock_guard<std::mutex> lk(lock_);
+    return flushed_;
+  }
+
+  // Largest batch handed to flush().
+  size_t maxBatchSize() {
+    std::lock_guard<std::mutex> lk(lock_);
+    return maxBatchSize_;
+  }
+
+  int setups() const { return setups_.load(); }
+  int calls() const { return calls_.load(); }
+
+  static const int kMaxRetries = BatchFlusher<int>::kMaxRetries;
+
+protected:
+  void setup() override { setups_++; }
+
+  bool flush(const std::vector<int>& batch) override {
+    calls_++;
+    if (failures_ > 0) {
+      failures_--;
+      return false;
+    }
+    std::lock_guard<std::mutex> lk(lock_);
+    flushed_.insert(flushed_.end(), batch.begin(), batch.end());
+    maxBatchSize_ = std::max(maxBatchSize_, batch.size());
+    return true;
+  }
+
+private:
+  int failures_;  // only touched by the flusher thread
+  std::atomic<int> setups_;
+  std::atomic<int> calls_;
+  std::mutex lock_;
+  std::vector<int> flushed_;
+  size_t maxBatchSize_ = 0;
+};
+
+// Items from several threads are all flushed once, in batches of at most
+// maxBatch, and stop() flushes the rest.
+static void testBatches() {
+  const int kThreads = 4;
+  const int kItemsPerThread = 10000;
+  const size_t kMaxBatch = 64;
+  RecordingFlusher flusher(kMaxBatch, 1000000, 0);
+  flusher.start();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&flusher, t] {
+      for (int i = 0; i < kItemsPerThread; ++i) {
+        flusher.add(t * kItemsPerThread + i);
+      }
+    });
+  }
+  for (std::thread& t : threads) { t.join(); }
+  flusher.stop();
+
+  std::vector<int> flushed = flusher.flushed();
+  assert(flushed.size() == (size_t)(kThreads * kItemsPerThread));
+  std::vector<int> seen(flushed.size(), 0);
+  for (int item : flushed) { seen[item]++; }
+  for (int count : seen) { assert(count == 1); }
+  assert(flusher.setups() == 1);
+  std::cout << "Batches: " << flushed.size() << " items in "
+            << flusher.calls() << " flushes, largest "
+            << flusher.maxBatchSize() << std::endl;
+}
+
+// A partial batch is flushed once its oldest item waited maxDelayUsec.
+static void testDelay() {
+  RecordingFlusher flusher(1000, 5000, 0);
+  flusher.start();
+  flusher.add(1);
+  flusher.add(2);
+  for (int i = 0; i < 1000 && flusher.flushed().size() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  assert(flusher.flushed().size() == 2);
+  flusher.stop();
+  std::cout << "Delay: ok" << std::endl;
+}
+
+// A failed batch is retried together with the items added meanwhile, in
+// order, and is dropped after kMaxRetries failures in a row.
+static void testRetries() {
+  RecordingFlusher retried(1000, 1000, 2);
+  retried.start();
+  retried.add(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  retried.add(2);
+  retried.stop();
+  std::vector<int> flushed = retried.flushed();
+  assert(flushed.size() == 2);
+  assert(flushed[0] == 1 && flushed[1] == 2);
+  assert(retried.calls() >= 3);
+
+  RecordingFlusher dropped(1000, 1000, RecordingFlusher::kMaxRetries + 1);
+  dropped.start();
+  dropped.add(1);
+  dropped.stop();
+  assert(dropped.flushed().empty());
+  assert(dropped.calls() == RecordingFlusher::kMaxRetries + 1);
+  std::cout << "Retries: ok" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  testBatches();
+  testDelay();
+  testRetries();
+  return 0;
+}
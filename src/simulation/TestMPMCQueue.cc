@@ -0,0 +1,96 @@
+// Test functionality of MPMCQueue.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "MPMCQueue.h"
+
+static const int kProducers = 4;
+static const int kConsumers = 4;
+static const uint64_t kItemsPerProducer = 100000;
+
+// Fill the queue, check it rejects more, and drain it in FIFO order.
+static void testSingleThread() {
+  MPMCQueue<uint64_t> queue(5);  // rounded up to 8
+  uint64_t pushed = 0;
+  while (queue.tryPush(pushed)) { pushed++; }
+  assert(pushed == 8);
+  assert(queue.size() == 8);
+
+  uint64_t out[3];
+  size_t n = queue.tryPopBatch(out, 3);
+  assert(n == 3);
+  for (size_t i = 0; i < n; ++i) { assert(out[i] == i); }
+  uint64_t value;
+  for (uint64_t expected = 3; expected < pushed; ++expected) {
+    bool ok = queue.tryPop(value);
+    assert(ok);
+    assert(value == expected);
+  }
+  assert(queue.empty());
+  assert(!queue.tryPop(value));
+  std::cout << "Single thread: ok" << std::endl;
+}
+
+// Producers push disjoint ranges while consumers pop in batches and block;
+// every value must come out exactly once.
+static void testConcurrent() {
+  MPMCQueue<uint64_t> queue(1024);
+  const uint64_t total = kProducers * kItemsPerProducer;
+  std::vector<std::atomic<int>> seen(total);
+  for (uint64_t i = 0; i < total; ++i) { seen[i].store(0); }
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kConsumers; ++c) {
+    consumers.emplace_back([&queue, &seen] {
+      uint64_t batch[16];
+      size_t n;
+      while ((n = queue.popBatch(batch, 16)) > 0) {
+        for (size_t i = 0; i < n; ++i) { seen[batch[i]].fetch_add(1); }
+      }
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queue, p] {
+      for (uint64_t i = 0; i < kItemsPerProducer; ++i) {
+        queue.push(p * kItemsPerProducer + i);
+      }
+    });
+  }
+  for (std::thread& t : producers) { t.join(); }
+  // Consumers drain what is left, then return.
+  queue.close();
+  for (std::thread& t : consumers) { t.join(); }
+
+  for (uint64_t i = 0; i < total; ++i) { assert(seen[i].load() == 1); }
+  assert(queue.empty());
+  std::cout << "Concurrent: " << total << " values popped once" << std::endl;
+}
+
+// A consumer parked on an empty queue wakes up on close.
+static void testCloseWakesConsumer() {
+  MPMCQueue<uint64_t> queue(8);
+  size_t popped = 1;
+  std::thread consumer([&queue, &popped] {
+    uint64_t value;
+    popped = queue.popBatch(&value, 1);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  queue.close();
+  consumer.join();
+  assert(popped == 0);
+  std::cout << "Close: ok" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  testSingleThread();
+  testConcurrent();
+  testCloseWakesConsumer();
+  return 0;
+}
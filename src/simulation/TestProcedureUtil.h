@@ -0,0 +1,25 @@
+// This file contains helpers shared by the tests that call VoltDB procedures.
+#ifndef DBOS_TEST_PROCEDURE_UTIL_H
+#define DBOS_TEST_PROCEDURE_UTIL_H
+
+#include <cstdlib>
+#include <iostream>
+
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/InvocationResponse.hpp"
+#include "voltdb-client-cpp/include/Procedure.hpp"
+
+// Invoke a procedure and return its response; print the failure and exit if
+// it failed, so a test stops at the first broken call.
+inline voltdb::InvocationResponse invoke(voltdb::Client* client,
+                                         voltdb::Procedure& procedure) {
+  voltdb::InvocationResponse r = client->invoke(procedure);
+  if (r.failure()) {
+    std::cout << procedure.getName() << " procedure failed. " << r.toString()
+              << std::endl;
+    exit(1);
+  }
+  return r;
+}
+
+#endif  // #ifndef DBOS_TEST_PROCEDURE_UTIL_H
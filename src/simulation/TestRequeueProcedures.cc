@@ -0,0 +1,188 @@
+// Test the procedures that requeue tasks: ReapDeadWorkers and
+// ExpireTaskLeases. Needs a VoltDB server on localhost with the procedures
+// loaded; truncates the task and worker tables.
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DbosDefs.h"
+#include "TestProcedureUtil.h"
+#include "VoltdbResultDecoder.h"
+#include "VoltdbSchedulerUtil.h"
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+static const int kPKey = 0;
+static const int kOldWorker = 1;  // most capacity, gets all tasks
+static const int kNewWorker = 2;
+
+static void truncateTables(voltdb::Client* client) {
+  std::vector<voltdb::Parameter> parameterTypes;
+  voltdb::Procedure truncateTasks("TruncateTaskTable", parameterTypes);
+  invoke(client, truncateTasks);
+  voltdb::Procedure truncateWorkers("TruncateWorkerTable", parameterTypes);
+  invoke(client, truncateWorkers);
+}
+
+static void insertWorker(voltdb::Client* client, int workerId, int capacity) {
+  std::vector<voltdb::Parameter> parameterTypes(4);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
+  voltdb::Procedure procedure("InsertWorker", parameterTypes);
+  procedure.params()
+      ->addInt32(workerId)
+      .addInt32(capacity)
+      .addInt32(kPKey)
+      .addString("");
+  invoke(client, procedure);
+}
+
+static void heartbeat(voltdb::Client* client, std::vector<int32_t> workerIds) {
+  std::vector<voltdb::Parameter> parameterTypes(2);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  voltdb::Procedure procedure("WorkerHeartbeat", parameterTypes);
+  procedure.params()->addInt32(kPKey).addInt32(workerIds);
+  invoke(client, procedure);
+}
+
+// Queue a task for the worker with the most capacity; return its id.
+static DbosId enqueueTask(voltdb::Client* client, DbosId taskId) {
+  std::vector<voltdb::Parameter> parameterTypes(3);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
+  voltdb::Procedure procedure("SelectOrderedWorker", parameterTypes);
+  procedure.params()->addInt32(kPKey).addInt32(taskId).addInt8(0);
+  return VoltdbResultDecoder::getScalarInt64(invoke(client, procedure));
+}
+
+// Dequeue up to topk tasks of a worker, leased for leaseMsec if > 0.
+static std::vector<DbosId> selectTasks(voltdb::Client* client, int workerId,
+                                       int topk, int64_t leaseMsec) {
+  std::vector<voltdb::Parameter> parameterTypes(5);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
+  parameterTypes[4] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  voltdb::Procedure procedure("WorkerSelectTask", parameterTypes);
+  procedure.params()
+      ->addInt32(kPKey)
+      .addInt32(workerId)
+      .addInt32(topk)
+      .addString("")
+      .addInt64(leaseMsec);
+  VoltdbResultDecoder decoder;
+  decoder.decode(invoke(client, procedure));
+  std::vector<DbosId> taskIds;
+  for (int32_t i = 0; i < decoder.rowCount(); ++i) {
+    taskIds.push_back(decoder.getInt64(i, 0));
+  }
+  return taskIds;
+}
+
+// Complete tasks of a worker; return how many were still running for it.
+static int64_t completeTasks(voltdb::Client* client, int workerId,
+                             std::vector<int32_t> taskIds) {
+  std::vector<voltdb::Parameter> parameterTypes(4);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER, true);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_VARBINARY, true);
+  voltdb::Procedure procedure("WorkerCompleteTasks", parameterTypes);
+  procedure.params()
+      ->addInt32(kPKey)
+      .addInt32(workerId)
+      .addInt32(taskIds)
+      .addBytes(std::vector<voltdb::buffer_t>());
+  return VoltdbResultDecoder::getScalarInt64(invoke(client, procedure));
+}
+
+// A dead worker's running and queued tasks move to the live worker, running
+// ones first.
+static void testReapDeadWorkers(voltdb::Client* client) {
+  truncateTables(client);
+  insertWorker(client, kOldWorker, 10);
+  insertWorker(client, kNewWorker, 5);
+  for (DbosId taskId = 1; taskId <= 4; ++taskId) {
+    DbosId workerId = enqueueTask(client, taskId);
+    assert(workerId == kOldWorker);
+  }
+  std::vector<DbosId> running = selectTasks(client, kOldWorker, 2, 0);
+  assert(running.size() == 2);
+
+  // Only the new worker keeps beating.
+  heartbeat(client, {kOldWorker, kNewWorker});
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  heartbeat(client, {kNewWorker});
+
+  std::vector<voltdb::Parameter> parameterTypes(3);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_BIGINT);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  voltdb::Procedure procedure("ReapDeadWorkers", parameterTypes);
+  procedure.params()->addInt32(kPKey).addInt64(100).addInt32(10);
+  VoltdbResultDecoder decoder;
+  decoder.decode(invoke(client, procedure));
+  assert(decoder.rowCount() == 1);
+  assert(decoder.getInt64(0, 0) == kOldWorker);
+  assert(decoder.getInt64(0, 1) == 4);
+
+  std::vector<DbosId> moved = selectTasks(client, kNewWorker, 10, 0);
+  assert(moved.size() == 4);
+  // The tasks that were running are at the head of the queue.
+  assert((moved[0] == running[0] && moved[1] == running[1]) ||
+         (moved[0] == running[1] && moved[1] == running[0]));
+  std::cout << "ReapDeadWorkers: ok" << std::endl;
+}
+
+// Tasks whose lease expired move to another worker, and a late completion
+// from the old worker no longer matches them.
+static void testExpireTaskLeases(voltdb::Client* client) {
+  truncateTables(client);
+  insertWorker(client, kOldWorker, 10);
+  insertWorker(client, kNewWorker, 5);
+  for (DbosId taskId = 11; taskId <= 12; ++taskId) {
+    DbosId workerId = enqueueTask(client, taskId);
+    assert(workerId == kOldWorker);
+  }
+  std::vector<DbosId> leased = selectTasks(client, kOldWorker, 2, 50);
+  assert(leased.size() == 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::vector<voltdb::Parameter> parameterTypes(2);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  voltdb::Procedure procedure("ExpireTaskLeases", parameterTypes);
+  procedure.params()->addInt32(kPKey).addInt32(100);
+  int64_t expired = VoltdbResultDecoder::getScalarInt64(
+      invoke(client, procedure));
+  assert(expired == 2);
+
+  std::vector<DbosId> moved = selectTasks(client, kNewWorker, 10, 0);
+  assert(moved.size() == 2);
+  int64_t late = completeTasks(client, kOldWorker, {11, 12});
+  assert(late == 0);
+  int64_t completed = completeTasks(client, kNewWorker, {11, 12});
+  assert(completed == 2);
+  std::cout << "ExpireTaskLeases: ok" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  voltdb::Client voltdbClient =
+      VoltdbSchedulerUtil::createVoltdbClient("testuser", "testpwd");
+  VoltdbSchedulerUtil::connectVoltdbClient(&voltdbClient, "localhost");
+  testReapDeadWorkers(&voltdbClient);
+  testExpireTaskLeases(&voltdbClient);
+  truncateTables(&voltdbClient);
+  return 0;
+}
@@ -9,8 +9,9 @@
 int main(int argc, char** argv) {
   voltdb::Client voltdbClient =
       SparkScheduler::createVoltdbClient("testuser", "testpwd");
-  // Client - Host - Partitions - Capacity - numWorkers
-  SparkScheduler scheduler(&voltdbClient, "localhost", 1, 1, 2);
+  // Client - Host - User - Password - Partitions - Capacity - numWorkers
+  SparkScheduler scheduler(&voltdbClient, "localhost", "testuser", "testpwd",
+                           1, 1, 2);
 
   // Insert then Select a worker.
   DbosStatus ret = scheduler.setup();
@@ -0,0 +1,72 @@
+// Test functionality of TimerWheel.
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TimerWheel.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint64_t kTickUsec = 1000;
+static const size_t kSlots = 64;  // one rotation is 64 msec
+
+struct Fired {
+  int id;
+  Clock::time_point time;
+};
+
+int main(int argc, char** argv) {
+  std::mutex lock;
+  std::vector<Fired> fired;
+  TimerWheel<int> wheel(kTickUsec, kSlots, [&](const int& id) {
+    std::lock_guard<std::mutex> lk(lock);
+    fired.push_back(Fired{id, Clock::now()});
+  });
+  wheel.start();
+
+  // Delays in msec, out of order, one more than a rotation away. Timer i is
+  // due after delays[i]. They are a few ticks apart, so their order is fixed.
+  std::vector<uint64_t> delays = {30, 8, 2, 90, 18, 12};
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < delays.size(); ++i) {
+    wheel.schedule(i, delays[i] * 1000);
+  }
+  assert(wheel.size() == delays.size());
+
+  // Wait for all of them, with a generous bound.
+  for (int i = 0; i < 1000 && wheel.size() > 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  wheel.stop();
+
+  std::lock_guard<std::mutex> lk(lock);
+  assert(fired.size() == delays.size());
+  uint64_t lastDelay = 0;
+  for (const Fired& f : fired) {
+    uint64_t delay = delays[f.id];
+    uint64_t elapsedUsec = std::chrono::duration_cast<std::chrono::microseconds>(
+                               f.time - start)
+                               .count();
+    std::cout << "Timer " << f.id << " due after " << delay * 1000
+              << " usec fired after " << elapsedUsec << " usec" << std::endl;
+    // Never early, and in deadline order.
+    assert(elapsedUsec >= delay * 1000);
+    assert(delay >= lastDelay);
+    lastDelay = delay;
+  }
+
+  // Timers still pending on stop() are dropped.
+  TimerWheel<int> dropped(kTickUsec, kSlots, [](const int& /*id*/) {
+    assert(false);
+  });
+  dropped.start();
+  dropped.schedule(0, 1000000);
+  dropped.stop();
+  std::cout << "TimerWheel: ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Test a mock-poll worker whose executors steal tasks from each other. Needs
+// a VoltDB server on localhost with the procedures loaded; truncates the task
+// and worker tables.
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MockPollWorker.h"
+#include "TestProcedureUtil.h"
+#include "VoltdbResultDecoder.h"
+#include "WorkerManager.h"
+#include "voltdb-client-cpp/include/Client.h"
+#include "voltdb-client-cpp/include/Parameter.hpp"
+#include "voltdb-client-cpp/include/ParameterSet.hpp"
+#include "voltdb-client-cpp/include/WireType.h"
+
+static const std::string kDbAddr = "localhost";
+static const int kPKey = 0;
+static const int kWorkerId = 1;
+static const int kExecutors = 4;
+static const int kTopk = 512;
+static const int kTasks = 2000;
+static const int kTimeoutMsec = 30000;
+
+int main(int argc, char** argv) {
+  voltdb::Client voltdbClient = WorkerManager::createVoltdbClient(kDbAddr);
+
+  // One worker with room for all tasks, and all tasks queued for it.
+  std::vector<voltdb::Parameter> noParameters;
+  voltdb::Procedure truncateTasks("TruncateTaskTable", noParameters);
+  invoke(&voltdbClient, truncateTasks);
+  voltdb::Procedure truncateWorkers("TruncateWorkerTable", noParameters);
+  invoke(&voltdbClient, truncateWorkers);
+
+  std::vector<voltdb::Parameter> parameterTypes(4);
+  parameterTypes[0] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[1] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_INTEGER);
+  parameterTypes[3] = voltdb::Parameter(voltdb::WIRE_TYPE_STRING);
+  voltdb::Procedure insertWorker("InsertWorker", parameterTypes);
+  insertWorker.params()
+      ->addInt32(kWorkerId)
+      .addInt32(kTasks)
+      .addInt32(kPKey)
+      .addString("");
+  invoke(&voltdbClient, insertWorker);
+
+  parameterTypes.resize(3);
+  parameterTypes[2] = voltdb::Parameter(voltdb::WIRE_TYPE_TINYINT);
+  voltdb::Procedure enqueueTask("SelectOrderedWorker", parameterTypes);
+  for (int taskId = 0; taskId < kTasks; ++taskId) {
+    enqueueTask.params()->addInt32(kPKey).addInt32(taskId).addInt8(0);
+    int64_t workerId =
+        VoltdbResultDecoder::getScalarInt64(invoke(&voltdbClient, enqueueTask));
+    assert(workerId == kWorkerId);
+  }
+
+  // The dispatcher deals the tasks of each large fetch round-robin, so every
+  // executor queues about kTasks / kExecutors of them. Their sleep times are
+  // drawn from an exponential distribution, so the queues drain at different
+  // speeds and the executors that run out first must steal.
+  WorkloadConfig workload;
+  workload.type = WorkloadConfig::kMixed;
+  workload.execTimeUsec = 200;
+  workload.spinWeight = 0;
+  workload.memoryWeight = 0;
+  MockPollWorker worker(kWorkerId, kPKey, kDbAddr, kExecutors, kTopk,
+                        MockPollWorker::kWorkStealing, 0, 1000, false,
+                        MockPollWorker::PollOptions(), workload);
+  uint64_t finishedBefore = WorkerManager::totalFinishedTasks_.load();
+  worker.startServing();
+  for (int i = 0; i < kTimeoutMsec &&
+                  WorkerManager::totalFinishedTasks_.load() - finishedBefore <
+                      (uint64_t)kTasks;
+       ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  worker.endServing();
+
+  uint64_t finished = WorkerManager::totalFinishedTasks_.load() - finishedBefore;
+  std::cout << "Finished " << finished << " of " << kTasks << " tasks, "
+            << worker.steals() << " stolen, drained in " << worker.drainUsec()
+            << " usec" << std::endl;
+  assert(finished == (uint64_t)kTasks);
+  assert(worker.steals() > 0);
+
+  invoke(&voltdbClient, truncateTasks);
+  invoke(&voltdbClient, truncateWorkers);
+  return 0;
+}
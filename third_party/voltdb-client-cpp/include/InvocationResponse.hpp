@@ -221,6 +221,12 @@ public:
      */
     std::vector<voltdb::Table> results() const { return m_results; }
 
+    /*
+     * Returns a reference to the result tables, valid as long as this
+     * response. Unlike results(), it does not copy the vector.
+     */
+    const std::vector<voltdb::Table>& resultsRef() const { return m_results; }
+
     /*
      * Generate a string representation of the contents of the message
      */
@@ -103,6 +103,16 @@ public:
      */
     int32_t getSerializedSize() const;
 
+    /*
+     * Returns the serialized table data in place, without the 4 byte size
+     * meta-data, and stores its length in size. The data is owned by the
+     * shared buffer of this table, so it lives as long as any copy of the table.
+     */
+    const char* serializedData(int32_t* size) const {
+        *size = m_buffer.limit();
+        return m_buffer.bytes();
+    }
+
     /*
      * Returns a string representation of this table and all of its rows with
      * the specified level of indentation before each line.